@@ -118,15 +118,13 @@ lfunction io.SpoolJSON(json, file) {
 }
 
 /**
- * TODO: Does not support arrays in JSON
- * Parses json from file_path
+ * Parses json from file_path (numeric and string arrays become matrices)
  * @name io.ParseJSON
  * @param file
  */
 lfunction io.ParseJSON(file_path) {
     fscanf(file_path, "Raw", test);
-    parsed_test = Eval(test);
-    return parsed_test;
+    return ParseJSON(test);
 }
 
 /**
@@ -629,9 +627,11 @@ lfunction io.MakeAbsoluteFilePath  (path) {
 lfunction io.LoadCacheFromFile  (path) {
     if (io.FileExists (path) == TRUE) { // exists
         fscanf (path, REWIND, "Raw", contents);
-        contents =  Eval (contents);
-        if (Type (contents) == "AssociativeList") {
-            return contents;
+        if (Abs (contents)) {
+            contents =  ParseJSON (contents);
+            if (Type (contents) == "AssociativeList") {
+                return contents;
+            }
         }
     } else {
         fprintf (path, CLEAR_FILE, {});
@@ -127,7 +127,7 @@ lfunction utility.CheckCacheFile (data_info) {
     cache_info[utility.getGlobalValue("terms.data.file")] = data_info[utility.getGlobalValue("terms.data.file")] + ".hyphy_cache";
     if (!(cache_info[utility.getGlobalValue("terms.data.file")])) {
         fscanf (cache_info[utility.getGlobalValue("terms.data.file")], "Raw", _cache);
-        cache_info[utility.getGlobalValue("terms.data.cache")] = Eval (_cache);
+        cache_info[utility.getGlobalValue("terms.data.cache")] = ParseJSON (_cache);
     } else {
          cache_info[utility.getGlobalValue("terms.data.cache")] = {};
     }
@@ -1,5 +1,6 @@
 LoadFunctionLibrary ("../all-terms.bf");
 LoadFunctionLibrary ("../models/parameters.bf");
+LoadFunctionLibrary ("../UtilityFunctions.bf");
 
 /** @module mpi
         Functions for creating, populating, and manipulating
@@ -332,6 +333,67 @@ namespace mpi {
 
     //------------------------------------------------------------------------------
 
+    lfunction ParallelMap (object, job) {
+
+        /** apply a function to every element of a dictionary, spreading the work
+         *  over MPI nodes (or local worker processes, see WORKERS= on the command line);
+         *  elements are processed serially if neither is available
+         * @name mpi.ParallelMap
+         * @param  {Dict} object
+         *      key -> value; the elements to process
+         * @param  {String} job
+         *      the ID of a function (key, value) -> result; it must not rely on
+         *      state changed by other elements, since they may be processed elsewhere
+         * @return {Dict} key -> result, in the order of the keys of object
+         */
+
+        blocks  = mpi.PartitionIntoBlocks (object);
+        results = {};
+
+        queue  = mpi.CreateQueue ({^"terms.mpi.Headers"   : utility.GetListOfLoadedModules ("libv3/"),
+                                   ^"terms.mpi.Functions" : {{job}}});
+
+        for (i = 1; i < Abs (blocks); i += 1) {
+            mpi.QueueJob (queue, "mpi.ParallelMap.EvaluateBlock", {"0" : job,
+                                                                   "1" : blocks [i],
+                                                                   "2" : &results}, "mpi.ParallelMap.ResultHandler");
+        }
+
+        mpi.ParallelMap.ResultHandler (-1, mpi.ParallelMap.EvaluateBlock (job, blocks[0], &results), {"2" : &results});
+
+        mpi.QueueComplete (queue);
+
+        // blocks finish in any order; list the results in the order of the elements
+        ordered  = {};
+        task_ids = utility.Keys (object);
+        task_count = Abs (object);
+        for (i = 0; i < task_count; i+=1) {
+            ordered [task_ids[i]] = results[task_ids[i]];
+        }
+
+        return ordered;
+    }
+
+    //------------------------------------------------------------------------------
+
+    lfunction ParallelMap.EvaluateBlock (job, tasks, results) {
+        block_results = {};
+        task_ids = utility.Keys (tasks);
+        task_count = Abs (tasks);
+        for (i = 0; i < task_count; i+=1) {
+            block_results [task_ids[i]] = Call (job, task_ids[i], tasks[task_ids[i]]);
+        }
+        return block_results;
+    }
+
+    //------------------------------------------------------------------------------
+
+    lfunction ParallelMap.ResultHandler (node, result, arguments) {
+        utility.Extend (^(arguments[2]), result);
+    }
+
+    //------------------------------------------------------------------------------
+
     lfunction pass2.evaluator (lf_id, tasks, scores) {
 
         results = {};
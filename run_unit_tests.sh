@@ -21,6 +21,27 @@ for filename in ./tests/hbltests/UnitTests/HBLCommands/*.bf; do
   
 done
 
+# run the MPISend / MPIReceive and mpi.ParallelMap tests again on local worker processes (builds without MPI)
+for filename in ./tests/hbltests/UnitTests/HBLCommands/LocalWorkers.bf ./tests/hbltests/UnitTests/HBLCommands/ParallelMap.bf; do
+  echo "$filename (WORKERS=3)"
+  if $HYPHYMP WORKERS=3 $filename | grep -q "TEST FAILED"; then
+    ((testFailed++))
+    failedTests+=($filename)
+  fi
+  ((testsRun++))
+done
+
+# sample the profiler test with PROFILE=, then check the collapsed stacks it wrote
+filename=./tests/hbltests/UnitTests/HBLCommands/SamplingProfiler.bf
+profile=./tests/hbltests/data/tempFileTesting-profile
+echo "$filename (PROFILE=$profile)"
+$HYPHYMP PROFILE=$profile $filename > /dev/null
+if $HYPHYMP $filename --profile $profile | grep -q "TEST FAILED"; then
+  ((testFailed++))
+  failedTests+=($filename)
+fi
+((testsRun++))
+
 if [ $testFailed ]
 then
   echo "\n\n------------------------SUMMARY (Failed Tests)----------------------------\n"
@@ -77,7 +77,119 @@ using namespace hyphy_global_objects;
 // AssociativeList
 //_____________________________________________________________________________________________
 
-_AssociativeList::_AssociativeList (void):avl(&theData) {
+_AssociativeList::_AssociativeList (void):avl(&theData), hash_index_used (0UL) {
+}
+
+//_____________________________________________________________________________________________
+// key hash index
+//_____________________________________________________________________________________________
+
+static const unsigned long kHashIndexThreshold = 16UL;
+static const long          kHashIndexEmpty     = -1L,
+                           kHashIndexDeleted   = -2L;
+
+//_____________________________________________________________________________________________
+
+long _AssociativeList::HashIndexProbe (_String const& key, unsigned long h) const {
+    // returns the table position holding 'key' or -1 if the key is absent
+    unsigned long mask = hash_index.lLength - 1UL;
+    for (unsigned long i = h & mask; ; i = (i + 1UL) & mask) {
+        long slot = hash_index.list_data[i];
+        if (slot == kHashIndexEmpty) {
+            return -1L;
+        }
+        if (slot >= 0L && (unsigned long)key_hashes.list_data[slot] == h && *(_String const*)theData.list_data[slot] == key) {
+            return i;
+        }
+    }
+}
+
+//_____________________________________________________________________________________________
+
+void _AssociativeList::RebuildHashIndex (void) {
+    unsigned long capacity = 64UL;
+    while (capacity < avl.countitems() * 4UL) {
+        capacity <<= 1;
+    }
+    hash_index.Populate (capacity, kHashIndexEmpty, 0L);
+    key_hashes.Populate (theData.lLength, 0L, 0L);
+    hash_index_used = 0UL;
+
+    unsigned long mask = capacity - 1UL;
+    for (unsigned long slot = 0UL; slot < theData.lLength; slot++) {
+        if (theData.list_data[slot]) {
+            unsigned long h = ((_String const*)theData.list_data[slot])->Hash(),
+                          i = h & mask;
+            while (hash_index.list_data[i] != kHashIndexEmpty) {
+                i = (i + 1UL) & mask;
+            }
+            hash_index.list_data[i]     = slot;
+            key_hashes.list_data[slot]  = h;
+            hash_index_used ++;
+        }
+    }
+}
+
+//_____________________________________________________________________________________________
+
+long _AssociativeList::FindKey (_String const& key) const {
+    if (hash_index.lLength) {
+        long pos = HashIndexProbe (key, key.Hash());
+        return pos >= 0L ? hash_index.list_data[pos] : -1L;
+    }
+    return avl.Find (&key);
+}
+
+//_____________________________________________________________________________________________
+
+void _AssociativeList::InsertKey (_String* key, HBLObjectRef value) {
+    // the key must not already be present; this mirrors _AVLListXL::InsertData slot reuse
+    long slot = avl.emptySlots.lLength ? avl.emptySlots.list_data[avl.emptySlots.lLength - 1UL] : theData.lLength;
+
+    avl.Insert (key, (long)value, false);
+
+    if (hash_index.lLength == 0UL) {
+        if (avl.countitems() > kHashIndexThreshold) {
+            RebuildHashIndex ();
+        }
+        return;
+    }
+
+    if ((hash_index_used + 1UL) * 2UL > hash_index.lLength) {
+        RebuildHashIndex ();
+        return;
+    }
+
+    unsigned long h    = key->Hash(),
+                  mask = hash_index.lLength - 1UL,
+                  i    = h & mask;
+
+    while (hash_index.list_data[i] >= 0L) {
+        i = (i + 1UL) & mask;
+    }
+    if (hash_index.list_data[i] == kHashIndexEmpty) {
+        hash_index_used ++;
+    }
+    hash_index.list_data[i] = slot;
+
+    if (slot == key_hashes.lLength) {
+        key_hashes << h;
+    } else {
+        key_hashes.list_data[slot] = h;
+    }
+}
+
+//_____________________________________________________________________________________________
+
+void _AssociativeList::RemoveKey (_String const& key) {
+    if (hash_index.lLength) {
+        long pos = HashIndexProbe (key, key.Hash());
+        if (pos < 0L) {
+            return;
+        }
+        hash_index.list_data[pos] = kHashIndexDeleted;
+    }
+    avl.Delete (&key,true);
 }
 
 //_____________________________________________________________________________________________
@@ -152,6 +264,9 @@ void _AssociativeList::Duplicate (BaseRefConst br) {
     avl.emptySlots.Duplicate (&copyMe->avl.emptySlots);
     avl.xtraD.Duplicate (&copyMe->avl.xtraD);
     avl.root = copyMe->avl.root;
+    hash_index.Duplicate (&copyMe->hash_index);
+    key_hashes.Duplicate (&copyMe->key_hashes);
+    hash_index_used = copyMe->hash_index_used;
 }
 
 //_____________________________________________________________________________________________
@@ -165,10 +280,10 @@ HBLObjectRef _AssociativeList::MAccess (HBLObjectRef p) {
     long        f;
 
     if (p->ObjectClass() == STRING) {
-        f = avl.Find (&((_FString*)p)->get_str());
+        f = FindKey (((_FString*)p)->get_str());
     } else {
         _String s ((_String*)p->toStr());
-        f = avl.Find (&s);
+        f = FindKey (s);
     }
     if (f>=0L) {
         HBLObjectRef res = (HBLObjectRef)avl.GetXtra (f);
@@ -372,7 +487,8 @@ hyFloat _AssociativeList::GetNumberByKey (_String const& key) const {
 
 //_____________________________________________________________________________________________
 HBLObjectRef _AssociativeList::GetByKey (_String const& key) const {
-    return (HBLObjectRef)avl.GetDataByKey(&key);
+    long f = FindKey (key);
+    return f >= 0L ? (HBLObjectRef)avl.GetXtra (f) : nil;
 }
 
 //_____________________________________________________________________________________________
@@ -383,23 +499,26 @@ HBLObjectRef _AssociativeList::GetByKey (long nKey, long objType) const {
   //_____________________________________________________________________________________________
 void _AssociativeList::Clear (void) {
   avl.Clear(true);
+  hash_index.Clear();
+  key_hashes.Clear();
+  hash_index_used = 0UL;
 }
 
 
 //_____________________________________________________________________________________________
 void _AssociativeList::DeleteByKey (HBLObjectRef p) {
     if (p->ObjectClass() == STRING) {
-        avl.Delete (&((_FString*)p)->get_str(),true);
+        RemoveKey (((_FString*)p)->get_str());
     } else {
         if (p->ObjectClass() == ASSOCIATIVE_LIST) {
             _List * keys2remove = ((_AssociativeList*)p)->GetKeys();
             for (long ki = 0; ki < keys2remove->lLength; ki++) {
-                avl.Delete ((_String*)(*keys2remove)(ki),true);
+                RemoveKey (*(_String*)(*keys2remove)(ki));
             }
             DeleteObject (keys2remove);
         } else {
             _String * s = (_String*)p->toStr();
-            avl.Delete (s,true);
+            RemoveKey (*s);
             DeleteObject (s);
         }
     }
@@ -407,7 +526,7 @@ void _AssociativeList::DeleteByKey (HBLObjectRef p) {
 
 //_____________________________________________________________________________________________
 void _AssociativeList::DeleteByKey (_String const& key) {
-    avl.Delete (&key,true);
+    RemoveKey (key);
 }
 
 
@@ -417,7 +536,7 @@ bool _AssociativeList::MStore (_String * p, HBLObjectRef inObject, bool repl, lo
         return false;
     }
     
-    long       f     = avl.Find (p);
+    long       f     = FindKey (*p);
     
     if (f>=0) { // already exists - replace
         if (opCode == HY_OP_CODE_ADD) {
@@ -437,10 +556,10 @@ bool _AssociativeList::MStore (_String * p, HBLObjectRef inObject, bool repl, lo
     } else { // insert new
         if (repl) {
             BaseRef br = inObject->makeDynamic();
-            avl.Insert (p,(long)br,false);
+            InsertKey (p, (HBLObjectRef)br);
             //br->nInstances--;
         } else {
-            avl.Insert (p,(long)inObject,false);
+            InsertKey (p, inObject);
         }
         return true;
     }
@@ -497,50 +616,83 @@ void _AssociativeList::MStore (const _String& obj, const _String& info) {
 _StringBuffer * _AssociativeList::Serialize (unsigned long padding) const {
   
     _StringBuffer  * out_string = new _StringBuffer (1024L);
-    _String          padder (" ", padding);
+    StringFileWrapper write_here (out_string, nil);
+    SerializeTo (write_here, padding);
+    out_string->TrimSpace ();
+    
+    return out_string;
+}
+
+//_____________________________________________________________________________________________
+
+void _AssociativeList::SerializeTo (StringFileWrapper& out, unsigned long padding) const {
+  
+    static const _String kUseJSONForMatrix ("USE_JSON_FOR_MATRIX");
   
+    _String          padder (" ", padding);
+    bool             doComma = false,
+                     doJSON  = hy_env::EnvVariableTrue(kUseJSONForMatrix);
+    char             number_buffer [256];
   
+    out << '{';
   
-    (*out_string) << "{";
-    bool        doComma = false;
-    _List * meKeys = GetKeys();
-    for (long k = 0L; k < meKeys->countitems(); k++) {
-        _String   *thisKey  = (_String*)(*meKeys)(k);
+    for (AVLListXLIteratorKeyValue key_value : AVLListXLIterator (&avl)) {
+        _String const * thisKey = key_value.get_key();
         if (thisKey) {
             if (doComma) {
-                (*out_string) << ',';
-             }
+                out << ',';
+            }
           
-            (*out_string) << '\n' << padder << ' ';
+            out << '\n' << padder << ' ';
           
-            (*out_string) << '"';
-            out_string->SanitizeAndAppend (*thisKey);
-            (*out_string) << '"';
-
-            HBLObjectRef anObject = GetByKey (*thisKey);
-
-            (*out_string) << ':';
-            if (anObject->ObjectClass() == STRING) {
-                (*out_string) << '"';
-                out_string->SanitizeAndAppend(_String ((_String*)anObject->toStr(padding+2)));
-                (*out_string) << '"';
-            } else {
-                if (anObject->ObjectClass() != HY_UNDEFINED) {
-                    out_string->AppendNewInstance((_String*)anObject->toStr(padding+2));
-                } else {
-                    (*out_string) << kNullToken;
+            _StringBuffer sanitized_key (thisKey->length() + 8UL);
+            sanitized_key << '"';
+            sanitized_key.SanitizeAndAppend (*thisKey);
+            sanitized_key << '"' << ':';
+            out << sanitized_key;
+
+            HBLObjectRef anObject = (HBLObjectRef)key_value.get_object();
+
+            switch (anObject->ObjectClass()) {
+                case STRING: {
+                    _StringBuffer sanitized_value (((_FString*)anObject)->get_str().length() + 8UL);
+                    sanitized_value << '"';
+                    sanitized_value.SanitizeAndAppend (((_FString*)anObject)->get_str());
+                    sanitized_value << '"';
+                    out << sanitized_value;
+                    break;
+                }
+                case NUMBER:
+                    parameterToCharBuffer (anObject->Value(), number_buffer, 255, doJSON);
+                    out << number_buffer;
+                    break;
+                case ASSOCIATIVE_LIST:
+                    ((_AssociativeList*)anObject)->SerializeTo (out, padding + 2UL);
+                    break;
+                case MATRIX:
+                    ((_Matrix*)anObject)->SerializeTo (out, padding + 2UL);
+                    break;
+                case HY_UNDEFINED:
+                    out << kNullToken;
+                    break;
+                default: {
+                    _String * representation = (_String*)anObject->toStr(padding + 2UL);
+                    out << representation;
+                    DeleteObject (representation);
                 }
             }
             doComma = true;
         }
     }
     
-    DeleteObject (meKeys);
-    
-    (*out_string) << '\n' << padder << "}";
-    out_string->TrimSpace ();
-    
-    return out_string;
+    out << '\n' << padder << '}';
+}
+
+//_____________________________________________________________________________________________
+
+void _AssociativeList::toFileStr (FILE* dest, unsigned long padding) {
+    StringFileWrapper write_here (nil, dest);
+    SerializeTo (write_here, padding);
 }
 
 
@@ -783,12 +935,12 @@ HBLObjectRef _AssociativeList::ExecuteSingleOp (long opCode, _List* arguments, _
         case HY_OP_CODE_DIV:
         
         if (arg0->ObjectClass () == STRING) {
-          if (avl.Find (&((_FString*)arg0)->get_str()) >= 0L) {
+          if (FindKey (((_FString*)arg0)->get_str()) >= 0L) {
             return new _Constant (1.0);
           }
         } else {
           _String serialized ((_String*)arg0->toStr());
-          if (avl.Find (&serialized) >= 0L) {
+          if (FindKey (serialized) >= 0L) {
             return new _Constant (1.0);
           }
         }
@@ -41,6 +41,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <time.h>
+#include <utility>
 
 
 #include "likefunc.h"
@@ -52,6 +53,8 @@
 #include "global_object_lists.h"
 #include "global_things.h"
 #include "time_difference.h"
+#include "sampling_profiler.h"
+#include "parse_cache.h"
 #include "global_things.h"
 #include "hy_string_buffer.h"
 #include "tree_iterator.h"
@@ -225,6 +228,9 @@ _AVLList    loadedLibraryPaths  (&loadedLibraryPathsBackend);
 _ExecutionList
 *currentExecutionList = nil;
 
+unsigned long
+batchLanguageFunctionStamp = 1UL;
+
 _List const _ElementaryCommand::fscanf_allowed_formats (new _String ("Number"),
                                                         new _String ("Matrix"),
                                                         new _String ("Tree"),
@@ -508,7 +514,90 @@ _SimpleList&   GetBFFunctionArgumentTypes  (long idx) {
 
 //____________________________________________________________________________________
 _ExecutionList&   GetBFFunctionBody  (long idx) {
-  return *(_ExecutionList*)batchLanguageFunctions.Element (idx);
+  _ExecutionList * body = (_ExecutionList*)batchLanguageFunctions.Element (idx);
+  if (body->is_deferred) {
+    _ElementaryCommand::BuildFunctionBody (*body);
+  }
+  if (body->is_compile_pending) {
+    // cleared first: a recursive call met while compiling sees an uncompiled
+    // body, and is left to the interpreter
+    body->is_compile_pending = false;
+    if (body->TryToMakeSimple(true)) {
+      ReportWarning(_String ("Successfully compiled code for function ") & GetBFFunctionNameByIndex (idx).Enquote());
+    }
+  }
+  return *body;
+}
+
+//____________________________________________________________________________________
+bool   CanCallBFFunctionFromCompiledCode  (long idx) {
+  // the body must be compiled (cfunctions called for the first time are compiled here),
+  // and all arguments must be passed by value
+  if (IsBFFunctionIndexValid (idx)) {
+    _ExecutionList const * body = &GetBFFunctionBody (idx);
+    return body->is_compiled() && GetBFFunctionArgumentTypes (idx).Find (kBLFunctionArgumentReference) == kNotFound;
+  }
+  return false;
+}
+
+//____________________________________________________________________________________
+hyFloat   CallBFFunctionFromCompiledCode  (long idx, _SimpleFormulaDatum * stack, long arguments_at, _SimpleFormulaDatum * values) {
+  /*
+      called from _Formula::ComputeSimple with the numeric arguments in
+      stack [arguments_at, arguments_at + argument count)
+   
+      when the call comes from a compiled statement of the current execution list,
+      its variables are written back before the call and reloaded after it, so that
+      the function sees (and may change) the same state as it would if called
+      from interpreted code; the live part of the caller's stack is saved in case
+      the function re-enters the caller
+  */
+  
+  _ExecutionList * caller          = currentExecutionList;
+  bool const       synchronize     = caller && caller->cli && caller->cli->values == values && caller->cli->is_compiled[0];
+  long const       argument_count  = GetBFFunctionArgumentCount (idx);
+  
+  _Stack           scrap;
+  
+  for (long k = 0L; k < argument_count; k++) {
+    scrap.Push (new _Constant (stack[arguments_at + k].value), false);
+  }
+  
+  _SimpleFormulaDatum * saved_stack = nil;
+  
+  if (arguments_at > 0L) {
+    saved_stack = new _SimpleFormulaDatum [arguments_at];
+    memcpy (saved_stack, stack, arguments_at * sizeof (_SimpleFormulaDatum));
+  }
+  
+  if (synchronize) {
+    caller->CopyCLIToVariables();
+  }
+  
+  _Operation  call   (kEmptyString, -idx - 1L);
+  hyFloat     result = 0.0;
+  
+  if (call.Execute (scrap) && scrap.StackDepth()) {
+    HBLObjectRef return_value = scrap.Pop ();
+    if (return_value->ObjectClass() == NUMBER) {
+      result = return_value->Value();
+    } else if (return_value->ObjectClass() != HY_UNDEFINED) {
+      HandleApplicationError (_String ("Compiled code expected a numeric value to be returned by ") & GetBFFunctionNameByIndex (idx).Enquote());
+    }
+    DeleteObject (return_value);
+  }
+  
+  if (saved_stack) {
+    memcpy (stack, saved_stack, arguments_at * sizeof (_SimpleFormulaDatum));
+    delete [] saved_stack;
+  }
+  
+  if (synchronize) {
+    PopulateArraysForASimpleFormula (caller->cli->varList, caller->cli->values, &caller->cli->containerSlots, &caller->cli->returnSlots, &caller->cli->numericReturns);
+    caller->cli->is_compiled[0] = true;
+  }
+  
+  return result;
 }
 
 //____________________________________________________________________________________
@@ -603,6 +692,7 @@ void ClearBFFunctionLists (long start_here) {
     batchLanguageFunctionClassification.DeleteList  (delete_me);
     batchLanguageFunctionParameterLists.DeleteList  (delete_me);
     batchLanguageFunctionParameterTypes.DeleteList  (delete_me);
+    batchLanguageFunctionStamp++;
   }
 }
 
@@ -922,12 +1012,16 @@ _ExecutionList::_ExecutionList () {
 } // doesn't do much
 
 //____________________________________________________________________________________
-_ExecutionList::_ExecutionList (_String& source, _String* namespaceID , bool copySource, bool* successFlag) {
+_ExecutionList::_ExecutionList (_String& source, _String* namespaceID , bool copySource, bool* successFlag, _String const * source_file) {
     Init (namespaceID);
 
     if (copySource) {
         sourceText.Duplicate (&source);
     }
+    
+    if (source_file) {
+        sourceFile = *source_file;
+    }
 
     bool result = BuildList (source, nil, false, true);
     if (successFlag) {
@@ -948,6 +1042,10 @@ void _ExecutionList::Init (_String* namespaceID) {
     kwargs              = nil;
     kwarg_tags          = nil;
     currentKwarg        = 0;
+    argument_slots_stamp = 0UL;
+    is_deferred         = false;
+    is_compile_pending  = false;
+    profile_frame       = -1L;
 
     if (currentExecutionList) {
         errorHandlingMode  = currentExecutionList->errorHandlingMode;
@@ -1262,6 +1360,8 @@ _StringBuffer const       _ExecutionList::GenerateHelpMessage(_AVLList * scanned
 HBLObjectRef       _ExecutionList::Execute     (_ExecutionList* parent, bool ignore_CEL_kwargs) {
 
   //setParameter(_hyLastExecutionError, new _MathObject, nil, false);
+  long profiler_depth = hy_sampling_profiler_active ? SamplingProfilerEnter (this) : -1L;
+    
   try{
 
     _ExecutionList*      stashCEL = currentExecutionList;
@@ -1328,7 +1428,7 @@ HBLObjectRef       _ExecutionList::Execute     (_ExecutionList* parent, bool ign
                 
             } else {
                 if (cli->is_compiled[0] == false) {
-                    PopulateArraysForASimpleFormula (cli->varList, cli->values);
+                    PopulateArraysForASimpleFormula (cli->varList, cli->values, &cli->containerSlots, &cli->returnSlots, &cli->numericReturns);
                     cli->is_compiled[0] = true;
                 }
             }
@@ -1384,12 +1484,18 @@ HBLObjectRef       _ExecutionList::Execute     (_ExecutionList* parent, bool ign
       
     if (is_compiled(0)) {
       CopyCLIToVariables();
+      // the values array is no longer current for a caller which re-entered this list
+      // (a recursive call from an interpreted statement); make it reload the values
+      cli->is_compiled[0] = false;
     }
 
   } catch (const _String err) {
     HandleApplicationError(err);
   }
 
+    if (profiler_depth >= 0L) {
+        SamplingProfilerLeave (profiler_depth);
+    }
     return result;
 }
 
@@ -1408,6 +1514,14 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
                     parseCodes;
   
     _AVLList        varList (&varListAux);
+  
+    _SimpleList     containerListAux;
+    _AVLList        containerList (&containerListAux);
+  
+    _SimpleList     pendingReturns,     // statement index, compiled formula pairs
+                    returnOnlyAux;
+    _List           returnVariables;    // variables read by each of the pending returns
+    _AVLList        returnOnly (&returnOnlyAux);
 
     long            stackDepth  = 0L;
     bool            status      = true;
@@ -1432,17 +1546,17 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
 
                 if (parseCode == HY_FORMULA_EXPRESSION || parseCode == HY_FORMULA_VARIABLE_VALUE_ASSIGNMENT || parseCode == HY_FORMULA_FORMULA_VALUE_ASSIGNMENT) {
 
-                    if (f->AmISimple(stackDepth,varList)) {
+                    if (f->AmISimple(stackDepth,varList,true,&containerList)) {
                         try {
                           if (parseCode == HY_FORMULA_FORMULA_VALUE_ASSIGNMENT) {
-                            if (!f2->AmISimple(stackDepth, varList)) throw 0;
+                            if (!f2->AmISimple(stackDepth, varList, true, &containerList)) throw 0;
                             long assignment_length = f->NumberOperations();
                             if (assignment_length < 3) throw 0;
                             _Variable * mx = f->GetIthTerm(0)->RetrieveVar();
                             if (! mx) throw 0;
                             f->GetIthTerm (0)->SetAVariable(mx->get_index());
                             _Operation * last = f->GetIthTerm(assignment_length-1);
-                            if (! (last->TheCode() == HY_OP_CODE_MCOORD && last->GetNoTerms() == 2)) throw 0;
+                            if (! (last->TheCode() == HY_OP_CODE_MCOORD && (last->GetNoTerms() == 2 || last->GetNoTerms() == 3))) throw 0;
 
                             f2->GetList() << f->GetList();
                             f->Clear();
@@ -1452,34 +1566,28 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
                             f  = t;
 
                           }
+                          
+                          aStatement->simpleParameters<<parseCode;
+                          aStatement->simpleParameters<<(long)f;
+                          aStatement->simpleParameters<<(long)f2;
+                          aStatement->simpleParameters<<fpc.assignmentRefID();
 
-                        } catch (int e) {
-                          if (partial_ok) {
-                              parseCodes << -1;
-                              continue;
-                          }
-                          status = false;
-                          break;
-                        }
-                      
-                        aStatement->simpleParameters<<parseCode;
-                        aStatement->simpleParameters<<(long)f;
-                        aStatement->simpleParameters<<(long)f2;
-                        aStatement->simpleParameters<<fpc.assignmentRefID();
 
+                          formulaeToConvert << (long)f;
+                          is_compiled [k+1] = true;
 
-                        formulaeToConvert << (long)f;
-                        is_compiled [k+1] = true;
 
+                          if (parseCode == HY_FORMULA_VARIABLE_VALUE_ASSIGNMENT) {
+                              varList.InsertNumber(fpc.assignmentRefID());
+                              parseCodes        << fpc.assignmentRefID();
+                          } else {
+                              parseCodes        << -1;
+                          }
+                          break;
 
-                        if (parseCode == HY_FORMULA_VARIABLE_VALUE_ASSIGNMENT) {
-                            varList.InsertNumber(fpc.assignmentRefID());
-                            parseCodes        << fpc.assignmentRefID();
-                        } else {
-                            parseCodes        << -1;
+                        } catch (int e) {
+                          // not a supported assignment; handled below like any other statement that does not compile
                         }
-                        break;
-
                     }
                 }
 
@@ -1510,14 +1618,10 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
 
 
                 _Formula *cf  = ((_Formula*)aStatement->simpleParameters(2));
-                if (cf->AmISimple(stackDepth,varList)) {
+                if (cf->AmISimple(stackDepth,varList,true,&containerList)) {
                     formulaeToConvert << (long)cf;
                     is_compiled [k+1] = true;
-                } else {
-                    if (partial_ok) {
-                        parseCodes << -1;
-                        continue;
-                    }
+                } else if (!partial_ok) {
                     status = false;
                 }
             } else {
@@ -1527,16 +1631,75 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
                 
         case 14: // return statements are OK
             parseCodes << -1;
+            if (aStatement->parameters.lLength && aStatement->simpleParameters.lLength == 1) {
+                /* a return value can be computed from the values array if it is a plain
+                   numeric expression of variables: element reads and HBL function calls
+                   may produce other types, so they are left to the interpreter; whether
+                   the variables hold numbers is only known at run time (see below) */
+                _Formula * rf = new _Formula;
+                _FormulaParsingContext fpc (nil, nameSpacePrefix);
+                _SimpleList  return_variables_aux;
+                _AVLList     return_variables (&return_variables_aux);
+                
+                bool numeric_form = Parse (rf, *(_String*)aStatement->parameters(0), fpc, nil) == HY_FORMULA_EXPRESSION && !fpc.isVolatile();
+                for (unsigned long op = 0UL; numeric_form && op < rf->NumberOperations(); op++) {
+                    long const op_code = rf->GetIthTerm (op)->TheCode();
+                    numeric_form = op_code != HY_OP_CODE_MACCESS && op_code != HY_OP_CODE_MCOORD;
+                }
+                
+                if (numeric_form && rf->AmISimple(stackDepth,return_variables)) {
+                    pendingReturns << k << (long)rf;
+                    returnVariables && & return_variables_aux;
+                } else {
+                    delete rf;
+                }
+            }
             break;
                 
         default:
-            status = false;
+            // other commands (e.g. LFCompute) are run by the interpreter,
+            // with the compiled variable values synchronized around them
+            parseCodes << -1;
+            if (!partial_ok) {
+                status = false;
+            }
         }
         if (status == false) {
             ReportWarning (_String ("Failed to compile an execution list: offending command was\n") & _String (((_String*)aStatement->toStr())));
         }
     }
 
+    /* return statements are added once all the other statements are known: a return
+       which reads an indexed container (by reference in the values array) stays
+       interpreted, and the variables that only returns read are checked for numeric
+       values when the values array is filled; if one holds something else (e.g. a
+       dictionary argument), returns are computed by the interpreter (from an
+       uncompiled copy of the expression) for that call
+    */
+    for (unsigned long ri = 0UL; ri < pendingReturns.countitems(); ri += 2UL) {
+        _ElementaryCommand * return_statement = GetIthCommand (pendingReturns.get (ri));
+        _Formula           * rf               = (_Formula*)pendingReturns.get (ri + 1UL);
+        _SimpleList const  * read_variables   = (_SimpleList const*)returnVariables.GetItem (ri >> 1);
+      
+        if (status && !read_variables->Any ([&] (long v, unsigned long) -> bool {return containerList.Find ((BaseRef)v) >= 0L;})) {
+            _Formula * interpreted = new _Formula;
+            _FormulaParsingContext fpc (nil, nameSpacePrefix);
+            Parse (interpreted, *(_String*)return_statement->parameters(0), fpc, nil);
+          
+            read_variables->Each ([&] (long v, unsigned long) -> void {
+                if (varList.Find ((BaseRef)v) < 0L) {
+                    returnOnly.InsertNumber (v);
+                    varList.InsertNumber (v);
+                }
+            });
+            return_statement->simpleParameters << (long)rf << (long)interpreted;
+            formulaeToConvert << (long)rf;
+            is_compiled [pendingReturns.get (ri) + 1L] = true;
+        } else {
+            delete rf;
+        }
+    }
+
     if (status) {
         if (formulaeToConvert.nonempty()) {
             cli = new _CELInternals;
@@ -1564,7 +1727,24 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
                 }
                 //printf ("\n%ld\n",  cli->storeResults.list_data[ri]);
             }
+          
+            for (unsigned long ri = 0; ri<cli->storeResults.lLength; ri++) {
+                if (cli->storeResults.list_data[ri] >= 0L) {
+                    cli->assignedSlots.BinaryInsert (cli->storeResults.list_data[ri]);
+                }
+            }
+          
+            for (unsigned long ci = 0; ci<containerListAux.lLength; ci++) {
+                cli->containerSlots.BinaryInsert (avlList.GetXtra (avlList.Find ((BaseRef) containerListAux.list_data[ci])));
+            }
+          
+            for (unsigned long ri = 0; ri<returnOnlyAux.lLength; ri++) {
+                cli->returnSlots.BinaryInsert (avlList.GetXtra (avlList.Find ((BaseRef) returnOnlyAux.list_data[ri])));
+            }
+            cli->numericReturns = true;
             cli->varList.Duplicate(&varListAux);
+        } else {
+            delete [] is_compiled;
         }
     } else {
         // clean up partially converted statements
@@ -1581,9 +1761,10 @@ bool        _ExecutionList::TryToMakeSimple     (bool partial_ok) {
 //____________________________________________________________________________________
 
 void        _ExecutionList::CopyCLIToVariables(void) {
-    
-    cli->varList.Each ([this] (long index, unsigned long idx) -> void {
-        _Variable * mv = LocateVar(index);
+    // only variables assigned by compiled statements can differ from their values array entries;
+    // leaving the others alone also keeps any constraints on them intact
+    cli->assignedSlots.Each ([this] (long idx, unsigned long) -> void {
+        _Variable * mv = LocateVar(this->cli->varList.get (idx));
         if (mv->ObjectClass() == NUMBER) {
             mv->SetValue (new _Constant (this->cli->values[idx].value),false);
         }
@@ -1837,10 +2018,28 @@ bool        _ExecutionList::BuildList   (_String& s, _SimpleList* bc, bool proce
     _SimpleList          triePath;
     _List                local_object_manager;
   
+    // while a batch file is being read, the statements s splits into may be in the parse cache (see parse_cache.h)
+    _hyParseCacheKey     cache_key;
+    _List        const * cached_statements  = ParseCacheLookup (s, cache_key);
+    _List              * scanned_statements = nil;
+    _String            * scanned_text       = nil;
+    unsigned long        next_cached        = 0UL;
+  
+    if (cache_key.active && !cached_statements) {
+        // s is consumed by scanning, so the text recorded with its statements is a copy
+        local_object_manager < (scanned_statements = new _List);
+        local_object_manager < (scanned_text       = new _String (s));
+    }
+  
     try {
 
-      while (s.nonempty ()) { // repeat while there is stuff left in the buffer
-          _String currentLine (_ElementaryCommand::FindNextCommand (s));
+      // repeat while there is stuff left in the buffer
+      while (cached_statements ? next_cached < cached_statements->countitems() : s.nonempty ()) {
+          _String currentLine (cached_statements ? *(_String const*)cached_statements->GetItem (next_cached++) : _ElementaryCommand::FindNextCommand (s));
+        
+          if (scanned_statements) {
+              *scanned_statements && & currentLine;
+          }
 
           if (currentLine.get_char(0)=='}') {
               currentLine.Trim(1,kStringEnd);
@@ -2042,8 +2241,15 @@ bool        _ExecutionList::BuildList   (_String& s, _SimpleList* bc, bool proce
               }
               // plain ol' formula - parse it as such!
               else {
-                  _String checker (currentLine);
-                  if (_ElementaryCommand::FindNextCommand (checker).length ()==currentLine.length()) {
+                  // a scanned statement without braces or slashes (possible comment markers)
+                  // re-scans to itself, so it needn't be checked for multiple statements
+                  bool single_statement = true;
+                  for (unsigned long k = 0UL; k < currentLine.length() && single_statement; k++) {
+                      char c = currentLine.char_at (k);
+                      single_statement = c != '{' && c != '}' && c != '/';
+                  }
+                  _String checker (single_statement ? kEmptyString : currentLine);
+                  if (single_statement || _ElementaryCommand::FindNextCommand (checker).length ()==currentLine.length()) {
                       if (currentLine.length()>1)
                           while (currentLine (-1L) ==';') {
                               currentLine.Trim (0,currentLine.length()-2);
@@ -2064,6 +2270,12 @@ bool        _ExecutionList::BuildList   (_String& s, _SimpleList* bc, bool proce
               }
            }
       }
+      
+      if (scanned_statements) {
+          scanned_text->AddAReference();
+          scanned_statements->AddAReference();
+          ParseCacheStore (cache_key, scanned_text, scanned_statements);
+      }
     } catch (_String const & error) {
       if (currentExecutionList) {
         currentExecutionList->ReportAnExecutionError(error, false, true);
@@ -2081,18 +2293,27 @@ bool        _ExecutionList::BuildList   (_String& s, _SimpleList* bc, bool proce
 
 _ElementaryCommand::_ElementaryCommand (void) {
     code = -1;
+    compiled_source = nil;
+    storage_slots_stamp = 0UL;
+    storage_slots_namespace = nil;
 }
 
 //____________________________________________________________________________________
 
 _ElementaryCommand::_ElementaryCommand (long ccode) {
     code = ccode;
+    compiled_source = nil;
+    storage_slots_stamp = 0UL;
+    storage_slots_namespace = nil;
 }
 
 //____________________________________________________________________________________
 
 _ElementaryCommand::_ElementaryCommand (_String& s) {
     code = -1;
+    compiled_source = nil;
+    storage_slots_stamp = 0UL;
+    storage_slots_namespace = nil;
     _String::Duplicate (&s);
 }
 
@@ -2113,12 +2334,21 @@ _ElementaryCommand::~_ElementaryCommand (void) {
                 delete(f);
                 simpleParameters.Clear();
             }
+        } else if (code==14) {
+            if (simpleParameters.lLength == 3) { // a compiled return and its uncompiled copy
+                delete (_Formula*)simpleParameters(1);
+                delete (_Formula*)simpleParameters(2);
+            }
         } else if ((code==6)||(code==9)) {
             for (long i = 0; i<simpleParameters.lLength; i++) {
                 _Formula* f = (_Formula*)simpleParameters(i);
                 delete (f);
             }
         }
+        if (compiled_source) {
+            DeleteObject (compiled_source->code);
+            delete compiled_source;
+        }
     }
 
 }
@@ -2630,6 +2860,10 @@ void      _ElementaryCommand::ExecuteCase5 (_ExecutionList& chain) {
     }
 
 
+    if (!ds) { // ReadDataSetFile has already reported the error
+        return;
+    }
+
     // 20110802: need to check that this data set is not empty
 
     if (ds->NoOfSpecies() && ds->NoOfColumns()) {
@@ -3370,13 +3604,25 @@ bool      _ElementaryCommand::Execute    (_ExecutionList& chain) {
           // because chain.result may be overwritten by recursive calls to
           // this function
 
-          if (expression) {
+          bool const compute_simple = chain.is_compiled(chain.currentCommand+1) && chain.cli->numericReturns;
+          _Formula * cached_expression = nil;
+
+          if (compute_simple) {
+            ret_val = new _Constant (((_Formula*)simpleParameters(1))->ComputeSimple (chain.cli->stack, chain.cli->values));
+          } else if (expression) {
             //printf ("Return interpreted\n");
             ret_val = expression->Compute();
           }
           else{
-            //printf ("Return compiled %d\n", ((_Formula*)simpleParameters(1))->GetList().lLength);
-            ret_val = ((_Formula*)simpleParameters(1))->Compute();
+            if (chain.is_compiled(chain.currentCommand+1)) {
+              // a variable read by the return holds a non-number: use the uncompiled copy
+              chain.CopyCLIToVariables();
+              cached_expression = (_Formula*)simpleParameters(2);
+            } else {
+              cached_expression = (_Formula*)simpleParameters(1);
+            }
+            //printf ("Return compiled %d\n", cached_expression->GetList().lLength);
+            ret_val = cached_expression->Compute();
           }
 
           DeleteObject (chain.result);
@@ -3388,6 +3634,13 @@ bool      _ElementaryCommand::Execute    (_ExecutionList& chain) {
 
           if (expression) {
             delete (expression);
+          } else if (compute_simple) {
+            DeleteObject (ret_val);
+          } else {
+            // so that a returned temporary (or a local variable's value) is not
+            // pinned by the compiled return statement and can be handed over
+            // to the caller without a copy
+            cached_expression->ReleaseResult();
           }
         }
         catch (int e) {
@@ -3697,7 +3950,16 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
 
     _SimpleList is_DoWhileLoop;
 
-    _StringBuffer result (128L);
+    /* scanned characters are written straight into a buffer which grows with
+       the command being scanned (not with the rest of the input, which would
+       make splitting a long source into statements quadratic); one input
+       character contributes at most three characters to the command
+       (an inserted space, the character itself and an escaped character)
+    */
+
+    unsigned long   scanned_capacity = 128UL,
+                    scanned_length   = 0UL;
+    char          * scanned          = new char [scanned_capacity];
 
     char    last_char = '\0';
         // a look back character
@@ -3717,6 +3979,13 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
     for (index = 0L; index<input.length(); index++) {
         char c = input.char_at (index);
 
+        if (scanned_length + 4UL > scanned_capacity) {
+            char * grown = new char [scanned_capacity <<= 1];
+            memcpy (grown, scanned, scanned_length);
+            delete [] scanned;
+            scanned = grown;
+        }
+
         if (literal_state == normal_text && c=='\t') {
             c = ' ';
         }
@@ -3764,13 +4033,15 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
 
 
 
-            if (!skipping && index > 0L) {
+            // all the keywords end in an alphanumeric character, so there is nothing to look up otherwise
+
+            if (!skipping && index > 0L && isalnum (input.char_at (index-1L))) {
 
               long trie_match = _HY_HBL_KeywordsPreserveSpaces.FindKey(input.Cut (MAX (0, index - 20), index-1).Reverse(), nil, true);
               if (trie_match != kNotFound) {
                 long matched_length = _HY_HBL_KeywordsPreserveSpaces.GetValue(trie_match);
                 if (matched_length == index || !(isalnum(input.get_char(index-matched_length-1)) || input.get_char(index-matched_length-1) == '_' || input.get_char(index-matched_length-1) == '.')) {
-                  result << ' ';
+                  scanned[scanned_length++] = ' ';
                 }
               }
             }
@@ -3784,16 +4055,16 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
           // SLKP 20170704: this seems incomplete : need to check more thorougly that this is an ident
           // this is meant to determine that we are at the beginning of a new ident-like
           // token and insert a space
-            result<<' ';
+            scanned[scanned_length++] = ' ';
         }
 
         skipping = false;
 
-        result<<c;
+        scanned[scanned_length++] = c;
 
         if (literal_state != normal_text && c == '\\') {
             // escape character \x
-            result<< input.get_char(++index);
+            scanned[scanned_length++] = input.get_char(++index);
             continue;
         }
 
@@ -3839,6 +4110,7 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
             if (parentheses_depth < 0L) {
                 HandleApplicationError (_String("Too many closing ')' near '") & input.Cut (MAX(0,index-32),index) & "'.");
                 input.Clear();
+                delete [] scanned;
                 return kEmptyString;
             }
             last_char = '\0';
@@ -3856,6 +4128,7 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
             if (bracket_depth < 0L) {
                 HandleApplicationError (_String("Too many closing ']' near '") & input.Cut (MAX(0,index-32),index) & "'.");
                 input.Clear();
+                delete [] scanned;
                 return kEmptyString;
             }
             last_char = '\0';
@@ -3905,6 +4178,12 @@ const _String   _ElementaryCommand::FindNextCommand  (_String& input) {
         last_char = c;
     }
 
+    // the command may contain NUL characters (e.g. inside a string literal), so copy it by length
+    _StringBuffer result_buffer (scanned_length + 1UL);
+    result_buffer.PushCharBuffer (scanned, scanned_length);
+    _String result (std::move (result_buffer));
+    delete [] scanned;
+
 
     if (scope_depth != 0L || comment_state == slash_star || literal_state != normal_text || matrix_depth != 0L || bracket_depth != 0L || parentheses_depth != 0L) {
         if (result!='}') {
@@ -4749,36 +5028,38 @@ bool    _ElementaryCommand::ConstructFunction (_String&source, _ExecutionList& c
       }
 
 
-      _String          sfunctionBody (source, upto+1,source.length ()-2);
-      _ExecutionList * functionBody;
+      _ExecutionList * functionBody = new _ExecutionList;
+      functionBody->sourceText = _String (source, upto+1,source.length ()-2);
+      functionBody->sourceFile = chain.sourceFile;
 
-      isInFunction = _HY_FUNCTION;
       if (isLFunction) {
           _String * existing_namespace = chain.GetNameSpace();
           if (existing_namespace) {
               extraNamespace = *existing_namespace & '.' & extraNamespace;
+              functionBody->enclosingNamespace = *existing_namespace;
           }
-          functionBody = new _ExecutionList (sfunctionBody,&extraNamespace,true);
-          if (existing_namespace) {
-            functionBody->enclosingNamespace = *existing_namespace;
-          }
+          functionBody->SetNameSpace (extraNamespace);
       }
       else {
-          functionBody = new _ExecutionList (sfunctionBody,chain.GetNameSpace(),true);
+          if (chain.GetNameSpace()) {
+              functionBody->SetNameSpace (*chain.GetNameSpace());
+          }
       }
         
-      if (isCFunction) {
-          if (functionBody->TryToMakeSimple()) {
-              ReportWarning(_String ("Successfully compiled code for function ") & funcID->Enquote());
-          }
+      /*
+          Most functions defined by a library are never called by a given analysis,
+          so parsing the body is put off until it is first requested (GetBFFunctionBody).
+          Compiled functions, bodies which #include other files (a parse-time side effect),
+          and everything in strict mode are still parsed here.
+      */
+        
+      if (isCFunction || hy_strict_function_parsing || functionBody->sourceText.Find (blInclude) != kNotFound) {
+          BuildFunctionBody (*functionBody);
+          functionBody->is_compile_pending = isCFunction;
+      } else {
+          functionBody->is_deferred = true;
       }
 
-      //  take care of all the return statements
-      returnlist.Each ([functionBody] (long value, unsigned long) -> void {
-        ((_ElementaryCommand*)functionBody->GetItem(value))->simpleParameters << functionBody->countitems();
-      });
-      returnlist.Clear();
-        
       if (mark1>=0) {
           batchLanguageFunctions.Replace (mark1, functionBody, false);
           batchLanguageFunctionNames.Replace (mark1, funcID, false);
@@ -4793,6 +5074,7 @@ bool    _ElementaryCommand::ConstructFunction (_String&source, _ExecutionList& c
           batchLanguageFunctionParameterTypes &&(&argument_types);
           batchLanguageFunctionClassification <<(isLFunction ? kBLFunctionLocal :( isFFunction? kBLFunctionSkipUpdate :  kBLFunctionAlwaysUpdate));
       }
+      batchLanguageFunctionStamp++;
     } else {
       if (mark2 == source.length () || source[mark2]!='{' || source (-1L) !='}') {
         HandleApplicationError (_String("Namespace declaration is missing a body."));
@@ -4802,7 +5084,7 @@ bool    _ElementaryCommand::ConstructFunction (_String&source, _ExecutionList& c
       bool             success = false;
 
       isInFunction = _HY_NAMESPACE;
-      _ExecutionList   * namespace_payload = new _ExecutionList (namespace_text, funcID, false, &success);
+      _ExecutionList   * namespace_payload = new _ExecutionList (namespace_text, funcID, false, &success, &chain.sourceFile);
       DeleteObject (funcID);
         // 20180713 SLKP -- this was marked as deleted in one of the v2.3 branches
       if (success) {
@@ -4821,6 +5103,28 @@ bool    _ElementaryCommand::ConstructFunction (_String&source, _ExecutionList& c
     return true;
 }
 
+//____________________________________________________________________________________
+void    _ElementaryCommand::BuildFunctionBody (_ExecutionList& body) {
+  // parse body.sourceText as the body of an HBL function
+
+    _hy_nested_check save_state = isInFunction;
+    _SimpleList      outer_returns (returnlist);
+    _String          source (body.sourceText);
+
+    returnlist.Clear();
+    isInFunction      = _HY_FUNCTION;
+    body.is_deferred  = false;
+    body.BuildList (source, nil, false, true);
+
+    //  take care of all the return statements
+    returnlist.Each ([&body] (long value, unsigned long) -> void {
+      ((_ElementaryCommand*)body.GetItem(value))->simpleParameters << body.countitems();
+    });
+
+    returnlist   = outer_returns;
+    isInFunction = save_state;
+}
+
 //____________________________________________________________________________________
 bool    _ElementaryCommand::ConstructReturn (_String&source, _ExecutionList&target) {
 // syntax: return <statement>
@@ -4878,8 +5182,12 @@ void    ReadBatchFile (_String& fName, _ExecutionList& target) {
         if (source_file.BeginsWith ("#NEXUS",false)) {
             ReadDataSetFile (f,1,nil,&fName, nil, &hy_default_translation_table, &target);
         } else {
-            target.BuildList (source_file);
             target.sourceFile = fName;
+            bool const use_parse_cache = ParseCacheBeginFile (fName);
+            bool const result          = target.BuildList (source_file);
+            if (use_parse_cache) {
+                ParseCacheEndFile (result && !terminate_execution);
+            }
         }
         fclose (f);
     }
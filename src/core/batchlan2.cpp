@@ -1035,12 +1035,10 @@ bool    _ElementaryCommand::DecompileFormulae (void) {
       break;
     }
     case 14: {
-      if (parameters.lLength && simpleParameters.lLength == 2) {
-        _Formula* f = (_Formula*)simpleParameters.list_data[1];
-        if (f) {
-          delete f;
+      if (parameters.lLength && simpleParameters.lLength >= 2) {
+        while (simpleParameters.lLength > 1) {
+          delete (_Formula*)simpleParameters.Pop();
         }
-        simpleParameters.Delete (1);
         return true;
       }
       break;
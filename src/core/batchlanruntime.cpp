@@ -48,6 +48,8 @@
 #include      "mersenne_twister.h"
 #include      "global_things.h"
 #include      "hy_string_buffer.h"
+#include      "sampling_profiler.h"
+#include      "parse_cache.h"
 #include      "associative_list.h"
 #include      "tree_iterator.h"
 
@@ -229,9 +231,41 @@ BaseRef    _GetHBLObjectByTypeMutable (_String const&  source_name, long& type,
 
 //____________________________________________________________________________________
 
-_Variable* _ElementaryCommand::_ValidateStorageVariable (_ExecutionList& program, unsigned long argument_index) const {
-    _String  storage_id (program.AddNameSpaceToID(*GetIthParameter(argument_index)));
+_Variable* _ElementaryCommand::_ValidateStorageVariable (_ExecutionList& program, unsigned long argument_index) {
+    
+    /* the storage variable resolved on the previous execution is reused while no
+       variable slots have been freed or re-pointed (and the namespace is the same);
+       tree-valued receptacles always go through CheckReceptacleCommandIDException,
+       which replaces them; so do ^name and *name references, because the variable
+       they resolve to depends on the current value of 'name'
+    */
+    
+    _String const * storage_argument = GetIthParameter(argument_index);
+    bool const      is_reference     = storage_argument->nonempty() && (storage_argument->char_at (0UL) == '^' || storage_argument->char_at (0UL) == '*');
+    
+    if (storage_slots_stamp != variableSlotStamp || storage_slots_namespace != program.nameSpacePrefix) {
+        storage_slots.Clear();
+        storage_slots_stamp     = variableSlotStamp;
+        storage_slots_namespace = program.nameSpacePrefix;
+    }
+    
+    if (!is_reference && argument_index < storage_slots.countitems() && storage_slots.get (argument_index) >= 0L) {
+        _Variable * receptacle = LocateVar (storage_slots.get (argument_index));
+        if (receptacle && receptacle->ObjectClass() != TREE) {
+            return receptacle;
+        }
+    }
+    
+    _String  storage_id (program.AddNameSpaceToID(*storage_argument));
     _Variable * receptacle = CheckReceptacleCommandIDException (&AppendContainerName(storage_id,program.nameSpacePrefix),get_code(), true, false, &program);
+    
+    if (!is_reference && storage_slots_stamp == variableSlotStamp) {
+        while (storage_slots.countitems() <= argument_index) {
+            storage_slots << -1L;
+        }
+        storage_slots[argument_index] = receptacle->get_index();
+    }
+    
     return receptacle;
 }
 
@@ -369,7 +403,7 @@ bool      _ElementaryCommand::HandleExport(_ExecutionList& current_program){
     receptacle =    _ValidateStorageVariable (current_program);
 
     const _String source_name   = AppendContainerName (*GetIthParameter(1), current_program.nameSpacePrefix);
-    long          object_type = HY_BL_MODEL | HY_BL_LIKELIHOOD_FUNCTION | HY_BL_DATASET_FILTER | HY_BL_HBL_FUNCTION,
+    long          object_type = HY_BL_MODEL | HY_BL_LIKELIHOOD_FUNCTION | HY_BL_DATASET | HY_BL_DATASET_FILTER | HY_BL_HBL_FUNCTION,
                   object_index;
 
     BaseRef       source_object;
@@ -387,6 +421,11 @@ bool      _ElementaryCommand::HandleExport(_ExecutionList& current_program){
         receptacle->SetValue(new _FString (serialized_object), false);
         break;
       }
+      case HY_BL_DATASET: {
+        // binary snapshot, which ReadDataFile can restore directly
+        receptacle->SetValue(new _FString (((_DataSet*)source_object)->Snapshot()), false);
+        break;
+      }
       case HY_BL_DATASET_FILTER: {
         receptacle->SetValue(new _FString (new _String ((_String*)((_DataSetFilter*)source_object)->toStr())), false);
         ReleaseDataFilterLock(object_index);
@@ -416,9 +455,16 @@ bool      _ElementaryCommand::HandleGetDataInfo (_ExecutionList& current_program
      static const _String kPairwiseCountAmbiguitiesResolve                ("RESOLVE_AMBIGUITIES"),
                           kPairwiseCountAmbiguitiesAverage                ("AVERAGE_AMBIGUITIES"),
                           kPairwiseCountAmbiguitiesSkip                   ("SKIP_AMBIGUITIES"),
+                          kPairwiseCountAmbiguitiesFrequencies            ("RESOLVE_AMBIGUITIES_BY_FREQUENCY"),
                           kCharacters                                     ("CHARACTERS"),
                           kConsensus                                      ("CONSENSUS"),
-                          kParameters                                     ("PARAMETERS");
+                          kParameters                                     ("PARAMETERS"),
+                          kPairwiseDistances                              ("PAIRWISE_DISTANCES"),
+                          kPairwiseDistanceModel                          ("model"),
+                          kPairwiseDistanceAmbiguities                    ("ambigs"),
+                          kPairwiseDistanceFrequencies                    ("frequencies"),
+                          kPairwiseDistanceTN93Name                       ("TN93"),
+                          kPairwiseDistancePName                          ("P_DISTANCE");
 
 
     _Variable * receptacle = nil;
@@ -533,6 +579,63 @@ bool      _ElementaryCommand::HandleGetDataInfo (_ExecutionList& current_program
             break;
 
             case 4UL : {
+                _String argument;
+                try {
+                    argument = _ProcessALiteralArgument (*GetIthParameter(2),current_program);
+                } catch (const _String err) {
+                    // not a string
+                }
+              
+                if (argument == kPairwiseDistances) {
+                    // all pairwise distances between the sequences of a nucleotide filter
+                    if (!filter_source) {
+                        throw (argument.Enquote('\'') & " is only available for DataSetFilter objects");
+                    }
+                  
+                    _List dynamic_reference_manager;
+                    _AssociativeList * options = (_AssociativeList*)_ProcessAnArgumentByType(*GetIthParameter(3), ASSOCIATIVE_LIST, current_program, &dynamic_reference_manager);
+                  
+                    _FString * model_name  = (_FString*)options->GetByKey (kPairwiseDistanceModel, STRING),
+                             * ambiguities = (_FString*)options->GetByKey (kPairwiseDistanceAmbiguities, STRING);
+                  
+                    _hy_pairwise_distance_model model = kPairwiseDistanceTN93;
+                    if (model_name) {
+                        if (model_name->get_str() == kPairwiseDistancePName) {
+                            model = kPairwiseDistanceP;
+                        } else if (model_name->get_str() != kPairwiseDistanceTN93Name) {
+                            throw (model_name->get_str().Enquote() & " is not a supported distance (" & kPairwiseDistanceTN93Name & " or " & kPairwiseDistancePName & ")");
+                        }
+                    }
+                  
+                    _hy_dataset_filter_ambiguity_resolution resolution = kAmbiguityHandlingResolve;
+                    if (ambiguities) {
+                        if (kPairwiseCountAmbiguitiesAverage == ambiguities->get_str()) {
+                            resolution = kAmbiguityHandlingAverageFrequencyAware;
+                        } else if (kPairwiseCountAmbiguitiesSkip == ambiguities->get_str()) {
+                            resolution = kAmbiguityHandlingSkip;
+                        } else if (kPairwiseCountAmbiguitiesFrequencies == ambiguities->get_str()) {
+                            resolution = kAmbiguityHandlingResolveFrequencyAware;
+                        } else if (kPairwiseCountAmbiguitiesResolve != ambiguities->get_str()) {
+                            throw (ambiguities->get_str().Enquote() & " is not a supported ambiguity option (" & kPairwiseCountAmbiguitiesResolve & ", " & kPairwiseCountAmbiguitiesAverage & ", " & kPairwiseCountAmbiguitiesSkip & " or " & kPairwiseCountAmbiguitiesFrequencies & ")");
+                        }
+                    }
+                  
+                    hyFloat frequencies [4];
+                    bool    has_frequencies = false;
+                    if (_Matrix * frequency_vector = (_Matrix*)options->GetByKey (kPairwiseDistanceFrequencies, MATRIX)) {
+                        if (frequency_vector->GetHDim() * frequency_vector->GetVDim() != 4L) {
+                            throw (kPairwiseDistanceFrequencies.Enquote() & " must have exactly 4 entries");
+                        }
+                        for (long k = 0L; k < 4L; k++) {
+                            frequencies[k] = (*frequency_vector)[k];
+                        }
+                        has_frequencies = true;
+                    }
+                  
+                    receptacle->SetValue (filter_source->ComputePairwiseDistances(model, resolution, has_frequencies ? frequencies : nil), false);
+                    break;
+                }
+              
                 if (filter_source) {
                     long seq  = _ProcessNumericArgumentWithExceptions (*GetIthParameter(2),current_program.nameSpacePrefix),
                          site = _ProcessNumericArgumentWithExceptions (*GetIthParameter(3),current_program.nameSpacePrefix);
@@ -722,7 +825,7 @@ bool      _ElementaryCommand::HandleGetInformation (_ExecutionList& current_prog
                 _String reg_exp = GetStringFromFormula (&source_name,current_program.nameSpacePrefix);
                 if (reg_exp != *source_name) {
                     int errNo = 0;
-                    regex_t* regex = PrepRegExp (reg_exp, errNo, true);
+                    regex_t const* regex = CachedRegExp (reg_exp, errNo, true);
                     if (regex) {
                         _List       matches;
 
@@ -735,7 +838,6 @@ bool      _ElementaryCommand::HandleGetInformation (_ExecutionList& current_prog
                         if (matches.lLength) {
                             result = new _Matrix (matches);
                         }
-                        _String::FlushRegExp (regex);
                     } else {
                         HandleApplicationError (_String::GetRegExpError (errNo));
                     }
@@ -2074,7 +2176,12 @@ bool      _ElementaryCommand::HandleMPIReceive (_ExecutionList& current_program)
 
   try {
 
-#ifdef __HYPHYMPI__
+#if defined __HYPHYMPI__ || defined __HYPHY_LOCAL_WORKERS__
+#ifdef __HYPHY_LOCAL_WORKERS__
+    if (hy_mpi_node_count < 2) {
+      throw _String ("Command not supported for non-MPI versions of HyPhy. HBL scripts need to check for MPI before calling MPI features");
+    }
+#endif
 
     receptacle = _ValidateStorageVariable (current_program, 2UL);
     _Variable* node_index_storage = _ValidateStorageVariable (current_program, 1UL);
@@ -2110,7 +2217,12 @@ bool      _ElementaryCommand::HandleMPISend (_ExecutionList& current_program){
   
   try {
 
-#ifdef __HYPHYMPI__
+#if defined __HYPHYMPI__ || defined __HYPHY_LOCAL_WORKERS__
+#ifdef __HYPHY_LOCAL_WORKERS__
+    if (hy_mpi_node_count < 2) {
+      throw _String ("Command not supported for non-MPI versions of HyPhy. HBL scripts need to check for MPI before calling MPI features");
+    }
+#endif
    long target_node = _ProcessNumericArgumentWithExceptions(*GetIthParameter(0UL), current_program.nameSpacePrefix),
          node_count  = hy_env::EnvVariableGetNumber(hy_env::mpi_node_count);
 
@@ -2383,6 +2495,9 @@ bool      _ElementaryCommand::HandleFprintf (_ExecutionList& current_program) {
 
   current_program.advance();
 
+  /* only opening files and writing to them is charged to the profiler IO phase;
+     evaluating the arguments may call HBL functions, which must not be */
+
   bool     do_close                 = true,
   print_to_stdout          = false,
   skip_file_path_eval      = false,
@@ -2438,6 +2553,7 @@ bool      _ElementaryCommand::HandleFprintf (_ExecutionList& current_program) {
         if (!do_close) {
           destination_file = (FILE*)open_file_handles.GetXtra (open_handle);
         } else {
+          _hyProfilerPhase profiler_phase (kProfilerPhaseIO);
           if ((destination_file = doFileOpen (destination.get_str(), "a")) == nil)
             throw  (_String  ("Could not create/open output file at path ") & destination.Enquote() & ".");
         }
@@ -2499,6 +2615,7 @@ bool      _ElementaryCommand::HandleFprintf (_ExecutionList& current_program) {
       BaseRef printables [2] = {managed_object_to_print, dynamic_object_to_print};
       for (BaseRef obj : printables) {
         if (obj) {
+          _hyProfilerPhase profiler_phase (kProfilerPhaseIO);
           if (!print_to_stdout) {
             obj->toFileStr (destination_file);
           } else {
@@ -2528,6 +2645,7 @@ bool      _ElementaryCommand::HandleFprintf (_ExecutionList& current_program) {
 bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current_program, bool do_load_from_file, bool do_load_library) {
     current_program.advance ();
     _String * source_code = nil;
+    _String   source_path; // the file commands were read from, if any
     bool    pop_path = false;
     
     auto cleanup = [&] () -> void {
@@ -2613,7 +2731,8 @@ bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current
                 DeleteObject (source_code);
                 throw (_String("Internal error: failed in a call to fclose ") & file_path.Enquote());
             }
-            pop_path = true;
+            pop_path    = true;
+            source_path = file_path;
             PushFilePath (file_path);
         } else { // commands are not loaded from a file
             source_code = new _String (_ProcessALiteralArgument(*GetIthParameter(0UL), current_program));
@@ -2694,7 +2813,53 @@ bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current
         } else {
             bool result = false;
             
-            _ExecutionList code (*source_code, use_this_namespace, false, &result);
+            /* ExecuteCommands called repeatedly on the same text (e.g. the
+               transform argument of utility.ForEach) reuses the execution list
+               built on the previous call, together with the formulas compiled
+               by its commands, instead of re-parsing the text every time.
+               Lists that define HBL functions, have their own input redirects,
+               reported errors, or are currently being executed are not reused.
+            */
+            
+            bool const        can_cache = !do_load_from_file && !has_redirected_input && !has_user_kwargs && simpleParameters.empty();
+            _String const     namespace_key = use_this_namespace ? *use_this_namespace : kEmptyString;
+            _ExecutionList  * code = nil;
+            
+            if (can_cache && compiled_source && compiled_source->code->SingleReference() &&
+                compiled_source->variable_stamp == variableSlotStamp &&
+                compiled_source->function_stamp == batchLanguageFunctionStamp &&
+                compiled_source->name_space == namespace_key && compiled_source->source == *source_code) {
+                code = compiled_source->code;
+                code->AddAReference();
+                code->errorHandlingMode = current_program.errorHandlingMode;
+                code->errorState        = current_program.errorState;
+                result = true;
+            } else {
+                unsigned long const function_stamp = batchLanguageFunctionStamp;
+                _String     const source_text (*source_code); // BuildList consumes its argument
+                bool        const use_parse_cache = do_load_from_file && ParseCacheBeginFile (source_path);
+                code = new _ExecutionList (*source_code, use_this_namespace, false, &result, source_path.nonempty() ? &source_path : nil);
+                if (use_parse_cache) {
+                    ParseCacheEndFile (result && !terminate_execution && !current_program.IsErrorState());
+                }
+                
+                if (can_cache && result && function_stamp == batchLanguageFunctionStamp && !current_program.IsErrorState()) {
+                    // soft errors reported while parsing are recorded in current_program
+                    if (compiled_source) {
+                        DeleteObject (compiled_source->code);
+                    } else {
+                        compiled_source = new _HBLCompiledSource;
+                    }
+                    compiled_source->source         = source_text;
+                    compiled_source->name_space     = namespace_key;
+                    compiled_source->code           = code;
+                    compiled_source->variable_stamp = variableSlotStamp;
+                    compiled_source->function_stamp = batchLanguageFunctionStamp;
+                    code->AddAReference();
+                }
+            }
+            
+            dynamic_reference_manager.AppendNewInstance (code);
             
             if (!result) {
                 throw (_String("Encountered an error while parsing HBL"));
@@ -2710,8 +2875,8 @@ bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current
                 bool update_kw = false;
                 
                 if (has_redirected_input) {
-                    code.stdinRedirectAux = &_aux_argument_list;
-                    code.stdinRedirect = &argument_list;
+                    code->stdinRedirectAux = &_aux_argument_list;
+                    code->stdinRedirect = &argument_list;
                 } else {
                     if (current_program.has_stdin_redirect()) {
                         stash1 = current_program.stdinRedirect;
@@ -2719,34 +2884,34 @@ bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current
                         current_program.stdinRedirect->AddAReference();
                         current_program.stdinRedirectAux->AddAReference();
                     }
-                    code.stdinRedirect = current_program.stdinRedirect;
-                    code.stdinRedirectAux = current_program.stdinRedirectAux;
+                    code->stdinRedirect = current_program.stdinRedirect;
+                    code->stdinRedirectAux = current_program.stdinRedirectAux;
                 }
                 
                 
                 bool ignore_ces_args = false;
                 
                 if (has_user_kwargs) {
-                    code.SetKWArgs(user_kwargs);
+                    code->SetKWArgs(user_kwargs);
                     ignore_ces_args = true;
                 } else {
                     if (current_program.has_keyword_arguments()) {
-                        code.kwarg_tags = stash_kw_tags = current_program.kwarg_tags;
-                        code.kwargs = stash_kw = current_program.kwargs;
+                        code->kwarg_tags = stash_kw_tags = current_program.kwarg_tags;
+                        code->kwargs = stash_kw = current_program.kwargs;
                         if (stash_kw_tags) current_program.kwarg_tags->AddAReference();
                         if (stash_kw) current_program.kwargs->AddAReference();
-                        code.currentKwarg = current_program.currentKwarg;
+                        code->currentKwarg = current_program.currentKwarg;
                         update_kw = true;
                     }
                 }
                 
                 
                 
-                if (!simpleParameters.empty() && code.TryToMakeSimple(true)) {
-                    ReportWarning (_String ("Successfully compiled an execution list (possibly partially).\n") & _String ((_String*)code.toStr()) );
-                    code.ExecuteSimple ();
+                if (!simpleParameters.empty() && code->TryToMakeSimple(true)) {
+                    ReportWarning (_String ("Successfully compiled an execution list (possibly partially).\n") & _String ((_String*)code->toStr()) );
+                    code->ExecuteSimple ();
                 } else {
-                    code.Execute(nil, ignore_ces_args);
+                    code->Execute(nil, ignore_ces_args);
                 }
                 
                 if (stash1) {
@@ -2757,18 +2922,24 @@ bool      _ElementaryCommand::HandleExecuteCommandsCases(_ExecutionList& current
                 if (stash_kw_tags) stash_kw_tags->RemoveAReference();
                 if (stash_kw) stash_kw->RemoveAReference();
                 
-                code.stdinRedirectAux = nil;
-                code.stdinRedirect    = nil;
+                code->stdinRedirectAux = nil;
+                code->stdinRedirect    = nil;
                 if (update_kw) {
-                    code.kwarg_tags       = nil;
-                    code.kwargs           = nil;
-                    current_program.currentKwarg = code.currentKwarg;
+                    code->kwarg_tags       = nil;
+                    code->kwargs           = nil;
+                    current_program.currentKwarg = code->currentKwarg;
                 }
                 
-                if (code.result) {
+                if (code->result) {
                     DeleteObject (current_program.result);
-                    current_program.result = code.result;
-                    code.result = nil;
+                    current_program.result = code->result;
+                    code->result = nil;
+                }
+                
+                if ((terminate_execution || code->IsErrorState()) && compiled_source && compiled_source->code == code) {
+                    DeleteObject (compiled_source->code);
+                    delete compiled_source;
+                    compiled_source = nil;
                 }
             }
         }
@@ -2904,7 +3075,7 @@ bool      _ElementaryCommand::HandleDoSQL (_ExecutionList& current_program) {
 
 bool      _ElementaryCommand::HandleKeywordArgument (_ExecutionList& current_program) {
     current_program.advance ();
-#ifdef __HYPHYMPI__
+#if defined __HYPHYMPI__ || defined __HYPHY_LOCAL_WORKERS__
     // ignore keyword options for MPI nodes
     if (hy_mpi_node_rank > 0L) {
         return true;
@@ -2977,10 +3148,24 @@ bool      _ElementaryCommand::HandleGetString (_ExecutionList& current_program)
 
     auto make_fstring_pointer = [] (_String * s) -> _FString * {return new _FString (s);};
     auto make_fstring = [] (_String const s) -> _FString * {return new _FString (new _String (s));};
+    // statistics are passed by value: the record itself allocates _Constant objects,
+    // which would otherwise show up in the counters being reported
+    auto make_pool_record = [] (_hyObjectPoolStatistics const stats) -> _AssociativeList * {
+        return &(
+                 (*new _AssociativeList)
+               < (_associative_list_key_value){"requests", new _Constant (stats.requests) }
+               < (_associative_list_key_value){"recycled", new _Constant (stats.recycled) }
+               < (_associative_list_key_value){"overflow", new _Constant (stats.overflow) }
+               < (_associative_list_key_value){"live", new _Constant (stats.live) }
+               < (_associative_list_key_value){"peak", new _Constant (stats.peak) }
+               < (_associative_list_key_value){"capacity", new _Constant (stats.capacity) }
+                 );
+    };
 
     static const _String kVersionString                   ("HYPHY_VERSION"),
                          kTimeStamp                       ("TIME_STAMP"),
-                         kListLoadedLibraries             ("LIST_OF_LOADED_LIBRARIES");
+                         kListLoadedLibraries             ("LIST_OF_LOADED_LIBRARIES"),
+                         kObjectPoolStatistics            ("OBJECT_POOL_STATISTICS");
 
 
     _Variable * receptacle = nil;
@@ -3012,6 +3197,16 @@ bool      _ElementaryCommand::HandleGetString (_ExecutionList& current_program)
         return_value = make_fstring (GetTimeStamp (index1 < 0.5));
       }  else if (*GetIthParameter(1UL) == kListLoadedLibraries) {
         return_value = new _Matrix (loadedLibraryPaths.Keys());
+      }  else if (*GetIthParameter(1UL) == kObjectPoolStatistics) {
+        _hyObjectPoolStatistics const number_stats = _Constant::PoolStatistics(),
+                                      string_stats = _FString::PoolStatistics(),
+                                      buffer_stats = _StringBuffer::PoolStatistics();
+        return_value =  &(
+                          (*new _AssociativeList)
+                        < (_associative_list_key_value){"Number", make_pool_record (number_stats) }
+                        < (_associative_list_key_value){"String", make_pool_record (string_stats) }
+                        < (_associative_list_key_value){"StringBuffer", make_pool_record (buffer_stats) }
+                          );
       }
 
       if (!return_value) {
@@ -3372,6 +3567,8 @@ bool      _ElementaryCommand::HandleFscanf (_ExecutionList& current_program, boo
               return false;
          }
         
+        // only reading the file is charged to the profiler IO phase (not evaluating arguments or parsing the contents)
+        _hyProfilerPhase profiler_phase (kProfilerPhaseIO);
         FILE * input_stream = doFileOpen (file_path.get_str(), "rb");
         if (!input_stream) {
           throw     (file_path.Enquote() & " could not be opened for reading by fscanf. Path stack:\n\t" & GetPathStack("\n\t"));
@@ -3384,19 +3581,41 @@ bool      _ElementaryCommand::HandleFscanf (_ExecutionList& current_program, boo
           last_call_stream_position = 0L;
         }
 
-        fseek (input_stream,0,SEEK_END);
-        current_stream_position    = ftell (input_stream);
+        // compressed files are decoded from the start, but only the part past the last position is kept
+        // (as with uncompressed files, the rest of the file is held in memory)
+        _StringBuffer * decompressed;
+        unsigned long   decompressed_length = 0UL;
+        try {
+          decompressed = DecompressFile (input_stream, last_call_stream_position, decompressed_length);
+        } catch (const _String&) {
+          fclose (input_stream);
+          throw;
+        }
+        
+        if (decompressed) {
+          // stream positions index the decompressed contents
+          current_stream_position = decompressed_length;
+        } else {
+          fseek (input_stream,0,SEEK_END);
+          current_stream_position    = ftell (input_stream);
+        }
         current_stream_position   -= last_call_stream_position;
         
         if (current_stream_position<=0) {
           hy_env::EnvVariableSet(hy_env::end_of_file, new HY_CONSTANT_TRUE, false);
           fclose(input_stream);
+          DeleteObject (decompressed);
           return true;
         }
         
-        rewind (input_stream);
-        fseek  (input_stream, last_call_stream_position, SEEK_SET);
-        _String * file_data = new _String (input_stream, current_stream_position);
+        _String * file_data;
+        if (decompressed) {
+          file_data = decompressed;
+        } else {
+          rewind (input_stream);
+          fseek  (input_stream, last_call_stream_position, SEEK_SET);
+          file_data = new _String (input_stream, current_stream_position);
+        }
         fclose (input_stream);
         dynamic_reference_manager < file_data;
         input_data = file_data;
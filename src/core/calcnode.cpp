@@ -142,6 +142,7 @@ void    _CalcNode::InitializeCN     ( _String const& parms, int, _VariableContai
     }
     
     variablePtrs.Replace(theIndex, this, true);
+    variableChangeStamp++;
     
         /** TODO check equivalence **
          
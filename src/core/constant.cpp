@@ -65,8 +65,7 @@ long                        lastMatrixDeclared = -1,
                             dummyVariable2,
                             expressionsParsed = 0;
 
-unsigned char               _Constant::preallocated_buffer [_HY_CONSTANT_PREALLOCATE_SLOTS*sizeof (_Constant)];
-_SimpleList                 _Constant::free_slots;
+static _hyObjectPool <_Constant, _HY_CONSTANT_PREALLOCATE_SLOTS>     _hy_constant_pool;
 
 //___________________________________________________________________________________________
 hyFloat  gaussDeviate (void) {
@@ -461,22 +460,17 @@ BaseRef _Constant::makeDynamic (void) const{
 
 //__________________________________________________________________________________
 void * _Constant::operator new (size_t size) {
-    if (_Constant::free_slots.nonempty()) {
-        _Constant * result = ((_Constant*)_Constant::preallocated_buffer)+_Constant::free_slots.Pop();
-        return result;
-    }
-    return ::operator new (size);
+    return _hy_constant_pool.Allocate (size);
 }
 
 //__________________________________________________________________________________
-void  _Constant::operator delete (void * p) {
-    _Constant * cp = (_Constant*)p,
-              * cpp = (_Constant*)_Constant::preallocated_buffer;
-    if (cp >= cpp &&  cp < (cpp + _HY_CONSTANT_PREALLOCATE_SLOTS)) {
-        free_slots << long (cp - cpp);
-    } else {
-        ::operator delete (p);
-    }
+void  _Constant::operator delete (void * p, size_t size) {
+    _hy_constant_pool.Release (p, size);
+}
+
+//__________________________________________________________________________________
+_hyObjectPoolStatistics const & _Constant::PoolStatistics (void) {
+    return _hy_constant_pool.Statistics();
 }
 
 //__________________________________________________________________________________
@@ -44,11 +44,19 @@
 #include "batchlan.h"
 #include "site.h"
 #include "global_object_lists.h"
+#include "sampling_profiler.h"
+#include "vector.h"
+
+#if defined __UNIX__ && !defined __MINGW32__
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
 
 using namespace hyphy_global_objects;
 
 
 #define DATA_SET_SWITCH_THRESHOLD 100000
+#define HYPHY_DATA_SET_PENDING_WRITES 0x1000000L
 
 
 _DataSet::_DataSet(void) {
@@ -92,6 +100,7 @@ _DataSet::~_DataSet(void) {
 //_______________________________________________________________________
 
 void _DataSet::Clear(bool) {
+  stateCaches.Clear();
   _List::Clear();
   theMap.Clear();
   theFrequencies.Clear();
@@ -181,6 +190,7 @@ void _DataSet::ConvertRepresentations(void) {
 //_______________________________________________________________________
 
 void _DataSet::AddSite(char c) {
+  FlushPendingWrites();
   if (streamThrough) {
     if (theMap.list_data[0] == 0) {
       if (theMap.list_data[1] == 0) {
@@ -243,6 +253,7 @@ void _DataSet::AddSite(char c) {
 //_______________________________________________________________________
 
 void _DataSet::Write2Site(long index, char c) {
+  FlushPendingWrites();
   if (streamThrough) {
     if (index == 0) {
       if (theMap.list_data[2] == theMap.list_data[1]) {
@@ -349,6 +360,142 @@ void _DataSet::Write2Site(long index, char c) {
 
 //_______________________________________________________________________
 
+void _DataSet::Write2Sites(long index, const char * letters, long count) {
+  if (count <= 0L) {
+    return;
+  }
+
+  if (!streamThrough) {
+    if (useHorizontalRep) {
+      // locate the sequence being written to once, and append the whole run
+      long currentWritten = ((_String *)list_data[0])->length();
+
+      if (index + count > currentWritten) {
+        HandleApplicationError("Internal Error in 'Write2Site' - index is too "
+                               "high (using compact representation)");
+        return;
+      }
+
+      if (index == 0) {
+        _StringBuffer *newString = new _StringBuffer(currentWritten);
+        newString->PushCharBuffer(letters, count);
+        (*this) < newString;
+      } else {
+        long s = 1;
+        for (; s < lLength; s++) {
+          _StringBuffer *aString = (_StringBuffer *)list_data[s];
+          if (aString->length() == index) {
+            aString->PushCharBuffer(letters, count);
+            break;
+          }
+        }
+        if (s == lLength) {
+          HandleApplicationError("Internal Error in 'Write2Site' - no "
+                                 "appropriate  string to write too (compact "
+                                 "representation)");
+        }
+      }
+      return;
+    }
+
+    if (index + count <= lLength) {
+      // appending to every site of a row one character at a time touches a
+      // different buffer for each character; instead, queue the run, and write
+      // queued rows column by column once enough of them have accumulated
+
+      if (!dsh) {
+        dsh = new _DSHelper;
+      }
+
+      _SimpleList &runs = dsh->pendingRuns;
+
+      if (runs.nonempty() && runs.list_data[runs.lLength - 2] +
+                                     runs.list_data[runs.lLength - 1] == index) {
+        runs.list_data[runs.lLength - 1] += count; // continues the last run
+      } else {
+        runs << index << count;
+      }
+      dsh->pendingLetters.PushCharBuffer(letters, count);
+
+      if (dsh->pendingLetters.length() >= HYPHY_DATA_SET_PENDING_WRITES) {
+        FlushPendingWrites();
+      }
+      return;
+    }
+  }
+
+  for (long i = 0L; i < count; i++) {
+    Write2Site(index + i, letters[i]);
+  }
+}
+
+//_______________________________________________________________________
+
+void _DataSet::FlushPendingWrites(void) {
+  if (!dsh || dsh->pendingRuns.empty()) {
+    return;
+  }
+
+  _SimpleList runs(dsh->pendingRuns);
+  dsh->pendingRuns.Clear(); // Write2Site below must not flush again
+
+  long const run_count = runs.lLength >> 1;
+  long first_site = runs.list_data[0], last_site = 0L;
+
+  _SimpleList offsets((unsigned long)run_count);
+
+  for (long r = 0L, offset = 0L; r < run_count; r++) {
+    offsets << offset;
+    offset += runs.list_data[2 * r + 1];
+    StoreIfLess(first_site, runs.list_data[2 * r]);
+    StoreIfGreater(last_site, runs.list_data[2 * r] + runs.list_data[2 * r + 1]);
+  }
+
+  const long kBlockSize = 256L;
+  const char *source = dsh->pendingLetters.get_str();
+  char *column = (char *)MemAllocate(run_count);
+  _SimpleList block_runs((unsigned long)run_count);
+
+  for (long block = first_site; block < last_site; block += kBlockSize) {
+    long const block_end = MIN(block + kBlockSize, last_site);
+
+    block_runs.Clear(false);
+    for (long r = 0L; r < run_count; r++) {
+      long const start = runs.list_data[2 * r];
+      if (start < block_end && start + runs.list_data[2 * r + 1] > block) {
+        block_runs << r;
+      }
+    }
+
+    for (long site = block; site < block_end; site++) {
+      long letter_count = 0L;
+      for (long k = 0L; k < block_runs.lLength; k++) {
+        long const r = block_runs.list_data[k],
+                   start = runs.list_data[2 * r];
+        if (site >= start && site < start + runs.list_data[2 * r + 1]) {
+          column[letter_count++] = source[offsets.list_data[r] + site - start];
+        }
+      }
+
+      if (letter_count) {
+        _Site *s = (_Site *)list_data[site];
+        if (s->GetRefNo() == -1) { // independent site
+          s->PushCharBuffer(column, letter_count);
+        } else {
+          for (long k = 0L; k < letter_count; k++) {
+            Write2Site(site, column[k]);
+          }
+        }
+      }
+    }
+  }
+
+  free(column);
+  dsh->pendingLetters.Clear();
+}
+
+//_______________________________________________________________________
+
 void _DataSet::CheckMapping(long index) {
   if (index >= lLength) {
     HandleApplicationError(
@@ -396,6 +543,7 @@ void _DataSet::SetTranslationTable(_DataSet *newTT) {
     DeleteObject(theTT);
   }
   theTT = (_TranslationTable *)newTT->theTT->makeDynamic();
+  stateCaches.Clear();
 }
 
 //_______________________________________________________________________
@@ -405,14 +553,178 @@ void _DataSet::SetTranslationTable(_TranslationTable *newTT) {
     DeleteObject(theTT);
   }
   theTT = (_TranslationTable *)newTT->makeDynamic();
+  stateCaches.Clear();
+}
+//_______________________________________________________________________
+
+unsigned long HashCharacterBuffer(const char *buffer, unsigned long length) {
+  const unsigned long long kPrime1 = 11400714785074694791ULL,
+                           kPrime2 = 14029467366897019727ULL,
+                           kPrime3 = 1609587929392839161ULL;
+
+  auto rotate = [](unsigned long long v, int by) -> unsigned long long {
+    return (v << by) | (v >> (64 - by));
+  };
+
+  unsigned long long h = kPrime3 + length * kPrime1;
+  unsigned long i = 0UL;
+
+  for (; i + 8UL <= length; i += 8UL) {
+    unsigned long long word;
+    memcpy(&word, buffer + i, 8UL);
+    h ^= rotate(word * kPrime2, 31) * kPrime1;
+    h = rotate(h, 27) * kPrime1 + kPrime3;
+  }
+  for (; i < length; i++) {
+    h ^= (unsigned char)buffer[i] * kPrime1;
+    h = rotate(h, 11) * kPrime2;
+  }
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return (unsigned long)h;
+}
+
+//_______________________________________________________________________
+
+_PatternHashTable::_PatternHashTable(unsigned long expected_patterns) {
+  unsigned long capacity = 64UL;
+  while (capacity < expected_patterns * 2UL) {
+    capacity <<= 1;
+  }
+  slots.Populate(capacity, -1L, 0L);
+  hashes.Populate(capacity, 0L, 0L);
+  used = 0UL;
+}
+
+//_______________________________________________________________________
+
+void _PatternHashTable::Grow(void) {
+  _SimpleList old_slots(slots), old_hashes(hashes);
+
+  unsigned long const capacity = slots.lLength << 1,
+                      mask = capacity - 1UL;
+
+  slots.Populate(capacity, -1L, 0L);
+  hashes.Populate(capacity, 0L, 0L);
+
+  for (unsigned long k = 0UL; k < old_slots.lLength; k++) {
+    if (old_slots.list_data[k] >= 0L) {
+      unsigned long i = (unsigned long)old_hashes.list_data[k] & mask;
+      while (slots.list_data[i] >= 0L) {
+        i = (i + 1UL) & mask;
+      }
+      slots.list_data[i] = old_slots.list_data[k];
+      hashes.list_data[i] = old_hashes.list_data[k];
+    }
+  }
+}
+
+//_______________________________________________________________________
+
+_DataSetStateCache::_DataSetStateCache(_String const &cache_key)
+    : key(cache_key), states(&stateStrings) {
+  ambiguities = new _Vector;
+  ambiguityCount = 0L;
+}
+
+//_______________________________________________________________________
+
+_DataSetStateCache::~_DataSetStateCache(void) { DeleteObject(ambiguities); }
+
+//_______________________________________________________________________
+
+BaseRef _DataSetStateCache::makeDynamic(void) const {
+  _DataSetStateCache *copy = new _DataSetStateCache(key);
+  copy->Duplicate(this);
+  return copy;
+}
+
+//_______________________________________________________________________
+
+void _DataSetStateCache::Duplicate(BaseRefConst source) {
+  _DataSetStateCache const *from = (_DataSetStateCache const *)source;
+  key = from->key;
+  conversion.Duplicate(&from->conversion);
+  states.Clear(true);
+  for (unsigned long k = 0UL; k < from->stateStrings.lLength; k++) {
+    states.Insert(new _String(*(_String const *)from->stateStrings.GetItem(k)),
+                  from->states.GetXtra(k));
+  }
+  ambiguities->Duplicate(from->ambiguities);
+  ambiguityCount = from->ambiguityCount;
+}
+
+//_______________________________________________________________________
+
+bool _DataSetStateCache::Lookup(_String const &state, long &code) const {
+  long const found = states.Find(&state);
+  if (found >= 0L) {
+    code = states.GetXtra(found);
+    return true;
+  }
+  return false;
+}
+
+//_______________________________________________________________________
+
+long _DataSetStateCache::Store(_String const &state, long code,
+                               hyFloat const *resolution,
+                               unsigned long dimension) {
+  if (code < 0L) {
+    for (unsigned long k = 0UL; k < dimension; k++) {
+      ambiguities->Store(resolution[k]);
+    }
+    code = -(++ambiguityCount);
+  }
+  states.Insert(new _String(state), code);
+  return code;
+}
+
+//_______________________________________________________________________
+
+_DataSetStateCache *_DataSet::GetStateCache(unsigned char unit,
+                                            _SimpleList const &exclusions) const {
+  // everything the conversions of a filter depend on, other than the data set
+  _StringBuffer key(64UL);
+  key << _String((long)unit) << '|' << _String((long)theTT->baseLength) << '|'
+      << theTT->tokensAdded << '|' << theTT->baseSet << '|';
+  auto append_codes = [&key](long code, unsigned long) -> void {
+    key << _String(code) << ',';
+  };
+  theTT->translationsAdded.Each(append_codes);
+  key << '|';
+  exclusions.Each(append_codes);
+
+  for (unsigned long k = 0UL; k < stateCaches.lLength; k++) {
+    _DataSetStateCache *cache = (_DataSetStateCache *)stateCaches.GetItem(k);
+    if (cache->Key() == key) {
+      cache->AddAReference();
+      return cache;
+    }
+  }
+
+  _DataSetStateCache *cache = new _DataSetStateCache(key);
+  stateCaches << cache; // the data set keeps a reference of its own
+  return cache;
 }
+
 //_______________________________________________________________________
 void _DataSet::Finalize(void) {
+  FlushPendingWrites();
   if (streamThrough) {
     fclose(streamThrough);
     streamThrough = nil;
     theMap.Clear();
   } else {
+    // identical columns are found by hashing every column (in parallel),
+    // and confirming hash matches by comparing the columns themselves
+
+    const long kHashBlock = 64L;
+
     if (useHorizontalRep) {
       bool good = true;
       for (long s = 0; s < lLength; s++) {
@@ -428,34 +740,68 @@ void _DataSet::Finalize(void) {
         return;
       }
 
-      _List dups;
-      _List uniquePats;
-      _AVLListX dupsAVL(&dups);
+      long const siteCounter = ((_String *)list_data[0])->length(),
+                 sequences = lLength;
 
-      long siteCounter = ((_String *)list_data[0])->length();
+#ifdef _OPENMP
+      long const nt = MIN(omp_get_max_threads(), siteCounter / (kHashBlock * 16L) + 1L);
+#endif
 
-      for (long i1 = 0L; i1 < siteCounter; i1++) {
-        _Site *tC = new _Site();
+      _String const **rows = (_String const **)list_data;
+      _SimpleList hashes;
+      hashes.Populate(siteCounter, 0L, 0L);
+
+      // columns are gathered kHashBlock at a time, so that every row is read
+      // in contiguous stretches rather than one character per column
+
+#ifdef _OPENMP
+#pragma omp parallel for default(shared) schedule(static) if (nt > 1) num_threads(nt)
+#endif
+      for (long block = 0L; block < siteCounter; block += kHashBlock) {
+        long const block_end = MIN(block + kHashBlock, siteCounter);
+        char *columns = (char *)MemAllocate(kHashBlock * sequences);
 
-        for (long i2 = 0L; i2 < lLength; i2++) {
-          (*tC) << ((_String *)list_data[i2])->get_char(i1);
+        for (long r = 0L; r < sequences; r++) {
+          const char *row = rows[r]->get_str();
+          for (long c = block; c < block_end; c++) {
+            columns[(c - block) * sequences + r] = row[c];
+          }
+        }
+        for (long c = block; c < block_end; c++) {
+          hashes.list_data[c] = HashCharacterBuffer(columns + (c - block) * sequences, sequences);
         }
+        free(columns);
+      }
+
+      _List uniquePats;
+      _PatternHashTable patterns;
+
+      for (long i1 = 0L; i1 < siteCounter; i1++) {
+        long ff = patterns.FindOrInsert(hashes.list_data[i1], i1, [&](long other) -> bool {
+          for (long r = 0L; r < sequences; r++) {
+            const char *row = rows[r]->get_str();
+            if (row[i1] != row[other]) {
+              return false;
+            }
+          }
+          return true;
+        });
 
-        long ff = dupsAVL.Find(tC);
         if (ff < 0) {
-          uniquePats << tC;
-          dupsAVL.Insert(tC, theFrequencies.lLength);
+          _Site *tC = new _Site();
+          for (long i2 = 0L; i2 < sequences; i2++) {
+            (*tC) << rows[i2]->get_char(i1);
+          }
+          uniquePats < tC;
           theMap << theFrequencies.lLength;
           theFrequencies << 1;
         } else {
-          ff = dupsAVL.GetXtra(ff);
+          ff = theMap.list_data[ff];
           theMap << ff;
           theFrequencies.list_data[ff]++;
         }
-
-        DeleteObject(tC);
       }
-      dupsAVL.Clear(false);
+
       _List::Clear();
       _List::Duplicate(&uniquePats);
     } else {
@@ -463,22 +809,31 @@ void _DataSet::Finalize(void) {
 
       _Site *tC;
       {
-        _List dups;
-        _AVLListX dupsAVL(&dups);
+        _SimpleList hashes;
+        hashes.Populate(lLength, 0L, 0L);
+
+#ifdef _OPENMP
+        long const nt = MIN(omp_get_max_threads(), lLength / (kHashBlock * 16L) + 1L);
+#pragma omp parallel for default(shared) schedule(static, kHashBlock) if (nt > 1) num_threads(nt)
+#endif
+        for (long i1 = 0; i1 < lLength; i1++) {
+          _Site const *site = (_Site const *)list_data[i1];
+          hashes.list_data[i1] = HashCharacterBuffer(site->get_str(), site->length());
+        }
+
+        _PatternHashTable patterns(lLength);
 
         for (long i1 = 0; i1 < lLength; i1++) {
           tC = (_Site *)list_data[i1];
-          long ff = dupsAVL.Find(tC);
-          if (ff < 0) {
-            dupsAVL.Insert(tC, i1);
-          } else {
-            ff = dupsAVL.GetXtra(ff);
+          long ff = patterns.FindOrInsert(hashes.list_data[i1], i1, [&](long other) -> bool {
+            return tC->Equal(*(_Site const *)list_data[other]);
+          });
+          if (ff >= 0) {
             tC->Clear();
             tC->SetRefNo(ff);
             theFrequencies.list_data[ff]++;
           }
         }
-        dupsAVL.Clear(false);
       }
 
       _SimpleList refs(lLength), toDelete(lLength);
@@ -527,6 +882,7 @@ void _DataSet::Finalize(void) {
 }
 //_______________________________________________________________________
 void _DataSet::Compact(long index) {
+  FlushPendingWrites();
   if (useHorizontalRep) {
     HandleApplicationError(
         "Internal Error: _DataSet::Compact called with compact represntation",
@@ -902,13 +1258,13 @@ void    _DataSet::ProcessPartition (_String const & input2 , _SimpleList & targe
         
         if (is_regexp || is_hbl_function >= 0L) {
             // a regular expression or a callback
-            regex_t*   regex = nil;
+            regex_t const*   regex = nil;
             _Formula   filter_formula;
             
             if (is_regexp) {
                 input.Trim(1,input.length()-2);
                 int   errCode;
-                regex = _String::PrepRegExp (input, errCode, true);
+                regex = _String::CachedRegExp (input, errCode, true);
                 if (errCode) {
                     HandleApplicationError(_String::GetRegExpError(errCode));
                     return;
@@ -1127,9 +1483,6 @@ void    _DataSet::ProcessPartition (_String const & input2 , _SimpleList & targe
                
                 delete [] eligibleMarks;
             }
-            if (regex) {
-                _String::FlushRegExp (regex);
-            }
         } else {
             input = input.KillSpaces ();
             // now process the string
@@ -1249,6 +1602,212 @@ void    _DataSet::ProcessPartition (_String const & input2 , _SimpleList & targe
 
 //_________________________________________________________
 
+// snapshot layout: the header (signature, version, byte order mark,
+// payload length, payload checksum), followed by the payload
+//   species, unique patterns, sites
+//   translation table (0 for the default one, or 1 followed by its fields)
+//   sequence names
+//   unique patterns (species characters each)
+//   site-to-pattern map
+//   pattern frequencies
+// integers are stored as native 64-bit values, strings as length + characters
+
+static const char kSnapshotSignature[8] = {'\x89', 'H', 'Y', 'D', 'S', '\r', '\n', '\x1a'};
+static const long long kSnapshotVersion = 1LL,
+                       kSnapshotByteOrder = 0x0102030405060708LL;
+static const unsigned long kSnapshotHeaderLength = sizeof(kSnapshotSignature) + 4UL * sizeof(long long);
+
+_StringBuffer *_DataSet::Snapshot(void) const {
+  unsigned long const species = noOfSpecies, patterns = lLength, sites = theMap.lLength;
+
+  if (useHorizontalRep && patterns && ((_String const *)list_data[0])->length() != species) {
+    throw _String("Only finalized data sets can be exported");
+  }
+
+  bool const default_table = theTT == &hy_default_translation_table;
+
+  unsigned long payload_length = (3UL + 1UL + sites + patterns) * sizeof(long long) + patterns * species;
+
+  if (!default_table) {
+    payload_length += (4UL + theTT->translationsAdded.lLength) * sizeof(long long) +
+                      theTT->tokensAdded.length() + theTT->baseSet.length();
+  }
+  theNames.ForEach([&](BaseRefConst name, unsigned long) -> void {
+    payload_length += sizeof(long long) + ((_String const *)name)->length();
+  });
+
+  _StringBuffer *snapshot = new _StringBuffer(kSnapshotHeaderLength + payload_length);
+
+  auto put_integer = [snapshot](long long value) -> void {
+    snapshot->PushCharBuffer((const char *)&value, sizeof(long long));
+  };
+  auto put_string = [snapshot, put_integer](_String const &value) -> void {
+    put_integer(value.length());
+    snapshot->PushCharBuffer(value.get_str(), value.length());
+  };
+
+  snapshot->PushCharBuffer(kSnapshotSignature, sizeof(kSnapshotSignature));
+  put_integer(kSnapshotVersion);
+  put_integer(kSnapshotByteOrder);
+  put_integer(payload_length);
+  put_integer(0LL); // the checksum is filled in below
+
+  put_integer(species);
+  put_integer(patterns);
+  put_integer(sites);
+
+  if (default_table) {
+    put_integer(0LL);
+  } else {
+    put_integer(1LL);
+    put_integer(theTT->baseLength);
+    put_string(theTT->tokensAdded);
+    put_string(theTT->baseSet);
+    put_integer(theTT->translationsAdded.lLength);
+    theTT->translationsAdded.Each([put_integer](long value, unsigned long) -> void { put_integer(value); });
+  }
+
+  for (unsigned long k = 0UL; k < species; k++) {
+    put_string(*GetSequenceName(k));
+  }
+
+  for (unsigned long p = 0UL; p < patterns; p++) {
+    _Site const *pattern = (_Site const *)list_data[p];
+    if (pattern->length() != species) {
+      DeleteObject(snapshot);
+      throw _String("Only finalized data sets can be exported");
+    }
+    snapshot->PushCharBuffer(pattern->get_str(), species);
+  }
+
+  theMap.Each([put_integer](long value, unsigned long) -> void { put_integer(value); });
+  theFrequencies.Each([put_integer](long value, unsigned long) -> void { put_integer(value); });
+
+  unsigned long long const checksum = HashCharacterBuffer(snapshot->get_str() + kSnapshotHeaderLength, payload_length);
+  memcpy((char *)snapshot->get_str() + kSnapshotHeaderLength - sizeof(long long), &checksum, sizeof(long long));
+
+  return snapshot;
+}
+
+//_________________________________________________________
+
+_DataSet *_DataSet::FromSnapshot(const char *source, unsigned long length) {
+  if (length < kSnapshotHeaderLength || memcmp(source, kSnapshotSignature, sizeof(kSnapshotSignature))) {
+    return nil;
+  }
+
+  const char *read_from = source + sizeof(kSnapshotSignature),
+             *read_to = source + length;
+
+  auto get_integer = [&](void) -> long long {
+    long long value;
+    if (read_from + sizeof(long long) > read_to) {
+      throw _String("Truncated data set snapshot");
+    }
+    memcpy(&value, read_from, sizeof(long long));
+    read_from += sizeof(long long);
+    return value;
+  };
+
+  auto get_buffer = [&](unsigned long long size) -> const char * {
+    if (size > (unsigned long long)(read_to - read_from)) {
+      throw _String("Truncated data set snapshot");
+    }
+    const char *buffer = read_from;
+    read_from += size;
+    return buffer;
+  };
+
+  auto get_string = [&](_String &value) -> void {
+    unsigned long long const size = get_integer();
+    const char *characters = get_buffer(size);
+    _StringBuffer buffer(size);
+    buffer.PushCharBuffer(characters, size);
+    value = buffer;
+  };
+
+  if (get_integer() != kSnapshotVersion) {
+    throw _String("Unsupported data set snapshot version");
+  }
+  if (get_integer() != kSnapshotByteOrder) {
+    throw _String("The data set snapshot was written on a platform with a different byte order");
+  }
+
+  unsigned long long const payload_length = get_integer(),
+                           checksum = get_integer();
+
+  if (payload_length != (unsigned long long)(read_to - read_from)) {
+    throw _String("Truncated data set snapshot");
+  }
+  if (checksum != HashCharacterBuffer(read_from, payload_length)) {
+    throw _String("Data set snapshot checksum mismatch");
+  }
+
+  unsigned long const species = get_integer(), patterns = get_integer(), sites = get_integer();
+
+  _DataSet *result = new _DataSet(patterns);
+
+  try {
+    if (get_integer()) {
+      _TranslationTable *table = new _TranslationTable;
+      result->theTT = table;
+      table->baseLength = get_integer();
+      get_string(table->tokensAdded);
+      get_string(table->baseSet);
+      for (long long k = get_integer(); k > 0LL; k--) {
+        table->translationsAdded << get_integer();
+      }
+    }
+
+    for (unsigned long k = 0UL; k < species; k++) {
+      _String name;
+      get_string(name);
+      result->theNames < new _String(name);
+    }
+
+    for (unsigned long p = 0UL; p < patterns; p++) {
+      _Site *pattern = new _Site;
+      pattern->PushCharBuffer(get_buffer(species), species);
+      pattern->TrimSpace();
+      pattern->SetRefNo(0);
+      (*result) < pattern;
+    }
+
+    auto get_list = [&](_SimpleList &list, unsigned long count) -> void {
+      const char *values = get_buffer(count * sizeof(long long));
+      if (sizeof(long) == sizeof(long long)) {
+        list.RequestSpace(count);
+        memcpy(list.list_data, values, count * sizeof(long long));
+        list.lLength = count;
+      } else {
+        for (unsigned long k = 0UL; k < count; k++) {
+          long long value;
+          memcpy(&value, values + k * sizeof(long long), sizeof(long long));
+          list << value;
+        }
+      }
+    };
+
+    get_list(result->theMap, sites);
+    get_list(result->theFrequencies, patterns);
+
+    for (unsigned long k = 0UL; k < sites; k++) {
+      if (result->theMap.list_data[k] < 0L || result->theMap.list_data[k] >= (long)patterns) {
+        throw _String("Invalid site-to-pattern map in the data set snapshot");
+      }
+    }
+
+    result->noOfSpecies = species;
+  } catch (const _String &) {
+    DeleteObject(result);
+    throw;
+  }
+
+  return result;
+}
+
+//_________________________________________________________
+
 _DataSet *_DataSet::Concatenate(_SimpleList const &ref)
 
 // concatenates (adds columns together) several datasets
@@ -1721,53 +2280,65 @@ void    ProcessTree (FileState *fState, FILE* f, _String& CurrentLine) {
 //_________________________________________________________
 
 long    ProcessLine (_String&s , FileState *fs, _DataSet& ds) {
-    long sitesAttached = 0L;
     
-    try {
-        s.Each([&] (char letter, unsigned long i) -> void {
-            letter = toupper(letter);
-            if (fs->translationTable->IsCharLegal(letter)) { // go on
-                if (fs->curSpecies==0) { // add new column
-                    ds.AddSite (letter);
-                    sitesAttached++;
-                } else { //append to exisiting column
-                         //if (c == fs->skip) continue;
-                         // check to see if this species needs to be padded
-                    
-                    if (letter == fs->repeat) {
-                        if ( fs->curSite+sitesAttached >= ds.lLength) { // a dot not matched by a previously read character; ignore
-                            throw sitesAttached;
-                        }
-                        
-                        letter = ((_Site*)(ds._List::operator () (fs->curSite+sitesAttached)))->get_char(0);
-                        if (letter=='\0') {
-                            letter = ((_Site*)(ds._List::operator ()
-                                          (((_Site*)(ds._List::operator () (fs->curSite+sitesAttached)))->GetRefNo())))->get_char(0);
-                        }
+    // collect the legal characters of the line first, so that they can be
+    // written to the data set as a run rather than one at a time
+    
+    _StringBuffer letters (s.length());
+    
+    s.Each ([&] (char letter, unsigned long) -> void {
+        letter = toupper(letter);
+        if (fs->translationTable->IsCharLegal(letter)) {
+            letters << letter;
+        }
+    });
+    
+    long const letter_count = letters.length();
+    long       sitesAttached = letter_count;
+    
+    if (fs->curSpecies==0) { // add new columns
+        letters.Each ([&] (char letter, unsigned long) -> void {
+            ds.AddSite (letter);
+        });
+    } else { //append to exisiting columns
+        if (letters.Find (fs->repeat) != kNotFound) {
+            for (long i = 0L; i < letter_count; i++) {
+                if (letters.char_at (i) == fs->repeat) {
+                    if ( fs->curSite+i >= ds.lLength) { // a dot not matched by a previously read character; ignore
+                        sitesAttached = i;
+                        break;
                     }
                     
-                    if (fs->curSite+sitesAttached+1>fs->totalSitesRead) {
-                        // pad previous species to full length
-                        _Site * newS = new _Site (fs->skip);
-                        newS->AppendNCopies(fs->skip, fs->curSpecies-1L);
-                        (*newS) << letter;
-                        
-                        
-                        ds.theFrequencies << 1;
-                        newS->SetRefNo(-1);
-                        
-                        ds < newS;
-                        fs->totalSitesRead++;
-                    } else {
-                        ds.Write2Site (fs->curSite+sitesAttached, letter);
+                    char letter = ((_Site*)(ds._List::operator () (fs->curSite+i)))->get_char(0);
+                    if (letter=='\0') {
+                        letter = ((_Site*)(ds._List::operator ()
+                                      (((_Site*)(ds._List::operator () (fs->curSite+i)))->GetRefNo())))->get_char(0);
                     }
-                    
-                    sitesAttached++;
+                    letters.set_char (i, letter);
                 }
             }
-        });
-    } catch (long e) {
-        return e;
+        }
+        
+        long const existing_sites = MIN (sitesAttached, MAX (0L, fs->totalSitesRead - fs->curSite));
+        
+        ds.Write2Sites (fs->curSite, letters.get_str(), existing_sites);
+        
+        for (long i = existing_sites; i < sitesAttached; i++) {
+            // pad previous species to full length
+            _Site * newS = new _Site (fs->skip);
+            newS->AppendNCopies(fs->skip, fs->curSpecies-1L);
+            (*newS) << letters.char_at (i);
+            
+            ds.theFrequencies << 1;
+            newS->SetRefNo(-1);
+            
+            ds < newS;
+            fs->totalSitesRead++;
+        }
+        
+        if (sitesAttached < letter_count) {
+            return sitesAttached;
+        }
     }
     
     // make sure that this species has enough data in it, and if not - pad it with '?'
@@ -1853,22 +2424,25 @@ bool SkipLine (_String& theLine, FileState* fS) {
 }
 
 
+//_________________________________________________________
+inline char NextSourceChar (FileState* fs) {
+    long const position = fs->pInSrc++;
+    return position < fs->sourceLength ? fs->theSource[position] : 0;
+}
+
 //_________________________________________________________
 void ReadNextLine (FILE* fp, _String *s, FileState* fs, bool, bool upCase) {
     _StringBuffer  tempBuffer (1024L);
   
     fs->currentFileLine ++;
     
-    char lastc;
-    
-    if (fp) {
-        lastc = fgetc(fp);
-    } else {
-        lastc = fs->pInSrc<fs->theSource->length()?fs->theSource->char_at(fs->pInSrc++):0;
+    if (fs->theSource) {
+        fp = nil; // in-memory sources take precedence
     }
     
     if (fs->fileType != 3) { // not NEXUS - do not skip [..]
-        if (fp)
+        if (fp) {
+            char lastc = fgetc(fp);
             while ( !feof(fp) && lastc!=10 && lastc!=13 ) {
                 if (lastc) {
                     tempBuffer << lastc;
@@ -1876,18 +2450,43 @@ void ReadNextLine (FILE* fp, _String *s, FileState* fs, bool, bool upCase) {
                 
                 lastc = fgetc(fp);
             }
-        else
-            while (lastc && lastc!=10 && lastc!=13 ) {
-                tempBuffer << lastc;
-                lastc = fs->theSource->char_at(fs->pInSrc++);
+        } else if (fs->pInSrc < fs->sourceLength) {
+            // find the end of the line with memchr and copy the line in one go
+            const char * line = fs->theSource + fs->pInSrc,
+                       * eol  = (const char*)memchr (line, '\n', fs->sourceLength - fs->pInSrc);
+            
+            if (!eol) {
+                eol = fs->theSource + fs->sourceLength;
+            }
+            
+            const char * cr = (const char*)memchr (line, '\r', eol - line);
+            if (cr) {
+                eol = cr;
+            }
+            
+            if (memchr (line, 0, eol - line)) { // skip embedded NULs
+                for (const char * c = line; c < eol; c++) {
+                    if (*c) {
+                        tempBuffer << *c;
+                    }
+                }
+            } else {
+                tempBuffer.PushCharBuffer (line, eol - line);
             }
+            
+            fs->pInSrc = eol - fs->theSource + 1L;
+        } else {
+            fs->pInSrc ++;
+        }
         
     } else {
+        char lastc = fp ? fgetc(fp) : NextSourceChar (fs);
+
         if (upCase) {
             lastc = toupper(lastc);
         }
         
-        while (((fp&&(!feof(fp)))||(fs->theSource&&(fs->pInSrc<=fs->theSource->length ()))) && lastc!='\r' && lastc!='\n') {
+        while (((fp&&(!feof(fp)))||(fs->theSource&&(fs->pInSrc<=fs->sourceLength))) && lastc!='\r' && lastc!='\n') {
             if (lastc=='[') {
                 if (fs->isSkippingInNEXUS) {
                     ReportWarning ("Nested comments in NEXUS really shouldn't be used.");
@@ -1904,20 +2503,10 @@ void ReadNextLine (FILE* fp, _String *s, FileState* fs, bool, bool upCase) {
                 tempBuffer << lastc;
             }
             
-            if (fp) {
-                if (upCase) {
-                    lastc = toupper(fgetc(fp));
-                } else {
-                    lastc = fgetc(fp);
-                }
-            } else {
-                if (upCase) {
-                    lastc = toupper(fs->theSource->char_at(fs->pInSrc++));
-                } else {
-                    lastc = fs->theSource->char_at(fs->pInSrc++);
-                }
+            lastc = fp ? fgetc(fp) : NextSourceChar (fs);
+            if (upCase) {
+                lastc = toupper(lastc);
             }
-            
         }
         
         if ( lastc==10 || lastc==13 ) {
@@ -1927,7 +2516,7 @@ void ReadNextLine (FILE* fp, _String *s, FileState* fs, bool, bool upCase) {
     
     tempBuffer.TrimSpace();
     
-    if ( (fp && feof(fp)) || (fs->theSource && fs->pInSrc >= fs->theSource->length()) ) {
+    if ( (fp && feof(fp)) || (fs->theSource && fs->pInSrc >= fs->sourceLength) ) {
         if (tempBuffer.empty ()) {
             *s = "";
             return;
@@ -1961,13 +2550,339 @@ void    TrimPhylipLine (_String& CurrentLine, _DataSet& ds) {
 }
 
 
+//_________________________________________________________
+class _DataFileView {
+    // a read-only view of the entire contents of a data file, memory-mapped where supported,
+    // otherwise read in one block; gzip/zstd compressed files are decompressed into an
+    // unnamed temporary file which is then mapped, so that the decompressed contents are
+    // paged in (and, for streamed FASTA, released) like those of an uncompressed file
+    // (this takes as much temporary disk space as the decompressed file);
+    // without memory mapping, compressed files are decompressed in memory
+    
+public:
+    _DataFileView (FILE * file) : data (nil), length (0L), mapped (false), decompressed (nil) {
+        if (file) {
+#if defined __UNIX__ && !defined __MINGW32__
+            FILE * spill = DecompressToTemporaryFile (file);
+            if (spill) {
+                rewind (file);
+                if (!Map (spill)) { // e.g. nothing was decompressed
+                    contents = _String (spill);
+                    data   = contents.get_str();
+                    length = contents.length();
+                }
+                fclose (spill); // the mapping outlives the file handle
+                return;
+            }
+            if (Map (file)) {
+                return;
+            }
+#else
+            unsigned long decoded_length;
+            decompressed = DecompressFile (file, 0UL, decoded_length);
+            rewind (file);
+            if (decompressed) {
+                data   = decompressed->get_str();
+                length = decompressed->length();
+                return;
+            }
+#endif
+            contents = _String (file);
+            rewind (file);
+            data   = contents.get_str();
+            length = contents.length();
+        }
+    }
+    
+    ~_DataFileView (void) {
+#if defined __UNIX__ && !defined __MINGW32__
+        if (mapped) {
+            munmap ((void*)data, length);
+        }
+#endif
+        DeleteObject (decompressed);
+    }
+    
+    void Release (long from, long to) const {
+        // the pages spanned by [from, to) will not be read again
+#if defined __UNIX__ && !defined __MINGW32__
+        if (mapped) {
+            long const page = sysconf (_SC_PAGESIZE);
+            from = (from + page - 1L) / page * page;
+            to   = to / page * page;
+            if (from < to) {
+                madvise ((void*)(data + from), to - from, MADV_DONTNEED);
+            }
+        }
+#endif
+    }
+    
+    const char * data;
+    long         length;
+    
+private:
+#if defined __UNIX__ && !defined __MINGW32__
+    bool Map (FILE * file) {
+        fseek (file, 0, SEEK_END);
+        long const file_length = ftell (file);
+        rewind (file);
+        if (file_length > 0L) {
+            void * map = mmap (nil, file_length, PROT_READ, MAP_PRIVATE, fileno (file), 0);
+            if (map != MAP_FAILED) {
+                madvise (map, file_length, MADV_SEQUENTIAL);
+                data   = (const char*)map;
+                length = file_length;
+                mapped = true;
+                return true;
+            }
+        }
+        return false;
+    }
+#endif
+    
+    bool         mapped;
+    _String      contents;
+    _StringBuffer * decompressed;
+};
+
+//_________________________________________________________
+
+bool    StreamFastaColumns (FileState& fState, _DataSet& result, _DataFileView const& file) {
+    // read a FASTA file one block of columns at a time:
+    // every block is transposed, its columns are hashed and merged into the
+    // set of unique patterns, and then the block (and the file pages it came from)
+    // is discarded, so that the complete alignment is never held in memory
+    
+    // returns false (leaving 'result' untouched) if streaming is not enabled
+    // for this source, or if the source has anything that needs the line-by-line reader
+    // (commands, trees, comments, repeat characters, names without data)
+    
+    const unsigned long kBlockBytes = 0x2000000UL,
+                        kTileColumns = 64UL;
+    
+    hyFloat const threshold = hy_env::EnvVariableGetNumber (hy_env::data_file_streaming_threshold, 0.);
+    
+    if (!file.data || threshold <= 0. || file.length < threshold) {
+        return false;
+    }
+    
+    const char * source        = file.data;
+    long const   source_length = file.length;
+    
+    // pass 1: locate the data of every record
+    
+    _SimpleList   data_starts, data_ends;
+    _List         headers;
+    bool          has_data = false;
+    long          released = 0L;
+    
+    for (long position = 0L; position < source_length; ) {
+        if (position - released >= (long)kBlockBytes) {
+            file.Release (released, position);
+            released = position;
+        }
+        
+        const char * line = source + position,
+                   * eol  = (const char*)memchr (line, '\n', source_length - position);
+        
+        if (!eol) {
+            eol = source + source_length;
+        }
+        
+        const char * line_end = (const char*)memchr (line, '\r', eol - line);
+        if (line_end) {
+            if (line_end + 1 != eol) { // a bare carriage return
+                return false;
+            }
+        } else {
+            line_end = eol;
+        }
+        
+        const char * first = line;
+        while (first < line_end && isspace (*first)) {
+            first ++;
+        }
+        
+        if (first < line_end) {
+            switch (*first) {
+                case '>':
+                case '#': {
+                    if (data_starts.nonempty()) {
+                        if (!has_data) {
+                            return false;
+                        }
+                        data_ends << line - source;
+                    }
+                    _StringBuffer header (line_end - line);
+                    for (const char * c = line; c < line_end; c++) {
+                        if (*c) {
+                            header << *c;
+                        }
+                    }
+                    headers < new _String (header);
+                    data_starts << eol - source + 1L;
+                    has_data = false;
+                    break;
+                }
+                case '$':
+                case '/':
+                case '(':
+                    return false;
+                default:
+                    if (data_starts.empty() || memchr (first, fState.repeat, line_end - first)) {
+                        return false;
+                    }
+                    has_data = true;
+            }
+        }
+        
+        position = eol - source + 1L;
+    }
+    
+    if (!has_data) {
+        return false;
+    }
+    
+    data_ends << source_length;
+    
+    // from here on the source is committed to streaming
+    
+    headers.ForEach ([&] (BaseRef header, unsigned long) -> void {
+        // name processing mirrors that of ReadDataSetFile
+        _String name (*(_String*)header);
+        fState.totalSpeciesExpected++;
+        name.Trim (name.FirstNonSpaceIndex(1), kStringEnd);
+        if (name.char_at(0) == '#' || name.char_at(0) == '>') {
+            name = _String ("Species") & _String(fState.totalSpeciesExpected);
+        }
+        result.AddName (name);
+    });
+    
+    if (!fState.skip) {
+        fState.skip = fState.translationTable->GetSkipChar();
+    }
+    
+    char letter_map [256];
+    for (int c = 0; c < 256; c++) {
+        char const letter = toupper (c);
+        letter_map[c] = c && fState.translationTable->IsCharLegal (letter) ? letter : 0;
+    }
+    
+    unsigned long const sequences   = headers.lLength,
+                        block_width = MAX (kTileColumns, MIN (0x100000UL, kBlockBytes / sequences) / kTileColumns * kTileColumns);
+    
+    char * rows    = (char*)MemAllocate (sequences * block_width),
+         * columns = (char*)MemAllocate (sequences * block_width);
+    
+    _SimpleList       cursors (data_starts),
+                      row_lengths,
+                      hashes;
+    
+    row_lengths.Populate (sequences, 0L, 0L);
+    hashes.Populate      (block_width, 0L, 0L);
+    
+    _PatternHashTable patterns;
+    
+#ifdef _OPENMP
+    long const nt = MIN(omp_get_max_threads(), (long)(sequences / 16UL) + 1L);
+#endif
+    
+    while (true) {
+        
+        // copy the next block_width characters of every sequence
+        
+#ifdef _OPENMP
+#pragma omp parallel for default(shared) schedule(static) if (nt > 1) num_threads(nt)
+#endif
+        for (unsigned long s = 0UL; s < sequences; s++) {
+            const char * read_from = source + cursors.list_data[s],
+                       * read_to   = source + data_ends.list_data[s];
+            char       * write_to  = rows + s * block_width;
+            unsigned long filled   = 0UL;
+            
+            while (filled < block_width && read_from < read_to) {
+                char const letter = letter_map[(unsigned char)*(read_from++)];
+                if (letter) {
+                    write_to[filled++] = letter;
+                }
+            }
+            
+            file.Release (cursors.list_data[s], read_from - source);
+            cursors.list_data[s]     = read_from - source;
+            row_lengths.list_data[s] = filled;
+        }
+        
+        unsigned long const width = row_lengths.Max();
+        
+        if (width == 0UL) {
+            break;
+        }
+        
+        // pad short sequences, transpose the block tile by tile, and hash the columns
+        
+        for (unsigned long s = 0UL; s < sequences; s++) {
+            if ((unsigned long)row_lengths.list_data[s] < width) {
+                memset (rows + s * block_width + row_lengths.list_data[s], fState.skip, width - row_lengths.list_data[s]);
+            }
+        }
+        
+#ifdef _OPENMP
+#pragma omp parallel for default(shared) schedule(static) if (nt > 1) num_threads(nt)
+#endif
+        for (unsigned long tile = 0UL; tile < width; tile += kTileColumns) {
+            unsigned long const tile_end = MIN (tile + kTileColumns, width);
+            for (unsigned long s = 0UL; s < sequences; s++) {
+                const char * row = rows + s * block_width;
+                for (unsigned long c = tile; c < tile_end; c++) {
+                    columns[c * sequences + s] = row[c];
+                }
+            }
+            for (unsigned long c = tile; c < tile_end; c++) {
+                hashes.list_data[c] = HashCharacterBuffer (columns + c * sequences, sequences);
+            }
+        }
+        
+        // merge the columns into the set of unique patterns
+        
+        for (unsigned long c = 0UL; c < width; c++) {
+            const char * column = columns + c * sequences;
+            long pattern = patterns.FindOrInsert (hashes.list_data[c], result.lLength, [&] (long other) -> bool {
+                return memcmp (column, ((_Site const*)result.list_data[other])->get_str(), sequences) == 0;
+            });
+            
+            if (pattern < 0L) {
+                _Site * unique_pattern = new _Site;
+                unique_pattern->PushCharBuffer (column, sequences);
+                unique_pattern->TrimSpace();
+                result.theMap << result.lLength;
+                result.theFrequencies << 1L;
+                result < unique_pattern;
+            } else {
+                result.theMap << pattern;
+                result.theFrequencies.list_data[pattern]++;
+            }
+        }
+    }
+    
+    free (rows);
+    free (columns);
+    
+    fState.totalSpeciesRead = sequences;
+    fState.totalSitesRead   = result.theMap.lLength;
+    
+    return true;
+}
+
 //_________________________________________________________
 _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName, _String* namespaceID, _TranslationTable* dT, _ExecutionList* ex) {
+    _hyProfilerPhase profiler_phase (kProfilerPhaseIO);
+    
     
     static const _String kNEXUS ("#NEXUS"),
                          kDefSeqNamePrefix ("Species");
     
-    bool     doAlphaConsistencyCheck = true;
+    bool     doAlphaConsistencyCheck = true,
+             streamed                = false;
     _DataSet* result = new _DataSet;
     
     try {
@@ -2004,33 +2919,32 @@ _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName,
         fState.baseLength        = 4;
         fState.repeat            = '.',
         fState.skip            = 0;
-        fState.theSource         = theS;
         fState.pInSrc            = 0;
         fState.theNamespace      = namespaceID;
         
         if (!(f||theS)) {
             throw _String ("ReadDataSetFile received null file AND string references. At least one must be specified");
         }
-        // done initializing
         
-        long     fileLength = 0;
+        // files are parsed from memory, just like strings
         
-    #ifdef __HYPHYMPI__
-        if (hy_mpi_node_rank == 0L) {
-    #endif
-            if       (f) {
-                fseek    (f,0,SEEK_END);
-                fileLength = ftell(f);
-                rewind  (f);
-            } else {
-                fileLength = theS->length();
-            }
-            
-    #ifdef __HYPHYMPI__
-        }
-    #endif
+        _DataFileView file_contents (f);
         
+        if (f) {
+            fState.theSource     = file_contents.data;
+            fState.sourceLength  = file_contents.length;
+        } else {
+            fState.theSource     = theS->get_str();
+            fState.sourceLength  = theS->length();
+        }
+        // done initializing
         
+        // binary snapshots (see _DataSet::Snapshot) are restored as is
+        _DataSet * snapshot = _DataSet::FromSnapshot (fState.theSource, fState.sourceLength);
+        if (snapshot) {
+            DeleteObject (result);
+            return snapshot;
+        }
         
         //if (f==NULL) return (_DataSet*)result.makeDynamic();
         // nothing to do
@@ -2044,6 +2958,9 @@ _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName,
             if (CurrentLine.BeginsWith (kNEXUS,false)) {
                 ReadNexusFile (fState,f,(*result));
                 doAlphaConsistencyCheck = false;
+            } else if (StreamFastaColumns (fState, *result, file_contents)) {
+                // already compressed to unique site patterns
+                streamed = true;
             } else {
                 long i,j,k, filePosition = -1, saveSpecExpected = 0x7FFFFFFF;
                 char c;
@@ -2078,12 +2995,7 @@ _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName,
                         //   we must read those in first
                         if (fState.fileType==1) { // PHYLIP
                             if ((filePosition<0)&&(fState.autoDetect)) {
-                                filePosition = (f?
-                                                ftell (f)
-    #ifdef __WINDOZE__
-                                                -1
-    #endif
-                                                :fState.pInSrc);
+                                filePosition = fState.pInSrc;
                                 savedLine = CurrentLine;
                             }
                             
@@ -2135,11 +3047,7 @@ _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName,
                                         fState.interleaved = true;
                                         fState.autoDetect = true;
                                         
-                                        if(f) {
-                                            fseek (f, filePosition, SEEK_SET);
-                                        } else {
-                                            fState.pInSrc = filePosition;
-                                        }
+                                        fState.pInSrc = filePosition;
                                         
                                         CurrentLine = savedLine;
                                         result->ForEach ([] (BaseRef site, unsigned long) -> void {
@@ -2251,22 +3159,22 @@ _DataSet* ReadDataSetFile (FILE*f, char execBF, _String* theS, _String* bfName,
         
         
         
-        if (fState.totalSitesRead && fState.interleaved && !result->InternalStorageMode()) {
-            for (long i = fState.curSite; i<fState.totalSitesRead; i++) {
-                result->Compact(i);
+        if (!streamed) {
+            if (fState.totalSitesRead && fState.interleaved && !result->InternalStorageMode()) {
+                for (long i = fState.curSite; i<fState.totalSitesRead; i++) {
+                    result->Compact(i);
+                }
+                result->ResetIHelper();
             }
-            result->ResetIHelper();
-        }
-        
-        if ((!fState.interleaved)&&(fState.fileType!=2)) {
-            PadLine (fState, (*result));
+            
+            if ((!fState.interleaved)&&(fState.fileType!=2)) {
+                PadLine (fState, (*result));
+            }
+            
+            // make sure interleaved duplications are handled correctly
+            
+            result->Finalize();
         }
-        
-        
-        
-        // make sure interleaved duplications are handled correctly
-        
-        result->Finalize();
         result->noOfSpecies       = fState.totalSpeciesRead;
         result->theTT             = fState.translationTable;
         
@@ -38,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <ctype.h>
+#include <limits.h>
 
 #include "global_object_lists.h"
 #include "avllistxl_iterator.h"
@@ -51,14 +52,35 @@ _DataSetFilter::_DataSetFilter(void) {
   unitLength = 0;
   theData = NULL;
   accessCache = nil;
+  stateCache = nil;
 }
 //_________________________________________________________
 _DataSetFilter::_DataSetFilter(_DataSet *ds, char, _String &) {
   theData = ds;
   accessCache = nil;
+  stateCache = nil;
 }
 //_________________________________________________________
-_DataSetFilter::~_DataSetFilter(void) { DeleteObject(accessCache); }
+_DataSetFilter::~_DataSetFilter(void) {
+  DeleteObject(accessCache);
+  DeleteObject(stateCache);
+}
+
+//_______________________________________________________________________
+
+_DataSetStateCache *_DataSetFilter::GetStateCache(void) const {
+  if (!stateCache) {
+    stateCache = theData->GetStateCache(unitLength, theExclusions);
+  }
+  return stateCache;
+}
+
+//_______________________________________________________________________
+
+void _DataSetFilter::ReleaseStateCache(void) {
+  DeleteObject(stateCache);
+  stateCache = nil;
+}
 
 //_______________________________________________________________________
 
@@ -68,13 +90,17 @@ void _DataSetFilter::CopyFilter (_DataSetFilter const *copyFrom) {
     theNodeMap.Duplicate            (&copyFrom->theNodeMap);
     theMap.Duplicate                (&copyFrom->theMap);
     theOriginalOrder.Duplicate      (&copyFrom->theOriginalOrder);
-    conversionCache.Duplicate       (&copyFrom->conversionCache);
     duplicateMap.Duplicate          (&copyFrom->duplicateMap);
     
     dimension               = copyFrom->dimension;
     undimension             = copyFrom->undimension;
     unitLength              = copyFrom->unitLength;
     accessCache             = nil;
+
+    ReleaseStateCache();
+    if ((stateCache = copyFrom->stateCache)) {
+        stateCache->AddAReference();
+    }
     
 }
 
@@ -95,6 +121,7 @@ void _DataSetFilter::Duplicate(BaseRefConst source)  {
 
 //_______________________________________________________________________
 void    _DataSetFilter::SetDimensions (void) {
+    ReleaseStateCache();
     dimension   = GetDimension(true);
     undimension = GetDimension(false);
 }
@@ -340,8 +367,8 @@ void    _DataSetFilter::SetFilter (_DataSet const * ds, unsigned char unit, _Sim
     theOriginalOrder.Clear();
     theFrequencies.Clear();
     theExclusions.Clear();
-    conversionCache.Clear();
     duplicateMap.Clear();
+    ReleaseStateCache();
     
     theData     = (_DataSet*)ds;
     unitLength  = unit;
@@ -424,82 +451,79 @@ void    _DataSetFilter::SetFilter (_DataSet const * ds, unsigned char unit, _Sim
     
     // done with security checks
     
-    _SimpleList indices;        // numeric indices intended to facilitate the reindexing
-    _AVLListXL  siteIndices     (&indices);
+    // identical blocks are found by hashing the (filtered) characters of every
+    // block in parallel, and confirming hash matches by comparing the blocks
+
+    long const      block_count  = verticalList.lLength / unit,
+                    block_size   = unit*theNodeMap.lLength;
+    
+    _Site   const ** ds_sites   = (_Site const**)ds->list_data;
+    long    const *  ds_map     = ds->theMap.list_data;
+    long    const *  sites      = verticalList.list_data;
+    long    const *  rows       = theNodeMap.list_data;
     
+    _SimpleList  hashes;
+    hashes.Populate (block_count, 0L, 0L);
     
-    // sweep through the columns left to right
+#ifdef _OPENMP
+    long const nt = MIN(omp_get_max_threads(), block_count / 1024L + 1L);
+#pragma omp parallel if (nt > 1) num_threads(nt)
+#endif
+    {
+        char * site_holder = (char*)MemAllocate (block_size + 1L);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (long b = 0L; b < block_count; b++) {
+            char * write_to = site_holder;
+            for (long j = 0L; j < unit; j++) { // sweep within one block
+                const char * column = ds_sites[ds_map[sites[b*unit+j]]]->get_str();
+                for (long k = 0L; k < theNodeMap.lLength; k++) { // sweep down the columns
+                    *(write_to++) = column[rows[k]];
+                }
+            }
+            hashes.list_data[b] = HashCharacterBuffer (site_holder, block_size);
+        }
+        free (site_holder);
+    }
     
-    duplicateMap.RequestSpace (verticalList.lLength/unit+1);
+    // sweep through the blocks left to right
     
-    _String      siteHolder   (unit*theNodeMap.lLength);
+    duplicateMap.RequestSpace (block_count+1);
     
-    //bool       startD = false;
+    _PatternHashTable   patterns;
     
-    for (i=0; i<verticalList.lLength; i+=unit) {
-        long colIndex = 0;
-        
-        for (j=0; j<unit; j++) // sweep within one block
-            for (long k=0; k<theNodeMap.lLength; k++) // sweep down the columns
-                                                      //colIndex+=
-                                                      //(((_String**)ds->list_data)[ds->theMap.list_data[verticalList.list_data[i+j]]])->sData[theNodeMap.list_data[k]];
-            {
-                siteHolder[colIndex++] = (((_String**)ds->list_data)[ds->theMap.list_data[verticalList.list_data[i+j]]])->char_at(theNodeMap.list_data[k]);
-            }
-        
-        colIndex = siteHolder.Adler32();
-        /*StringToConsole(siteHolder);
-        BufferToConsole("=");
-        StringToConsole(_String (colIndex));
-        NLToConsole();*/
-        
-        long        f = siteIndices.FindLong(colIndex);
-        _SimpleList * sameScore = nil;
-        
-        if (f>=0) {
-            sameScore = (_SimpleList*)siteIndices.GetXtra (f);
-            for (long k = 0; k<sameScore->lLength; k++) {
-                bool fit = true;
-                f = sameScore->list_data[k];
-                for (long j=0; fit&&(j<unit); j++) { // sweep within one block
-                    _Site * site1 = ds->GetSite(verticalList.list_data[i+j]),
-                    * site2 = ds->GetSite(theMap.list_data[unit*f+j]);
-                    
-                    for (long k=0L; k<theNodeMap.lLength; k++) { // sweep down the columns
-                        long mapped_index = theNodeMap.list_data[k];
-                        if (site1->char_at (mapped_index) != site2->char_at (mapped_index)) {
-                            fit = false;
-                            break;
+    for (long b = 0L; b < block_count; b++) {
+        long f = patterns.FindOrInsert (hashes.list_data[b], b, [&] (long other) -> bool {
+            for (long j = 0L; j < unit; j++) {
+                long const p1 = ds_map[sites[b*unit+j]],
+                           p2 = ds_map[sites[other*unit+j]];
+                if (p1 != p2) { // same dataset pattern => same characters
+                    const char * site1 = ds_sites[p1]->get_str(),
+                               * site2 = ds_sites[p2]->get_str();
+                    for (long k = 0L; k < theNodeMap.lLength; k++) {
+                        if (site1[rows[k]] != site2[rows[k]]) {
+                            return false;
                         }
                     }
                 }
-                
-                if (fit) {
-                    theFrequencies[f]++;
-                    duplicateMap<<f;
-                    f = 0;
-                    break;
-                } else {
-                    f = -1;
-                }
             }
-        }
-        if (f==-1) { // fit failed or unique site
-            if (!sameScore) {
-                sameScore = new _SimpleList;
-                siteIndices.Insert ((BaseRef)colIndex,(long)sameScore,false);
-            }
-            
-            (*sameScore) << theFrequencies.lLength;
+            return true;
+        });
+        
+        if (f >= 0L) {
+            f = duplicateMap.list_data[f];
+            theFrequencies.list_data[f]++;
+            duplicateMap<<f;
+        } else { // unique block
             duplicateMap<<theFrequencies.lLength;
             theFrequencies<<1;
-            for (j=0; j<unit; j++) {
-                theMap<<verticalList.list_data[i+j];
+            for (long j=0L; j<unit; j++) {
+                theMap<<sites[b*unit+j];
             }
         }
     }
     
-    siteIndices.Clear();
     
     duplicateMap.TrimMemory();
     theOriginalOrder.TrimMemory();
@@ -743,6 +767,7 @@ void    _DataSetFilter::MatchStartNEnd (_SimpleList& order, _SimpleList& positio
 void    _DataSetFilter::SetExclusions (_String const& exclusion_string, bool filter) {
   
     theExclusions.Clear();
+    ReleaseStateCache();
     _String character_list = exclusion_string;
     character_list.StripQuotes();
     if (character_list.empty()) {
@@ -1070,10 +1095,12 @@ _Matrix* _DataSetFilter::ComputePairwiseDifferences (long i, long j, _hy_dataset
                      state2 ((unsigned long)unitLength);
         
         
-        if (conversionCache.lLength == 0) {
+        if (!stateCache || stateCache->conversion.lLength == 0) {
             throw _String ("ComputePairwiseDifferences called on a filter with emptyString conversionCache");
         }
         
+        _SimpleList const & conversionCache = stateCache->conversion;
+        
         long        *tcodes  = conversionCache.list_data+89,
         *ccodes  = conversionCache.list_data+1,
         ccount   = conversionCache.list_data[0];
@@ -1408,6 +1435,251 @@ _Matrix* _DataSetFilter::ComputePairwiseDifferences (long i, long j, _hy_dataset
 
 //_________________________________________________________
 
+_Matrix* _DataSetFilter::ComputePairwiseDistances (_hy_pairwise_distance_model model, _hy_dataset_filter_ambiguity_resolution resolution_option, hyFloat const * frequencies) const {
+    // all pairwise distances for a nucleotide filter; sequence pair counts are
+    // the same as those of ComputePairwiseDifferences (long, long, ...)
+  
+    // every sequence is stored as bit planes (one bit per site): A, C, G, T for
+    // unambiguous characters, and, when ambiguities are resolved, F for fully ambiguous
+    // characters (N, gaps), A, C, G, T membership for partial ambiguities (R, Y, ...),
+    // and a plane marking three-way partial ambiguities (B, D, H, V).
+    // pairs of sequences are then compared a word of sites at a time with popcounts,
+    // and square blocks of pairs are distributed over threads
+  
+    static const unsigned long kFullPlane    = 4UL,
+                               kPartialPlane = 5UL,
+                               kTripletPlane = 9UL,
+                               kBitsPerWord  = sizeof (unsigned long) * 8UL,
+                               kTileSize     = 32UL;
+  
+    if (unitLength != 1 || GetDimension (true) != 4 || GetDimension (false) != 4) {
+        throw _String ("Pairwise distances can only be computed for nucleotide filters without exclusions");
+    }
+  
+    unsigned long const sequences = NumberSpecies (),
+                        sites     = GetSiteCount ();
+  
+    _Matrix * distances = new _Matrix (sequences, sequences, false, true);
+  
+    // TN93 (or K2P if some of the nucleotides are absent) constants, as in libv3 distances.bf
+    hyFloat fR = 0., fY = 0., K1 = 0., K2 = 0., K3 = 0.;
+    bool    k2p = true;
+  
+    if (model == kPairwiseDistanceTN93) {
+        if (!frequencies) {
+            DeleteObject (distances);
+            throw _String ("TN93 distances require nucleotide frequencies");
+        }
+        fY = frequencies[1] + frequencies[3];
+        fR = 1. - fY;
+        k2p = MIN (MIN (frequencies[0], frequencies[1]), MIN (frequencies[2], frequencies[3])) == 0.;
+        if (!k2p) {
+            K1 = 2.*frequencies[0]*frequencies[2]/fR;
+            K2 = 2.*frequencies[1]*frequencies[3]/fY;
+            K3 = 2.*(fR*fY-frequencies[0]*frequencies[2]*fY/fR-frequencies[1]*frequencies[3]*fR/fY);
+        }
+    }
+  
+    auto store_distance = [&] (unsigned long i, unsigned long j, hyFloat total, hyFloat matches, hyFloat ag, hyFloat ct) -> void {
+        hyFloat d;
+        if (model == kPairwiseDistanceP) {
+            d = (total - matches) / total;
+        } else {
+            d = 1000.;
+            if (total > 0.) {
+                hyFloat const AG = ag / total,
+                              CT = ct / total,
+                              transversions = 1. - AG - CT - matches / total;
+              
+                if (k2p) {
+                    hyFloat const d1 = 1.-2.*(AG+CT)-transversions,
+                                  d2 = 1.-2.*transversions;
+                    if (d1 > 0. && d2 > 0.) {
+                        d = -(0.5*log(d1)+.25*log(d2));
+                    }
+                } else {
+                    hyFloat const d1 = 1.-AG/K1-0.5*transversions/fR,
+                                  d2 = 1.-CT/K2-0.5*transversions/fY,
+                                  d3 = 1.-0.5*transversions/fR/fY;
+                    if (d1 > 0. && d2 > 0. && d3 > 0.) {
+                        d = -K1*log(d1)-K2*log(d2)-K3*log(d3);
+                    }
+                }
+            }
+        }
+        distances->theData[i*sequences+j] = distances->theData[j*sequences+i] = d;
+    };
+  
+    if (resolution_option == kAmbiguityHandlingResolveFrequencyAware || resolution_option == kAmbiguityHandlingAverageFrequencyAware) {
+        // ambiguities are resolved using the character frequencies at each site;
+        // these are tallied pair by pair
+        for (unsigned long i = 0UL; i < sequences; i++) {
+            for (unsigned long j = i + 1UL; j < sequences; j++) {
+                _Matrix * counts = ComputePairwiseDifferences (i, j, resolution_option);
+                if (counts->GetHDim() == 4L) {
+                    hyFloat const * c = counts->theData;
+                    hyFloat total = 0.;
+                    for (unsigned long k = 0UL; k < 16UL; k++) {
+                        total += c[k];
+                    }
+                    store_distance (i, j, total, c[0] + c[5] + c[10] + c[15], c[2] + c[8], c[7] + c[13]);
+                }
+                DeleteObject (counts);
+            }
+        }
+        return distances;
+    }
+  
+    bool const resolve_ambiguities = resolution_option == kAmbiguityHandlingResolve;
+  
+    unsigned long const planes_per_word = resolve_ambiguities ? 10UL : 4UL,
+                        words           = (sites + kBitsPerWord - 1UL) / kBitsPerWord,
+                        row_length      = words * planes_per_word;
+  
+    unsigned long * planes = (unsigned long*)MemAllocate (sequences * row_length * sizeof (unsigned long), true);
+  
+    {
+        // the nucleotides every character resolves to, and whether it resolves to exactly one of them
+        unsigned char character_masks [256];
+        bool          character_resolved [256];
+        hyFloat       resolutions [4];
+      
+        for (unsigned long c = 0UL; c < 256UL; c++) {
+            character_resolved [c] = Translate2Frequencies ((char)c, resolutions, false) == 1L;
+            character_masks [c] = 0;
+            for (unsigned long n = 0UL; n < 4UL; n++) {
+                if (resolutions[n] > 0.) {
+                    character_masks [c] |= 1 << n;
+                }
+            }
+        }
+      
+        for (unsigned long k = 0UL; k < sequences; k++) {
+            _String * sequence = GetSequenceCharacters (k);
+            unsigned long * sequence_planes = planes + k * row_length;
+          
+            for (unsigned long site = 0UL; site < sites; site++) {
+                unsigned char const c    = sequence->get_uchar (site),
+                                    mask = character_masks [c];
+                unsigned long const bit  = 1UL << (site % kBitsPerWord);
+                unsigned long     * word = sequence_planes + (site / kBitsPerWord) * planes_per_word;
+              
+                if (character_resolved [c]) {
+                    word [mask == 1 ? 0 : mask == 2 ? 1 : mask == 4 ? 2 : 3] |= bit;
+                } else if (resolve_ambiguities) {
+                    if (mask == 15) {
+                        word [kFullPlane] |= bit;
+                    } else if (mask) {
+                        long members = 0L;
+                        for (unsigned long n = 0UL; n < 4UL; n++) {
+                            if (mask & (1 << n)) {
+                                word [kPartialPlane + n] |= bit;
+                                members ++;
+                            }
+                        }
+                        if (members == 3L) {
+                            word [kTripletPlane] |= bit;
+                        }
+                    }
+                }
+            }
+            DeleteObject (sequence);
+        }
+    }
+  
+    unsigned long const tiles = (sequences + kTileSize - 1UL) / kTileSize;
+  
+#ifdef _OPENMP
+    long const nt = MIN (omp_get_max_threads(), (long)tiles);
+#pragma omp parallel for default(shared) schedule(dynamic) if (nt > 1) num_threads(nt)
+#endif
+    for (unsigned long tile_i = 0UL; tile_i < tiles; tile_i++) {
+        for (unsigned long tile_j = tile_i; tile_j < tiles; tile_j++) {
+            unsigned long const last_i = MIN (sequences, (tile_i + 1UL) * kTileSize),
+                                last_j = MIN (sequences, (tile_j + 1UL) * kTileSize);
+          
+            for (unsigned long i = tile_i * kTileSize; i < last_i; i++) {
+                unsigned long const * planes_i = planes + i * row_length;
+              
+                for (unsigned long j = MAX (i + 1UL, tile_j * kTileSize); j < last_j; j++) {
+                    unsigned long const * planes_j = planes + j * row_length;
+                  
+                    // site counts; ambiguous sites contribute fractional transitions
+                    // (halves, thirds and quarters), which are counted separately
+                    unsigned long compared = 0UL, matched = 0UL, ag = 0UL, ct = 0UL,
+                                  ag_halves = 0UL, ag_thirds = 0UL, ct_halves = 0UL, ct_thirds = 0UL, quarters = 0UL;
+                  
+                    for (unsigned long w = 0UL; w < row_length; w += planes_per_word) {
+                        unsigned long const * p1 = planes_i + w,
+                                            * p2 = planes_j + w;
+                      
+                        unsigned long const r1 = p1[0] | p1[1] | p1[2] | p1[3],
+                                            r2 = p2[0] | p2[1] | p2[2] | p2[3];
+                      
+                        compared += __builtin_popcountl (r1 & r2);
+                        matched  += __builtin_popcountl ((p1[0] & p2[0]) | (p1[1] & p2[1]) | (p1[2] & p2[2]) | (p1[3] & p2[3]));
+                        ag       += __builtin_popcountl ((p1[0] & p2[2]) | (p1[2] & p2[0]));
+                        ct       += __builtin_popcountl ((p1[1] & p2[3]) | (p1[3] & p2[1]));
+                      
+                        if (resolve_ambiguities) {
+                            unsigned long const * m1 = p1 + kPartialPlane,
+                                                * m2 = p2 + kPartialPlane;
+                          
+                            // an unambiguous nucleotide matches N or a gap
+                            unsigned long const full_matches = (r1 & p2[kFullPlane]) | (p1[kFullPlane] & r2);
+                            compared += __builtin_popcountl (full_matches);
+                            matched  += __builtin_popcountl (full_matches);
+                          
+                            // an unambiguous nucleotide paired with a partial ambiguity
+                            // matches it if it is one of its resolutions, and otherwise is
+                            // paired with each of the resolutions in equal parts
+                            unsigned long const partial1 = m1[0] | m1[1] | m1[2] | m1[3],
+                                                partial2 = m2[0] | m2[1] | m2[2] | m2[3];
+                          
+                            unsigned long const ambiguous = (r1 & partial2) | (partial1 & r2);
+                          
+                            if (ambiguous) {
+                                unsigned long const contained = (p1[0] & m2[0]) | (p1[1] & m2[1]) | (p1[2] & m2[2]) | (p1[3] & m2[3]) |
+                                                                (m1[0] & p2[0]) | (m1[1] & p2[1]) | (m1[2] & p2[2]) | (m1[3] & p2[3]),
+                                                    triplets  = p1[kTripletPlane] | p2[kTripletPlane],
+                                                    ag_pairs  = ((p1[0] & m2[2]) | (p1[2] & m2[0]) | (m1[0] & p2[2]) | (m1[2] & p2[0])) & ~contained,
+                                                    ct_pairs  = ((p1[1] & m2[3]) | (p1[3] & m2[1]) | (m1[1] & p2[3]) | (m1[3] & p2[1])) & ~contained;
+                              
+                                compared  += __builtin_popcountl (ambiguous);
+                                matched   += __builtin_popcountl (contained);
+                                ag_halves += __builtin_popcountl (ag_pairs & ~triplets);
+                                ag_thirds += __builtin_popcountl (ag_pairs & triplets);
+                                ct_halves += __builtin_popcountl (ct_pairs & ~triplets);
+                                ct_thirds += __builtin_popcountl (ct_pairs & triplets);
+                            }
+                          
+                            // two partial ambiguities are only counted if they do not overlap,
+                            // i.e. both are two-way and complementary; every one of the four
+                            // resulting pairs contributes a quarter; AC/GT and AT/CG include
+                            // one A<->G and one C<->T pair, while AG/CT has neither
+                            unsigned long const disjoint = partial1 & partial2 &
+                                                           ~((m1[0] & m2[0]) | (m1[1] & m2[1]) | (m1[2] & m2[2]) | (m1[3] & m2[3]));
+                            if (disjoint) {
+                                compared += __builtin_popcountl (disjoint);
+                                quarters += __builtin_popcountl (disjoint & ~((m1[0] & m1[2]) | (m2[0] & m2[2])));
+                            }
+                        }
+                    }
+                  
+                    store_distance (i, j, compared, matched,
+                                    ag + ag_halves * 0.5 + ag_thirds / 3. + quarters * 0.25,
+                                    ct + ct_halves * 0.5 + ct_thirds / 3. + quarters * 0.25);
+                }
+            }
+        }
+    }
+  
+    free (planes);
+    return distances;
+}
+
+//_________________________________________________________
+
 void _DataSetFilter::ComputePairwiseDifferences (_Matrix& target, long i, long j) const
 // matrix of dimension nx4n containing pairwise distances as follows (n=number of species)
 // first lower diag - count the same (AA,CC,GG,TT)
@@ -1685,6 +1957,8 @@ long    _DataSetFilter::Translate2Frequencies (char s, hyFloat* parvect, bool sm
 //_______________________________________________________________________
 long    _DataSetFilter::LookupConversion (char s, hyFloat* parvect) const
 {
+    _SimpleList const & conversionCache = stateCache->conversion;
+    
     if (undimension==4) {
         long* cCache = conversionCache.list_data+(s-40)*5;
         parvect[0] = cCache[0];
@@ -1701,11 +1975,13 @@ long    _DataSetFilter::LookupConversion (char s, hyFloat* parvect) const
 }
 //_______________________________________________________________________
 bool   _DataSetFilter::ConfirmConversionCache() const {
-    return conversionCache.lLength || unitLength > 3;
+    return (stateCache && stateCache->conversion.lLength) || unitLength > 3;
 }
 
 //_______________________________________________________________________
 void    _DataSetFilter::SetupConversion (void) {
+    _SimpleList & conversionCache = GetStateCache()->conversion;
+    
     if (conversionCache.countitems()) {
         return;
     }
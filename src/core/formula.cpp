@@ -2028,6 +2028,13 @@ HBLObjectRef _Formula::Compute (long startAt, _VariableContainer const * nameSpa
     return valid_type == HY_ANY_OBJECT ? return_value : ((return_value->ObjectClass() & valid_type) ? return_value : nil);
 }
 
+//__________________________________________________________________________________
+void _Formula::ReleaseResult (void) {
+    if (call_count == 0UL) {
+        theStack.Reset();
+    }
+}
+
 //__________________________________________________________________________________
 bool _Formula::CheckSimpleTerm (HBLObjectRef thisObj) {
     if (thisObj) {
@@ -2144,12 +2151,50 @@ long _Formula::StackDepth (long from, long to) const {
 
 
 //__________________________________________________________________________________
-bool _Formula::AmISimple (long& stack_depth, _AVLList& variable_index) {
+bool _Formula::IsSimpleDictionaryKey (unsigned long i) {
+    // a string constant immediately followed by a two-term [] operation on a variable
+    // which holds a dictionary (or a number, e.g. a function argument which has not been
+    // given a value at compile time), i.e. dict["key"]
+    if (i == 0UL || i + 1UL >= theFormula.countitems()) {
+        return false;
+    }
+  
+    _Operation * key       = ItemAt (i),
+               * container = ItemAt (i-1UL),
+               * access    = ItemAt (i+1UL);
+  
+    if (key->theNumber->ObjectClass() != STRING || key->numberOfTerms != 0L) {
+        return false;
+    }
+  
+    if (access->theNumber || access->theData != -1L || access->numberOfTerms != 2L ||
+        (access->opCode != HY_OP_CODE_MACCESS && access->opCode != HY_OP_CODE_MCOORD)) {
+        return false;
+    }
+  
+    if (container->theNumber || container->theData == -1L || container->GetAVariable() < 0L) {
+        return false;
+    }
+  
+    unsigned long const container_class = LocateVar (container->GetAVariable())->ObjectClass();
+    return container_class == ASSOCIATIVE_LIST || container_class == NUMBER;
+}
+
+//__________________________________________________________________________________
+bool _Formula::AmISimple (long& stack_depth, _AVLList& variable_index, bool allow_extended, _AVLList* container_index) {
     if (theFormula.empty()) {
         return true;
     }
 
     long loc_depth = 0L;
+  
+    _SimpleList operands,     // which operation placed each value currently on the stack
+                dictionaries; // dictionary valued operands; these must all be indexed
+  
+    auto variable_operand = [this] (long op_index) -> long {
+        _Operation * op = ItemAt (op_index);
+        return (op->theNumber || op->theData == -1L) ? -1L : op->GetAVariable();
+    };
 
     for (unsigned long i=0UL; i<theFormula.countitems(); i++) {
         _Operation* this_op =ItemAt (i);
@@ -2157,22 +2202,42 @@ bool _Formula::AmISimple (long& stack_depth, _AVLList& variable_index) {
         if ( this_op->theData<-2 || this_op->numberOfTerms<0) {
             if (this_op->theData < -2 && i == 0UL) {
               variable_index.InsertNumber (this_op->GetAVariable());
+              operands << i;
               continue;
             }
-            return false;
-        }
-
-        if (this_op->theNumber) {
-            if (this_op->theNumber->ObjectClass() != NUMBER) {
+            if (allow_extended && this_op->IsHBLFunctionCall() && CanCallBFFunctionFromCompiledCode (this_op->GetHBLFunctionID())) {
+                long const arguments = GetBFFunctionArgumentCount (this_op->GetHBLFunctionID());
+                if ((long)operands.countitems() < arguments) {
+                    return false;
+                }
+                // arguments are passed as numbers, so containers can't be among them
+                for (long k = 1L; k <= arguments; k++) {
+                    long const argument_var = variable_operand (operands.Pop());
+                    if (argument_var >= 0L && (LocateVar (argument_var)->ObjectClass() & (MATRIX | ASSOCIATIVE_LIST))) {
+                        return false;
+                    }
+                }
+                loc_depth -= arguments;
+            } else {
                 return false;
             }
+        } else if (this_op->theNumber) {
+            if (this_op->theNumber->ObjectClass() != NUMBER) {
+                if (!allow_extended || !IsSimpleDictionaryKey (i)) {
+                    return false;
+                }
+            }
         } else {
             if (this_op->theData >= 0) {
                 _Variable* this_var = LocateVar (this_op->theData);
                 if (this_var->ObjectClass()!=NUMBER) {
                     HBLObjectRef cv = this_var->GetValue();
                     if (!CheckSimpleTerm (cv)) {
-                        return false;
+                        if (allow_extended && cv && cv->ObjectClass() == ASSOCIATIVE_LIST) {
+                            dictionaries << i;
+                        } else {
+                            return false;
+                        }
                     }
                 }
                 variable_index.InsertNumber (this_op->GetAVariable());
@@ -2181,21 +2246,43 @@ bool _Formula::AmISimple (long& stack_depth, _AVLList& variable_index) {
               
                 if (simpleOperationCodes.Find(op_code)==kNotFound) {
                     return false;
-                } else if ((op_code == HY_OP_CODE_MACCESS || op_code == HY_OP_CODE_MCOORD || op_code == HY_OP_CODE_MUL) && this_op->GetNoTerms() != 2) {
+                } else if (op_code == HY_OP_CODE_MACCESS || op_code == HY_OP_CODE_MCOORD) {
+                    if ((this_op->GetNoTerms() != 2 && this_op->GetNoTerms() != 3) || (long)operands.countitems() < this_op->GetNoTerms()) {
+                        return false;
+                    }
+                    // only a variable can be indexed; it is passed by reference
+                    long const container_op = operands.get (operands.countitems() - this_op->GetNoTerms()),
+                               container    = variable_operand (container_op);
+                    if (container < 0L) {
+                        return false;
+                    }
+                    dictionaries.Delete (dictionaries.Find (container_op));
+                    if (container_index) {
+                        container_index->InsertNumber (container);
+                    }
+                } else if (op_code == HY_OP_CODE_MUL && this_op->GetNoTerms() != 2) {
                     return false;
                 }
 
                 loc_depth -= this_op->GetNoTerms();
+                for (long k = 0L; k < this_op->GetNoTerms() && operands.nonempty(); k++) {
+                    operands.Pop();
+                }
             }
         }
+        operands << i;
         if (loc_depth>stack_depth) {
             stack_depth = loc_depth;
         } else if (loc_depth==0L) {
-             HandleApplicationError (_String("Invalid formula (no return value) passed to ") & __PRETTY_FUNCTION__ & " :" & _String ((_String*)toStr(kFormulaStringConversionNormal)).Enquote());
+            if (!allow_extended) {
+                HandleApplicationError (_String("Invalid formula (no return value) passed to ") & __PRETTY_FUNCTION__ & " :" & _String ((_String*)toStr(kFormulaStringConversionNormal)).Enquote());
+            }
+            // when compiling HBL code, the statement is left to the interpreter (e.g. a call to a function
+            // which did not exist when the statement was parsed reads as a product)
             return false;
         }
     }
-    return true;
+    return dictionaries.empty();
 }
 
 //__________________________________________________________________________________
@@ -2213,19 +2300,32 @@ bool _Formula::ConvertToSimple (_AVLList& variable_index) {
         for (unsigned long i=0UL; i<theFormula.countitems(); i++) {
             _Operation* this_op = ItemAt (i);
             if (this_op->theNumber) {
+                if (this_op->theNumber->ObjectClass() != NUMBER) {
+                    this_op->numberOfTerms = kSimpleOperationStringKey;
+                }
                 continue;
             } else if (this_op->theData >= 0) {
                 this_op->theData = variable_index.FindLong (this_op->theData);
+            } else if (this_op->IsHBLFunctionCall()) {
+                // opCode keeps the function index
+                this_op->numberOfTerms = kSimpleOperationCall;
             } else if (this_op->opCode == HY_OP_CODE_SUB && this_op->numberOfTerms == 1) {
                 this_op->opCode = (long)MinusNumber;
-            } else {
-                if (this_op->opCode == HY_OP_CODE_MACCESS) {
-                    this_op->numberOfTerms = -2;
+            } else if (this_op->opCode == HY_OP_CODE_MACCESS || this_op->opCode == HY_OP_CODE_MCOORD) {
+                bool const is_read  = this_op->opCode == HY_OP_CODE_MACCESS,
+                           by_key   = i > 0UL && ItemAt (i-1UL)->theNumber && ItemAt (i-1UL)->numberOfTerms == kSimpleOperationStringKey;
+              
+                if (this_op->numberOfTerms == 3) {
+                    this_op->numberOfTerms = is_read ? kSimpleOperationCellRead : kSimpleOperationCellWrite;
+                    this_op->opCode        = is_read ? (long)FastMxAccess2D : (long)FastMxWrite2D;
+                } else if (by_key) {
+                    this_op->numberOfTerms = is_read ? kSimpleOperationKeyRead : kSimpleOperationKeyWrite;
+                    this_op->opCode        = is_read ? (long)FastDictAccess : (long)FastDictWrite;
                 } else {
-                  if (this_op->opCode == HY_OP_CODE_MCOORD) {
-                    this_op->numberOfTerms = -3;
-                  }
+                    this_op->numberOfTerms = is_read ? kSimpleOperationElementRead : kSimpleOperationElementWrite;
+                    this_op->opCode        = is_read ? (long)FastMxAccess : (long)FastMxWrite;
                 }
+            } else {
                 if (this_op->opCode == HY_OP_CODE_RANDOM || this_op->opCode == HY_OP_CODE_TIME)
                     has_volatiles = true;
                 this_op->opCode = simpleOperationFunctions(simpleOperationCodes.Find(this_op->opCode));
@@ -2250,21 +2350,40 @@ void _Formula::ConvertFromSimpleList (_SimpleList const& variableIndex) {
   for (unsigned long i=0UL; i<theFormula.countitems(); i++) {
     _Operation* this_op = ItemAt (i);
     if (this_op->theNumber) {
+      if (this_op->numberOfTerms == kSimpleOperationStringKey) {
+        this_op->numberOfTerms = 0L;
+      }
       continue;
     } else {
       if (this_op->theData>-1) {
         this_op->theData = variableIndex.get (this_op->theData);
+      } else if (this_op->numberOfTerms == kSimpleOperationCall) {
+        this_op->numberOfTerms = -this_op->opCode - 1L;
       } else if (this_op->opCode == (long)MinusNumber) {
         this_op->opCode = HY_OP_CODE_SUB;
       } else {
-        if (this_op->opCode == (long)FastMxAccess) {
-          this_op->numberOfTerms = 2;
-        } else {
-          if (this_op->opCode == (long)FastMxWrite) {
-            this_op->numberOfTerms = 2;
-          }
+        switch (this_op->numberOfTerms) {
+          case kSimpleOperationElementRead:
+          case kSimpleOperationKeyRead:
+            this_op->opCode        = HY_OP_CODE_MACCESS;
+            this_op->numberOfTerms = 2L;
+            break;
+          case kSimpleOperationElementWrite:
+          case kSimpleOperationKeyWrite:
+            this_op->opCode        = HY_OP_CODE_MCOORD;
+            this_op->numberOfTerms = 2L;
+            break;
+          case kSimpleOperationCellRead:
+            this_op->opCode        = HY_OP_CODE_MACCESS;
+            this_op->numberOfTerms = 3L;
+            break;
+          case kSimpleOperationCellWrite:
+            this_op->opCode        = HY_OP_CODE_MCOORD;
+            this_op->numberOfTerms = 3L;
+            break;
+          default:
+            this_op->opCode = simpleOperationCodes(simpleOperationFunctions.Find(this_op->opCode));
         }
-        this_op->opCode = simpleOperationCodes(simpleOperationFunctions.Find(this_op->opCode));
       }
     }
   }
@@ -2280,7 +2399,11 @@ hyFloat _Formula::ComputeSimple (_SimpleFormulaDatum* stack, _SimpleFormulaDatum
         for (unsigned long i=0UL; i<upper_bound; i++) {
             _Operation const* thisOp = ItemAt (i);
             if (thisOp->theNumber) {
-                stack[stackTop++].value = thisOp->theNumber->Value();
+                if (thisOp->numberOfTerms == kSimpleOperationStringKey) {
+                    stack[stackTop++].reference = (hyPointer)thisOp->theNumber;
+                } else {
+                    stack[stackTop++].value = thisOp->theNumber->Value();
+                }
                 continue;
             } else {
                 if (thisOp->theData>-1) {
@@ -2297,7 +2420,7 @@ hyFloat _Formula::ComputeSimple (_SimpleFormulaDatum* stack, _SimpleFormulaDatum
                         stack[stackTop-1].value = (*theFunc)(stack[stackTop-1].value,stack[stackTop].value);
                     } else {
                       switch (thisOp->numberOfTerms) {
-                        case -2 : {
+                        case kSimpleOperationElementRead : {
                             hyFloat  (*theFunc) (hyPointer,hyFloat);
                             theFunc = (hyFloat(*)(hyPointer,hyFloat))thisOp->opCode;
                             if (stackTop<1L) {
@@ -2307,9 +2430,28 @@ hyFloat _Formula::ComputeSimple (_SimpleFormulaDatum* stack, _SimpleFormulaDatum
                             stack[stackTop-1].value = (*theFunc)(stack[stackTop-1].reference,stack[stackTop].value);
                             break;
                           }
-                        case -3 : {
-                          void  (*theFunc) (hyPointer,hyFloat,hyFloat);
-                          theFunc = (void(*)(hyPointer,hyFloat,hyFloat))thisOp->opCode;
+                        case kSimpleOperationKeyRead : {
+                            hyFloat  (*theFunc) (hyPointer,hyPointer);
+                            theFunc = (hyFloat(*)(hyPointer,hyPointer))thisOp->opCode;
+                            if (stackTop<1L) {
+                                HandleApplicationError ("Internal error in _Formula::ComputeSimple - stack underflow.)", true);
+                                return 0.0;
+                            }
+                            stack[stackTop-1].value = (*theFunc)(stack[stackTop-1].reference,stack[stackTop].reference);
+                            break;
+                          }
+                        case kSimpleOperationCellRead : {
+                            hyFloat  (*theFunc) (hyPointer,hyFloat,hyFloat);
+                            theFunc = (hyFloat(*)(hyPointer,hyFloat,hyFloat))thisOp->opCode;
+                            if (--stackTop<1L) {
+                                HandleApplicationError ("Internal error in _Formula::ComputeSimple - stack underflow.)", true);
+                                return 0.0;
+                            }
+                            stack[stackTop-1].value = (*theFunc)(stack[stackTop-1].reference,stack[stackTop].value,stack[stackTop+1].value);
+                            break;
+                          }
+                        case kSimpleOperationElementWrite :
+                        case kSimpleOperationKeyWrite : {
                           if (stackTop != 2 || i != theFormula.lLength - 1) {
                             HandleApplicationError ("Internal error in _Formula::ComputeSimple - stack underflow or MCoord command is not the last one.)", true);
 
@@ -2317,7 +2459,33 @@ hyFloat _Formula::ComputeSimple (_SimpleFormulaDatum* stack, _SimpleFormulaDatum
                           }
                           //stackTop = 0;
                           // value, reference, index
-                          (*theFunc)(stack[1].reference,stack[2].value, stack[0].value);
+                          if (thisOp->numberOfTerms == kSimpleOperationKeyWrite) {
+                            ((void(*)(hyPointer,hyPointer,hyFloat))thisOp->opCode)(stack[1].reference,stack[2].reference, stack[0].value);
+                          } else {
+                            ((void(*)(hyPointer,hyFloat,hyFloat))thisOp->opCode)(stack[1].reference,stack[2].value, stack[0].value);
+                          }
+                          break;
+                        }
+                        case kSimpleOperationCellWrite : {
+                          void  (*theFunc) (hyPointer,hyFloat,hyFloat,hyFloat);
+                          theFunc = (void(*)(hyPointer,hyFloat,hyFloat,hyFloat))thisOp->opCode;
+                          if (stackTop != 3 || i != theFormula.lLength - 1) {
+                            HandleApplicationError ("Internal error in _Formula::ComputeSimple - stack underflow or MCoord command is not the last one.)", true);
+                            return 0.0;
+                          }
+                          // value, reference, row, column
+                          (*theFunc)(stack[1].reference,stack[2].value,stack[3].value, stack[0].value);
+                          break;
+                        }
+                        case kSimpleOperationCall : {
+                          // the arguments are the top entries of the stack; the result replaces them
+                          stackTop += 1L - GetBFFunctionArgumentCount (thisOp->opCode);
+                          if (stackTop<0L) {
+                              HandleApplicationError ("Internal error in _Formula::ComputeSimple - stack underflow.)", true);
+                              return 0.0;
+                          }
+                          stack[stackTop].value = CallBFFunctionFromCompiledCode (thisOp->opCode, stack, stackTop, varValues);
+                          ++stackTop;
                           break;
                         }
                         default: {
@@ -43,6 +43,7 @@
 #include "global_things.h"
 #include "calcnode.h"
 #include "function_templates.h"
+#include "json_parser.h"
 #include "tree.h"
 #include "tree_iterator.h"
 
@@ -60,6 +61,23 @@ extern _String last_model_parameter_list;*/
 using namespace hyphy_global_objects;
 using namespace hy_global;
 
+static _hyObjectPool <_FString, _HY_FSTRING_PREALLOCATE_SLOTS>     _hy_fstring_pool;
+
+//__________________________________________________________________________________
+void * _FString::operator new (size_t size) {
+    return _hy_fstring_pool.Allocate (size);
+}
+
+//__________________________________________________________________________________
+void  _FString::operator delete (void * p, size_t size) {
+    _hy_fstring_pool.Release (p, size);
+}
+
+//__________________________________________________________________________________
+_hyObjectPoolStatistics const & _FString::PoolStatistics (void) {
+    return _hy_fstring_pool.Statistics();
+}
+
 //__________________________________________________________________________________
 _FString::_FString (void) {
     the_string = new _StringBuffer;
@@ -133,16 +151,22 @@ _FString::_FString (_String const& data, bool meta) {
 
 //__________________________________________________________________________________
 BaseRef _FString::makeDynamic (void) const {
+  // copies share the string buffer; AddOn (the only in-place modification)
+  // detaches a shared buffer before appending to it
+  _FString * copy = new _FString;
   if (the_string) {
-    return new _FString(*the_string, false);
+    copy->SetStringContent (the_string);
+    the_string->AddAReference();
   }
-  return new _FString;
+  return copy;
 }
 
 //__________________________________________________________________________________
 void _FString::Duplicate (BaseRefConst o) {
+    _StringBuffer * source = ((_FString const*)o)->the_string;
+    source->AddAReference();
     DeleteObject (the_string);
-    the_string = (_StringBuffer*)((_FString const*)o)->get_str().makeDynamic();
+    the_string = source;
 }
 
 //__________________________________________________________________________________
@@ -175,6 +199,12 @@ HBLObjectRef _FString::Sum (void) {
 //__________________________________________________________________________________
 long _FString::AddOn (HBLObjectRef p) {
     if (p->ObjectClass()==STRING) {
+        if (!the_string->CanFreeMe()) {
+            // the buffer is shared with copies of this string (or dictionary keys); detach
+            _StringBuffer * shared = the_string;
+            the_string = new _StringBuffer (*shared);
+            shared->RemoveAReference();
+        }
         *the_string << ((_FString*)p)->get_str();
         return ((_FString*)p)->get_str().length();
     } else if (p->ObjectClass()==NUMBER) {
@@ -491,6 +521,22 @@ HBLObjectRef _FString::Evaluate (_hyExecutionContext* context) {
     return new _MathObject;
 }
 
+//__________________________________________________________________________________
+
+HBLObjectRef _FString::ParseJSON (_hyExecutionContext* context) {
+    try {
+        return ParseJSONText (get_str());
+    } catch (_String const& error) {
+        _String errM = _String ("ParseJSON: ") & error;
+        if (context) {
+            context->ReportError (errM);
+        } else {
+            HandleApplicationError (errM);
+        }
+    }
+    return new _MathObject;
+}
+
   //__________________________________________________________________________________
 
 HBLObjectRef _FString::SubstituteAndSimplify(HBLObjectRef arguments) {
@@ -571,6 +617,8 @@ HBLObjectRef _FString::ExecuteSingleOp (long opCode, _List* arguments, _hyExecut
       return new _Constant (get_str().length());
     case HY_OP_CODE_EVAL: // Eval
         return Evaluate(context);
+    case HY_OP_CODE_PARSEJSON: // ParseJSON
+        return ParseJSON(context);
     case HY_OP_CODE_EXP: // Exp
       return new _Constant (get_str().LempelZivProductionHistory(nil));
     case HY_OP_CODE_LOG: // Log - check sum
@@ -44,6 +44,7 @@
 #include "batchlan.h"
 #include "mersenne_twister.h"
 #include "global_object_lists.h"
+#include "sampling_profiler.h"
 
 #if defined   __UNIX__ 
     #include <unistd.h>
@@ -59,6 +60,18 @@
 #include <signal.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#ifdef __HYPHYZLIB__
+    #include <zlib.h>
+#endif
+
+#ifdef __HYPHYZSTD__
+    #include <zstd.h>
+#endif
+
 
 using     namespace hy_env;
 
@@ -91,7 +104,12 @@ namespace hy_global {
                      terminate_execution = false,
                      has_terminal_stdout = true,
                      has_terminal_stderr = true,
-                     ignore_kw_defaults  = false;
+                     ignore_kw_defaults  = false,
+                     hy_strict_function_parsing = false;
+        /** if set (e.g., via a -s command line flag), HBL function bodies
+            are parsed when the function is defined, rather than on first call,
+            so that syntax errors are reported up front
+         */
     
     FILE            *hy_error_log_file,
                     *hy_message_log_file;
@@ -149,9 +167,9 @@ namespace hy_global {
                      squarings_count;
     
     int              hy_mpi_node_rank,
-        // [MPI only] the MPI rank of the current node (0 = master, 1... = slaves)
+        // [MPI or local workers] the MPI rank of the current node (0 = master, 1... = slaves)
                      hy_mpi_node_count;
-        // [MPI only]  MPI node count on the system
+        // [MPI or local workers]  MPI node count on the system (for local workers, set with WORKERS=)
   
     long             system_CPU_count = 1L,
         /** the number of CPUs for OpenMP */
@@ -225,6 +243,211 @@ namespace hy_global {
         }
         return daFile;
     }
+    
+    //____________________________________________________________________________________
+
+    template <typename CONSUMER> static bool DecodeCompressedFile (FILE * file, CONSUMER consume) {
+        // gzip and zstd streams are recognized by their leading magic bytes;
+        // the compressed file is read in blocks, and the next block is read from disk
+        // (into the other of two buffers) while the current one is being decoded;
+        // every decoded chunk (at most kDecompressedBlock bytes) is passed to
+        // consume (const char*, unsigned long) and then overwritten
+        
+        static const unsigned long kCompressedBlock   = 1UL << 22,
+                                   kDecompressedBlock = 1UL << 20;
+        
+        if (!file) {
+            return nil;
+        }
+        
+        unsigned char magic [4] = {0,0,0,0};
+        long const    start     = ftell (file);
+        size_t const  magic_length = fread (magic, 1, 4, file);
+        fseek (file, start, SEEK_SET);
+        
+        bool const is_gzip = magic_length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b,
+                   is_zstd = magic_length == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd;
+        
+        if (!is_gzip && !is_zstd) {
+            return false;
+        }
+        
+#ifndef __HYPHYZLIB__
+        if (is_gzip) {
+            throw _String ("This build of HyPhy can not read gzip compressed files (zlib was not available at compile time)");
+        }
+#endif
+#ifndef __HYPHYZSTD__
+        if (is_zstd) {
+            throw _String ("This build of HyPhy can not read zstd compressed files (libzstd was not available at compile time)");
+        }
+#endif
+        
+        _String         decoding_error;
+        
+        char * blocks [2] = {(char*)MemAllocate (kCompressedBlock), (char*)MemAllocate (kCompressedBlock)},
+             * decoded    = (char*)MemAllocate (kDecompressedBlock);
+        size_t block_sizes [2] = {fread (blocks[0], 1, kCompressedBlock, file), 0};
+        
+#ifdef __HYPHYZLIB__
+        z_stream inflater;
+        bool     inflater_done = false;
+        if (is_gzip) {
+            memset (&inflater, 0, sizeof (z_stream));
+            inflateInit2 (&inflater, 15 + 32);
+        }
+#endif
+#ifdef __HYPHYZSTD__
+        ZSTD_DStream * zstd_stream = is_zstd ? ZSTD_createDStream () : nil;
+        size_t         zstd_pending = 0; // non-zero while a frame is incomplete
+#endif
+        
+        auto decode_block = [&] (const char * block, size_t block_size) -> void {
+#ifdef __HYPHYZLIB__
+            if (is_gzip) {
+                inflater.next_in  = (Bytef*)block;
+                inflater.avail_in = (uInt)block_size;
+                while (inflater.avail_in) {
+                    if (inflater_done) {
+                        // concatenated gzip members (e.g. BGZF) are decoded back to back
+                        inflateReset (&inflater);
+                        inflater_done = false;
+                    }
+                    inflater.next_out  = (Bytef*)decoded;
+                    inflater.avail_out = (uInt)kDecompressedBlock;
+                    int const code = inflate (&inflater, Z_NO_FLUSH);
+                    if (code != Z_OK && code != Z_STREAM_END) {
+                        decoding_error = _String ("Damaged gzip stream (") & (inflater.msg ? inflater.msg : "zlib error") & ")";
+                        return;
+                    }
+                    consume (decoded, kDecompressedBlock - inflater.avail_out);
+                    inflater_done = code == Z_STREAM_END;
+                }
+            }
+#endif
+#ifdef __HYPHYZSTD__
+            if (is_zstd) {
+                ZSTD_inBuffer input = {block, block_size, 0};
+                while (input.pos < input.size) {
+                    ZSTD_outBuffer output = {decoded, kDecompressedBlock, 0};
+                    zstd_pending = ZSTD_decompressStream (zstd_stream, &output, &input);
+                    if (ZSTD_isError (zstd_pending)) {
+                        decoding_error = _String ("Damaged zstd stream (") & ZSTD_getErrorName (zstd_pending) & ")";
+                        return;
+                    }
+                    consume (decoded, output.pos);
+                }
+            }
+#endif
+        };
+        
+        int current = 0;
+        while (block_sizes[current] && decoding_error.empty()) {
+            int const next = 1 - current;
+            bool const more = block_sizes[current] == kCompressedBlock;
+            block_sizes[next] = 0;
+#ifdef _OPENMP
+            #pragma omp parallel sections num_threads(2) if (more && omp_get_max_threads() > 1)
+#endif
+            {
+#ifdef _OPENMP
+                #pragma omp section
+#endif
+                if (more) {
+                    block_sizes[next] = fread (blocks[next], 1, kCompressedBlock, file);
+                }
+#ifdef _OPENMP
+                #pragma omp section
+#endif
+                decode_block (blocks[current], block_sizes[current]);
+            }
+            current = next;
+        }
+        
+#ifdef __HYPHYZLIB__
+        if (is_gzip) {
+            if (decoding_error.empty() && !inflater_done) {
+                decoding_error = "Truncated gzip stream";
+            }
+            inflateEnd (&inflater);
+        }
+#endif
+#ifdef __HYPHYZSTD__
+        if (zstd_stream) {
+            if (decoding_error.empty() && zstd_pending) {
+                decoding_error = "Truncated zstd stream";
+            }
+            ZSTD_freeDStream (zstd_stream);
+        }
+#endif
+        
+        free (blocks[0]);
+        free (blocks[1]);
+        free (decoded);
+        
+        if (decoding_error.nonempty()) {
+            throw decoding_error;
+        }
+        
+        return true;
+    }
+    
+    //____________________________________________________________________________________
+
+    FILE *    DecompressToTemporaryFile (FILE * file) {
+        FILE * target = nil;
+        bool   write_failed = false;
+        try {
+            bool const compressed = DecodeCompressedFile (file, [&target, &write_failed] (const char * chunk, unsigned long chunk_length) -> void {
+                if (!target && !write_failed) {
+                    write_failed = (target = tmpfile ()) == nil;
+                }
+                if (!write_failed && fwrite (chunk, 1, chunk_length, target) != chunk_length) {
+                    write_failed = true;
+                }
+            });
+            if (!compressed) {
+                return nil;
+            }
+            if (!target && !write_failed) { // nothing was decoded
+                write_failed = (target = tmpfile ()) == nil;
+            }
+            if (write_failed || fflush (target)) {
+                throw _String ("Failed to write the decompressed contents of a file to a temporary file");
+            }
+        } catch (const _String&) {
+            if (target) {
+                fclose (target);
+            }
+            throw;
+        }
+        rewind (target);
+        return target;
+    }
+    
+    //____________________________________________________________________________________
+
+    _StringBuffer *    DecompressFile (FILE * file, unsigned long skip, unsigned long & decoded_length) {
+        _StringBuffer * result = new _StringBuffer;
+        decoded_length = 0UL;
+        try {
+            bool const compressed = DecodeCompressedFile (file, [result, skip, &decoded_length] (const char * chunk, unsigned long chunk_length) -> void {
+                // the first 'skip' decoded characters are counted, but not kept
+                unsigned long const from = skip > decoded_length ? MIN (skip - decoded_length, chunk_length) : 0UL;
+                result->PushCharBuffer (chunk + from, chunk_length - from);
+                decoded_length += chunk_length;
+            });
+            if (!compressed) {
+                DeleteObject (result);
+                return nil;
+            }
+        } catch (const _String&) {
+            DeleteObject (result);
+            throw;
+        }
+        return result;
+    }
+    
     //____________________________________________________________________________________
    
 
@@ -320,6 +543,7 @@ namespace hy_global {
             dataSetList.Clear();
             dataSetNamesList.Clear();
             batchLanguageFunctions.Clear();
+            batchLanguageFunctionStamp++;
             compiledFormulaeParameters.Clear();
             modelNames.Clear();
             KillExplicitModelFormulae ();
@@ -328,6 +552,8 @@ namespace hy_global {
             modelTypeList.Clear();
             listOfCompiledFormulae.Clear();
             variablePtrs.Clear();
+            variableChangeStamp++;
+            variableSlotStamp++;
             freeSlots.Clear();
             lastMatrixDeclared = -1;
             variableNames.Clear(true);
@@ -349,6 +575,11 @@ namespace hy_global {
         MPI_Comm_size   (MPI_COMM_WORLD, &hy_mpi_node_count);
         EnvVariableSet  (mpi_node_count, new _Constant (hy_mpi_node_count), false);
         EnvVariableSet  (mpi_node_id, new _Constant (hy_mpi_node_rank), false);
+#elif defined __HYPHY_LOCAL_WORKERS__
+        if (hy_mpi_node_count > 1) {
+            EnvVariableSet  (mpi_node_count, new _Constant (hy_mpi_node_count), false);
+            EnvVariableSet  (mpi_node_id, new _Constant (hy_mpi_node_rank), false);
+        }
 #endif
     }
 
@@ -365,9 +596,6 @@ namespace hy_global {
         init_genrand            (hy_random_seed);
         EnvVariableSet(random_seed, new _Constant (hy_random_seed), false);
         
-        _Constant::free_slots.Populate ((long)_HY_CONSTANT_PREALLOCATE_SLOTS, (long)_HY_CONSTANT_PREALLOCATE_SLOTS-1, -1L);
-        _StringBuffer::free_slots.Populate ((long)_HY_STRING_BUFFER_PREALLOCATE_SLOTS, (long)_HY_STRING_BUFFER_PREALLOCATE_SLOTS-1, -1L);
-
         
 #ifdef __HYPHYMPI__
         hy_env :: EnvVariableSet (hy_env::mpi_node_id, new _Constant (hy_mpi_node_rank), false);
@@ -377,6 +605,12 @@ namespace hy_global {
  #else
         has_terminal_stdout = isatty (STDOUT_FILENO);
         has_terminal_stderr = isatty (STDERR_FILENO);
+    #ifdef __HYPHY_LOCAL_WORKERS__
+        if (hy_mpi_node_count > 1) {
+            hy_env :: EnvVariableSet (hy_env::mpi_node_id, new _Constant (hy_mpi_node_rank), false);
+            hy_env :: EnvVariableSet (hy_env::mpi_node_count, new _Constant (hy_mpi_node_count), false);
+        }
+    #endif
 #endif
 
 #if not defined (__HYPHY_MPI_MESSAGE_LOGGING__) && defined (__HYPHYMPI__)
@@ -431,6 +665,8 @@ namespace hy_global {
     bool    GlobalShutdown (void) {
         bool no_errors = true;
         
+        StopSamplingProfiler ();
+        
 #if defined __UNIX__
         if (hy_need_extra_nl) {
             printf ("\n");
@@ -452,6 +688,9 @@ namespace hy_global {
         }
 #else
         fflush (stdout);
+    #ifdef __HYPHY_LOCAL_WORKERS__
+        StopLocalWorkers ();
+    #endif
 #endif
         
         
@@ -504,13 +743,6 @@ namespace hy_global {
                 }
             }
         }
-        
-        /*if (_Constant::preallocated_buffer) {
-            free ((void*)_Constant::preallocated_buffer);
-        }
-        if (_StringBuffer::preallocated_buffer) {
-            free ((void*)_StringBuffer::preallocated_buffer);
-        }*/
         return no_errors;
     }
     
@@ -170,6 +170,10 @@ _String const
         // the string of data partitions read from the last valid NEXUS CHARSET block
     data_file_print_format                          ("DATA_FILE_PRINT_FORMAT"),
       // determines the file format for datasets and datafilters
+    data_file_streaming_threshold                   ("DATA_FILE_STREAMING_THRESHOLD"),
+      // if positive, FASTA files of at least this many bytes are read by ReadDataFile
+      // one block of columns at a time, retaining only unique site patterns;
+      // this bounds memory use for very long alignments
 
     data_file_tree                                  ("IS_TREE_PRESENT_IN_DATA"),
         // set to TRUE if the last data load call yielded a Newick trees
@@ -266,6 +270,11 @@ _String const
         // if set, will trigger automatic renaming of sequence names from files to valid
         // HyPhy IDs, e.g. "awesome monkey!" -> "awesome_monkey_"
         // the mapping will go into dataset_id.mapping
+    parse_cache_directory                           ("PARSE_CACHE_DIRECTORY"),
+        // if set to the path of an existing directory, the statements scanned from each batch file
+        // read by ExecuteAFile / LoadFunctionLibrary (or from the command line) are kept in a binary
+        // cache file in that directory and reused the next time the unchanged file is read; see parse_cache.h
+        // can be set via a CL argument (PARSECACHE)
     path_to_current_bf                              ("PATH_TO_CURRENT_BF"),
         // is set to the absolute path for the currently executed batch file (assuming it has one)
     print_float_digits                              ("PRINT_DIGITS"),
@@ -45,6 +45,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "avllistxl_iterator.h"
 #include "variablecontainer.h"
 #include "trie.h"
+#include "string_file_wrapper.h"
 
 
 
@@ -138,6 +139,10 @@ public:
       return avl.countitems();
     }
     _StringBuffer *            Serialize       (unsigned long) const;
+    void                SerializeTo     (StringFileWrapper&, unsigned long) const;
+    /* write the Serialize representation directly to a string buffer or a file;
+       nested lists and matrices are written in place rather than converted to strings first */
+    virtual void        toFileStr       (FILE*, unsigned long = 0UL);
     unsigned   long     countitems      (void) const {
         return avl.countitems();
     }
@@ -170,8 +175,22 @@ public:
 
     
 private:
+    /* keys are stored in an AVL tree (which provides the sorted traversal
+       used by iterators and serialization); once the list grows past a small
+       number of keys, an open addressing hash index over AVL slots is also
+       maintained so that key lookups do not need to walk the tree.
+     */
+    long                FindKey          (_String const&) const;
+    void                InsertKey        (_String*, HBLObjectRef);
+    void                RemoveKey        (_String const&);
+    long                HashIndexProbe   (_String const&, unsigned long) const;
+    void                RebuildHashIndex (void);
+
     _AVLListXL          avl;
     _List           theData;
+    _SimpleList     hash_index,     // AVL slot for each table entry (-1 : empty, -2 : deleted)
+                    key_hashes;     // cached key hash for each AVL slot
+    unsigned long   hash_index_used;// number of non-empty (including deleted) table entries
 };
 
 void       InsertStringListIntoAVL  (_AssociativeList* , _String const&, _SimpleList const&, _List const&);
@@ -62,7 +62,12 @@ struct    _CELInternals {
     bool                    *is_compiled;
 
     _SimpleList             varList,
-                            storeResults;
+                            storeResults,
+                            assignedSlots,  // sorted value array indices of variables assigned by compiled statements
+                            containerSlots, // sorted value array indices of variables indexed by compiled statements
+                            returnSlots;    // sorted value array indices of variables read only by compiled return statements
+
+    bool                    numericReturns; // false if some returnSlots variable held a non-number when the values array was filled
 
 };
 
@@ -79,6 +84,26 @@ struct    _HBLCommandExtras {
 };
 
 class _ElementaryCommand;
+class _ExecutionList;
+
+//____________________________________________________________________________________
+struct    _HBLCompiledSource {
+    /** the execution list built from 'source' by the last call to
+        ExecuteCommands from a given command; reused only if
+            - the source text and the namespace are the same,
+            - variable_stamp == variableSlotStamp (no variable slot was freed and no
+              name was re-pointed, e.g. by binding a reference argument, since parsing),
+            - function_stamp == batchLanguageFunctionStamp (no HBL function was defined,
+              redefined or deleted since parsing), and
+            - the list is not being executed (it is singly referenced).
+        Changes to the values, types or constraints of variables do not invalidate the list.
+     */
+    _String             source,
+                        name_space;
+    _ExecutionList      *code;
+    unsigned long       variable_stamp,
+                        function_stamp;
+};
 
 //____________________________________________________________________________________
 class   _ExecutionList: public _List // a sequence of commands to be executed
@@ -86,7 +111,7 @@ class   _ExecutionList: public _List // a sequence of commands to be executed
     
 public:
     _ExecutionList (); // doesn't do much
-    _ExecutionList (_String&, _String* = nil, bool = false, bool* = nil);
+    _ExecutionList (_String&, _String* = nil, bool = false, bool* = nil, _String const * source_file = nil);
     void Init (_String* = nil);
 
     virtual     ~_ExecutionList (void);
@@ -205,7 +230,34 @@ public:
                                     enclosingNamespace;
     
     _SimpleList                     callPoints,
-                                    lastif;
+                                    lastif,
+                                    argument_slots;
+    
+    /** variable indices of the arguments of the HBL function whose body
+        this is, resolved on the last call; valid while argument_slots_stamp
+        equals variableSlotStamp
+     */
+    
+    unsigned long                   argument_slots_stamp;
+    
+    /** set for an HBL function body whose source (in sourceText) has not
+        been parsed yet; see GetBFFunctionBody
+     */
+    
+    bool                            is_deferred;
+    
+    /** set for a cfunction body which has been parsed but not compiled yet;
+        it is compiled on first use (see GetBFFunctionBody), when all the
+        functions it calls have been defined
+     */
+    
+    bool                            is_compile_pending;
+    
+    /** the label of this list in the sampling profiler frame table
+        (-1 : not yet resolved); see SamplingProfilerEnter
+     */
+    
+    long                            profile_frame;
 
     _Matrix                         *profileCounter;
 
@@ -355,6 +407,9 @@ public:
     static  bool      ConstructFunction     (_String&, _ExecutionList&);
     // construct a fprintf command
 
+    static  void      BuildFunctionBody     (_ExecutionList&);
+    // parse the (deferred) source text of an HBL function body
+
     static  bool      ConstructReturn       (_String&, _ExecutionList&);
     // construct a fprintf command
 
@@ -428,7 +483,7 @@ protected:
 
 
 private:
-    _Variable*      _ValidateStorageVariable (_ExecutionList& program, unsigned long argument_index = 0UL) const;
+    _Variable*      _ValidateStorageVariable (_ExecutionList& program, unsigned long argument_index = 0UL);
     
     /**
         Extract the identifier from an expression like
@@ -466,6 +521,14 @@ protected:  // data members
     _List       parameters;        // a list of parameters
     _SimpleList simpleParameters;  // a list of numeric parameters
     int         code;              // code describing this command
+    _HBLCompiledSource
+                *compiled_source;  // cached parse of the last ExecuteCommands argument
+  
+    _SimpleList storage_slots;     // variable indices of storage arguments, by argument index (-1 : not resolved)
+    unsigned long
+                storage_slots_stamp; // variableSlotStamp value storage_slots was resolved against
+    _VariableContainer const
+                *storage_slots_namespace;
   
 
 };
@@ -493,6 +556,17 @@ void     ReportMPIError         (int, bool);
 void     MPISendString          (_String const&,long,bool=false);
 _String* MPIRecvString          (long,long&);
 
+#endif
+
+#if !defined __HYPHYMPI__ && defined __UNIX__ && !defined __MINGW32__ && !defined __HEADLESS__
+// without MPI, MPISend/MPIReceive are served by forked local worker processes (see local_workers.cpp)
+#define  __HYPHY_LOCAL_WORKERS__
+
+void     MPISendString          (_String const&,long,bool=false);
+_String* MPIRecvString          (long,long&);
+void     StartLocalWorkers      (void);
+void     StopLocalWorkers       (void);
+
 #endif
 //____________________________________________________________________________________
 
@@ -615,6 +689,14 @@ blSCFG                          ;
 
 extern  _ExecutionList              *currentExecutionList;
 
+extern  unsigned long               batchLanguageFunctionStamp;
+// incremented whenever an HBL function is defined, redefined or deleted (including ClearAll / PurgeAll).
+// Formulas resolve a call to an HBL function (looked up in the current namespace first, then globally)
+// to an index in the function table when they are parsed, so a new function can change what a name
+// refers to. Code parsed under a different stamp (the execution list reused by ExecuteCommands,
+// see _HBLCompiledSource) must be parsed again; code whose parsing itself changed the stamp
+// (it defines functions) is never reused.
+
 extern  _AVLList                    loadedLibraryPaths;
 extern  _AVLListX                   _HY_HBLCommandHelper,
                                     _HY_GetStringGlobalTypes;
@@ -637,6 +719,10 @@ hyBLFunctionType
          GetBFFunctionType            (long);
 _ExecutionList&
           GetBFFunctionBody           (long);
+bool      CanCallBFFunctionFromCompiledCode
+                                      (long);
+hyFloat   CallBFFunctionFromCompiledCode
+                                      (long, _SimpleFormulaDatum*, long, _SimpleFormulaDatum*);
 
 _String const
           ExportBFFunction            (long, bool = true);
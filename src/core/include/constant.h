@@ -42,6 +42,7 @@
 
 #include "mathobj.h"
 #include "global_things.h"
+#include "hy_object_pool.h"
 
 #define  _HY_CONSTANT_PREALLOCATE_SLOTS 16384
 
@@ -141,10 +142,9 @@ public:
     }
     
     void * operator new       (size_t size);
-    void   operator delete    (void * p);
+    void   operator delete    (void * p, size_t size);
   
-    static  _SimpleList                    free_slots;
-    static unsigned char                       preallocated_buffer[];
+    static  _hyObjectPoolStatistics const & PoolStatistics (void);
 
 public:
     hyFloat theValue;
@@ -51,6 +51,10 @@ using namespace hy_global;
 #define HYPHY_SITE_DEFAULT_BUFFER_SIZE 512
 #define DATA_SET_SWITCH_THRESHOLD 100000
 
+class _DataSet;
+class _DataFileView;
+class _Vector;
+
 // data set file state data struct
 struct _DSHelper {
 
@@ -58,6 +62,11 @@ struct _DSHelper {
     _List       incompletePatternStorage;
     _AVLListX*  incompletePatterns;
 
+    // runs of characters queued by _DataSet::Write2Sites, stored back to back,
+    // and (first site, length) pairs describing them
+    _StringBuffer pendingLetters;
+    _SimpleList   pendingRuns;
+
     _DSHelper(void) {
         incompletePatterns = new _AVLListX (&incompletePatternStorage);
     }
@@ -67,6 +76,113 @@ struct _DSHelper {
 };
 
 
+/**
+    A 64-bit hash of a character buffer, consumed 8 bytes at a time;
+    used to group identical alignment columns
+ */
+unsigned long HashCharacterBuffer(const char *, unsigned long);
+
+/**
+    An open addressing table of pattern (column) indices keyed by pattern hashes.
+    Because different patterns can share a hash, every hash match is confirmed
+    by a caller supplied equality test before a pattern is reported as a duplicate.
+ */
+class _PatternHashTable {
+public:
+  _PatternHashTable(unsigned long expected_patterns = 0UL);
+
+  /**
+      Look for a previously inserted pattern equal to 'pattern'
+
+      @param hash the hash of 'pattern'
+      @param pattern the index of the pattern being added
+      @param is_equal (long other) -> bool; true if 'other' is identical to 'pattern'
+      @return the index of the matching pattern, or -1 if 'pattern' is new
+              (in which case it has been inserted)
+   */
+  template <typename EQUALITY>
+  long FindOrInsert(unsigned long hash, long pattern, EQUALITY &&is_equal) {
+    if ((used + 1UL) * 2UL > slots.lLength) {
+      Grow();
+    }
+    unsigned long const mask = slots.lLength - 1UL;
+    for (unsigned long i = hash & mask;; i = (i + 1UL) & mask) {
+      long const other = slots.list_data[i];
+      if (other < 0L) {
+        slots.list_data[i] = pattern;
+        hashes.list_data[i] = hash;
+        used++;
+        return -1L;
+      }
+      if ((unsigned long)hashes.list_data[i] == hash && is_equal(other)) {
+        return other;
+      }
+    }
+  }
+
+  unsigned long countitems(void) const { return used; }
+
+private:
+  void Grow(void);
+
+  _SimpleList slots,  // pattern index for each slot, -1 if empty
+              hashes; // pattern hash for each occupied slot
+  unsigned long used;
+};
+
+/**
+    Character conversions and leaf state resolutions shared by all the
+    filters that read a data set with the same unit length, translation table
+    and excluded states (see _DataSet::GetStateCache). Filters and likelihood
+    functions hold references to the cache and only ever append to it, so
+    state codes and ambiguity indices handed out earlier remain valid.
+    Not thread safe: populate outside of parallel regions.
+ */
+class _DataSetStateCache : public BaseObj {
+public:
+  _DataSetStateCache(_String const &key);
+  virtual ~_DataSetStateCache(void);
+
+  virtual BaseRef makeDynamic(void) const;
+  virtual void Duplicate(BaseRefConst);
+
+  _String const &Key(void) const { return key; }
+
+  /**
+      The code stored for a leaf state (a unit length string)
+
+      @param state the characters of the state
+      @param code receives the code: a state index (>=0) or, for ambiguous
+             states, -k for the k-th resolution vector in Ambiguities()
+      @return true if the state has been resolved before
+   */
+  bool Lookup(_String const &state, long &code) const;
+
+  /**
+      Record the resolution of a new leaf state
+
+      @param state the characters of the state
+      @param code the index of a unique state, or a negative value for an
+             ambiguous one
+      @param resolution the resolution of an ambiguous state ('dimension' long)
+      @return the code that Lookup will report for 'state'
+   */
+  long Store(_String const &state, long code, hyFloat const *resolution,
+             unsigned long dimension);
+
+  // resolution vectors of ambiguous states, back to back
+  _Vector *Ambiguities(void) const { return ambiguities; }
+
+  _SimpleList conversion; // see _DataSetFilter::SetupConversion
+
+private:
+  _String key;
+  _List stateStrings;
+  _AVLListX states;
+  _Vector *ambiguities;
+  long ambiguityCount;
+};
+
 class _DataSet : public _List // a complete data set
 {
 public:
@@ -81,6 +197,10 @@ public:
   void AddSite(char);
 
   void Write2Site(long, char);
+  void Write2Sites(long, const char *, long);
+  // write a run of characters to consecutive sites, starting at the given index;
+  // runs may be queued and written column by column later (see FlushPendingWrites)
+  void FlushPendingWrites(void);
   void CheckMapping(long);
 
   void Finalize(void);
@@ -145,6 +265,14 @@ public:
 
   _String *GetSequenceCharacters(long seqID) const;
 
+  /**
+      The state cache shared by the filters of this data set that use the
+      given unit length and excluded states (see _DataSetStateCache),
+      created on first request. The caller owns the returned reference.
+   */
+  _DataSetStateCache *GetStateCache(unsigned char unit,
+                                    _SimpleList const &exclusions) const;
+
   bool SetSequenceName(long index, _String *new_name) {
     if (index >= 0L && index < theNames.lLength) {
       theNames.Replace(index, new_name, false);
@@ -167,6 +295,27 @@ public:
                                    _String *, _TranslationTable *,
                                    _ExecutionList *);
   friend long ProcessLine(_String &s, FileState *fs, _DataSet &ds);
+  friend bool StreamFastaColumns(FileState &fs, _DataSet &ds,
+                                 _DataFileView const &file);
+
+  /**
+      A binary snapshot of the data set: names, unique patterns, the
+      site-to-pattern map, pattern frequencies and the translation table,
+      behind a signature, version and checksum header.
+      ReadDataFile/ReadFromString reload snapshots (see FromSnapshot)
+      without parsing or compressing the alignment again.
+   */
+  _StringBuffer *Snapshot(void) const;
+
+  /**
+      Rebuild a data set from a snapshot
+
+      @param source the first byte of the (possible) snapshot
+      @param length the number of bytes available at 'source'
+      @return the data set, or nil if 'source' is not a snapshot;
+              throws a _String if it is a damaged or incompatible snapshot
+   */
+  static _DataSet *FromSnapshot(const char *source, unsigned long length);
 
   static _DataSet *Concatenate(const _SimpleList &);
   static _DataSet *Combine(const _SimpleList &);
@@ -199,6 +348,8 @@ private:
 
   _DSHelper *dsh;
   bool useHorizontalRep;
+
+  mutable _List stateCaches;   // of _DataSetStateCache, see GetStateCache
 };
 
 void ReadNextLine(FILE *fp, _String *s, FileState *fs, bool append = false,
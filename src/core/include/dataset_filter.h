@@ -52,6 +52,11 @@ enum _hy_dataset_filter_ambiguity_resolution {
   kAmbiguityHandlingSkip
 };
 
+enum _hy_pairwise_distance_model {
+  kPairwiseDistanceP,
+  kPairwiseDistanceTN93
+};
+
 enum _hy_dataset_filter_unique_match {
   kUniqueMatchExact = 0L,
   kUniqueMatchExactOrGap = 1L,
@@ -112,6 +117,15 @@ public:
                              _hy_dataset_filter_ambiguity_resolution =
                                  kAmbiguityHandlingResolveFrequencyAware) const;
 
+  /**
+      All pairwise distances between the sequences of a nucleotide filter
+      (as a square matrix); the nucleotide frequencies (A,C,G,T) are
+      only needed for TN93 distances
+   */
+  _Matrix *ComputePairwiseDistances(_hy_pairwise_distance_model,
+                                    _hy_dataset_filter_ambiguity_resolution,
+                                    hyFloat const *frequencies = nil) const;
+
   BaseRefConst GetMap(void) const {
     return theNodeMap.lLength ? &theNodeMap : NULL;
   }
@@ -217,6 +231,13 @@ public:
   long LookupConversion(char c, hyFloat *receptacle) const;
   void SetupConversion(void);
   bool ConfirmConversionCache(void) const;
+
+  /**
+      The character conversions and leaf state resolutions that this filter
+      shares with the other filters of its data set (see _DataSetStateCache).
+      Obtained on first use; let go of when the dimensions or exclusions change.
+   */
+  _DataSetStateCache *GetStateCache(void) const;
   void FilterDeletions(_SimpleList *theExc = nil);
   _Matrix *GetFilterCharacters(bool = false) const;
 
@@ -268,8 +289,6 @@ public:
             theData->list_data)[theData->theMap.list_data[theMap.list_data[index]]]));
   }
 
-  _SimpleList conversionCache;
-
 protected:
   unsigned char unitLength;
   long dimension;
@@ -282,6 +301,9 @@ private:
    inline char direct_index_character (unsigned long site, unsigned long sequence) const;
   
    _String *accessCache;
+   mutable _DataSetStateCache *stateCache;
+
+   void ReleaseStateCache(void);
 
   long undimension;
 
@@ -61,6 +61,23 @@ union       _SimpleFormulaDatum {
     hyPointer        reference;
 };
 
+/**
+    Markers stored in _Operation::numberOfTerms by _Formula::ConvertToSimple for
+    operations which are not a plain numeric function of one or two arguments;
+    container operands are passed as object references (see PopulateArraysForASimpleFormula)
+ */
+
+enum _hySimpleOperationKind {
+  kSimpleOperationStringKey    = -1L, // a string constant pushed by reference (a dictionary key)
+  kSimpleOperationElementRead  = -2L, // container[index]
+  kSimpleOperationElementWrite = -3L, // container[index] = value
+  kSimpleOperationCellRead     = -4L, // matrix[row][column]
+  kSimpleOperationCellWrite    = -5L, // matrix[row][column] = value
+  kSimpleOperationKeyRead      = -6L, // dictionary["key"]
+  kSimpleOperationKeyWrite     = -7L, // dictionary["key"] = value
+  kSimpleOperationCall         = -8L  // a call to a compiled HBL function
+};
+
 
 enum _hyFormulaStringConversionMode  {
   kFormulaStringConversionNormal = 0L,
@@ -101,6 +118,11 @@ public:
     // compute the value of the formula
     // 1st argument : execute from this instruction onwards
     // see the commend for ExecuteFormula for the second argument
+    
+    void        ReleaseResult       (void);
+    // drop the reference that the evaluation stack holds to the value returned
+    // by the last (non-recursive) call to Compute, so that the caller can become
+    // its sole owner; no-op while the formula is being evaluated
 
     bool        IsEmpty             (void) const; // is there anything in the formula
     long        NumberOperations    (void) const; // how many ops in the formula?
@@ -187,7 +209,13 @@ public:
 
     */
 
-    bool        AmISimple           (long& stack_depth, _AVLList& variable_index);
+    bool        AmISimple           (long& stack_depth, _AVLList& variable_index, bool allow_extended = false, _AVLList* container_index = nil);
+      /**
+        check whether the formula can be evaluated by ComputeSimple;
+        'allow_extended' also admits dictionary operands, string literal dictionary keys
+        and calls to compiled HBL functions, which only an execution list can supply at run time;
+        variables which are indexed by [] are added to 'container_index', if provided
+       */
     long        StackDepth          (long start_at = 0L, long end_at = -1L) const;
       /**
         starting at operation 'start_at', counting up to 'end_at' (-1 == the end),
@@ -254,6 +282,7 @@ protected:
     void        ConvertToTree       (bool err_msg = true);
     void        ConvertFromTree     (void);
     bool        CheckSimpleTerm     (HBLObjectRef);
+    bool        IsSimpleDictionaryKey (unsigned long);
     node<long>* DuplicateFormula    (node<long>*,_Formula&) const;
 
 
@@ -43,6 +43,9 @@
 #include "mathobj.h"
 #include "hy_string_buffer.h"
 #include "_hyExecutionContext.h"
+#include "hy_object_pool.h"
+
+#define  _HY_FSTRING_PREALLOCATE_SLOTS 4096
 
 //__________________________________________________________________________________
 
@@ -82,6 +85,7 @@ public:
     virtual HBLObjectRef Evaluate          (_hyExecutionContext* context = _hyDefaultExecutionContext);
     virtual HBLObjectRef SubstituteAndSimplify
                                         (HBLObjectRef arguments);
+    HBLObjectRef         ParseJSON         (_hyExecutionContext* context = _hyDefaultExecutionContext);
     virtual HBLObjectRef Join              (HBLObjectRef);
     virtual HBLObjectRef Differentiate     (HBLObjectRef);
     virtual unsigned long      ObjectClass       (void) const {
@@ -127,6 +131,12 @@ public:
     }
     // SLKP 20100907: a simple utility function to check if the object is an empty string
 
+    /// memory buffering
+    void * operator new       (size_t size);
+    void   operator delete    (void * p, size_t size);
+
+    static  _hyObjectPoolStatistics const & PoolStatistics (void);
+
 protected:
   
     _StringBuffer*          the_string;
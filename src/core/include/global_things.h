@@ -58,6 +58,7 @@
 
 class _Variable; // forward decl
 class _ExecutionList; // forward decl
+class _StringBuffer; // forward decl
 
 namespace hy_global {
   
@@ -132,6 +133,32 @@ namespace hy_global {
    */
   FILE*   doFileOpen                (const char * file_path, const char * mode , bool error = false);
   
+  /**
+   Read and decompress the rest of a gzip or zstd compressed file
+   (the compression format is detected from its magic bytes)
+   into an unnamed temporary file, which is deleted when it is closed;
+   the decompressed contents are never held in memory as a whole
+   
+   @param file the file to read (from its current position)
+   
+   @return the temporary file, positioned at its start, or nil if the file is not compressed;
+   throws a _String if the compressed data is damaged, the build can't decode it,
+   or the temporary file can't be written
+   */
+  FILE *          DecompressToTemporaryFile (FILE * file);
+  
+  /**
+   Read and decompress the rest of a gzip or zstd compressed file into memory
+   
+   @param file the file to read (from its current position)
+   @param skip this many decompressed characters are dropped from the start of the result
+   @param decoded_length receives the length of the decompressed contents (including skipped characters)
+   
+   @return a new buffer with the decompressed contents past 'skip', or nil if the file is not compressed;
+   throws a _String if the compressed data is damaged, or the build can't decode it
+   */
+  _StringBuffer * DecompressFile            (FILE * file, unsigned long skip, unsigned long & decoded_length);
+  
   /**
    The omnibus clean-up function that attempts to deallocate all application memory
    and unwind various objects created; the idea is that upon successful completion,
@@ -272,7 +299,8 @@ namespace hy_global {
   terminate_execution,
   has_terminal_stdout,
   has_terminal_stderr,
-  ignore_kw_defaults;
+  ignore_kw_defaults,
+  hy_strict_function_parsing;
   
   extern  int      hy_mpi_node_rank,
   hy_mpi_node_count;
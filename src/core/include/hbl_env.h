@@ -189,6 +189,7 @@ namespace hy_env {
           data_file_gap_width,
           data_file_default_width,
           data_file_print_format,
+          data_file_streaming_threshold,
           branch_length_stencil,
           kExpectedNumberOfSubstitutions,
           kStringSuppliedLengths,
@@ -196,6 +197,7 @@ namespace hy_env {
           lf_convergence_criterion,
           try_numeric_sequence_match,
           short_mpi_return,
+          parse_cache_directory,
           kSCFGCorpus
     ;
   
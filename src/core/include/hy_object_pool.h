@@ -0,0 +1,205 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon@cfenet.ubc.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef _HY_OBJECT_POOL_
+#define _HY_OBJECT_POOL_
+
+#include <stdlib.h>
+#include <new>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+/**
+    Allocation counters for a single object pool; reported by
+    GetString (..., OBJECT_POOL_STATISTICS, ...)
+ */
+
+struct _hyObjectPoolStatistics {
+    unsigned long requests,  // total number of allocation requests
+                  recycled,  // requests served from the free list
+                  overflow,  // requests passed on to the system heap because the pool is at capacity
+                  live,      // currently allocated objects
+                  peak,      // high water mark for 'live'
+                  capacity;  // number of slots carved out of pool chunks
+};
+
+/**
+    A free-list allocator for small, frequently created and destroyed objects
+    (e.g. _Constant results of arithmetic operations).
+
+    Slots are carved out of CHUNK_SIZE object chunks which are never returned
+    to the system; released objects are threaded onto an intrusive free list.
+    Once MAX_CHUNKS chunks have been allocated, further requests go to the
+    system heap.
+
+    Requests for a size other than sizeof (OBJECT) (derived classes which do
+    not define their own operator new) bypass the pool; class operator delete
+    must be the sized form to route these back correctly.
+
+    The pool is meant to have static storage duration: it has no constructor,
+    so that it is zero-initialized before any dynamic initialization that may
+    already allocate pooled objects.
+
+    When called from inside an OpenMP parallel region, allocations and releases
+    are serialized; single-threaded code takes the unsynchronized path.
+
+ */
+
+template <class OBJECT, unsigned long CHUNK_SIZE = 4096UL, unsigned long MAX_CHUNKS = 256UL>
+class _hyObjectPool {
+
+    union _hyPoolSlot {
+        _hyPoolSlot * next;
+        alignas (OBJECT) unsigned char storage [sizeof (OBJECT)];
+    };
+
+public:
+
+    //__________________________________________________________________________________
+    void * Allocate (size_t size) {
+        if (size != sizeof (OBJECT)) {
+            return ::operator new (size);
+        }
+#ifdef _OPENMP
+        if (omp_in_parallel()) {
+            void * result;
+            #pragma omp critical (_hy_object_pool)
+            result = AllocateSlot ();
+            return result;
+        }
+#endif
+        return AllocateSlot ();
+    }
+
+    //__________________________________________________________________________________
+    void Release (void * p, size_t size) {
+        if (size != sizeof (OBJECT)) {
+            ::operator delete (p);
+            return;
+        }
+#ifdef _OPENMP
+        if (omp_in_parallel()) {
+            #pragma omp critical (_hy_object_pool)
+            ReleaseSlot (p);
+            return;
+        }
+#endif
+        ReleaseSlot (p);
+    }
+
+    //__________________________________________________________________________________
+    _hyObjectPoolStatistics const & Statistics (void) const {
+        return statistics;
+    }
+
+private:
+
+    //__________________________________________________________________________________
+    void * AllocateSlot (void) {
+        statistics.requests++;
+
+        _hyPoolSlot * slot = free_list;
+
+        if (slot) {
+            free_list = slot->next;
+            statistics.recycled++;
+        } else {
+            if (next_unused == chunk_end) {
+                if (chunk_count == MAX_CHUNKS || ! (next_unused = (_hyPoolSlot*)malloc (CHUNK_SIZE * sizeof (_hyPoolSlot)))) {
+                    next_unused = chunk_end;
+                    statistics.overflow++;
+                    heap_objects++;
+                    CountLive ();
+                    return ::operator new (sizeof (OBJECT));
+                }
+                chunks [chunk_count++] = next_unused;
+                chunk_end = next_unused + CHUNK_SIZE;
+                statistics.capacity += CHUNK_SIZE;
+            }
+            slot = next_unused++;
+        }
+
+        CountLive ();
+        return slot;
+    }
+
+    //__________________________________________________________________________________
+    void ReleaseSlot (void * p) {
+        statistics.live--;
+        if (heap_objects && !Owns (p)) {
+            heap_objects--;
+            ::operator delete (p);
+            return;
+        }
+        _hyPoolSlot * slot = (_hyPoolSlot*)p;
+        slot->next = free_list;
+        free_list  = slot;
+    }
+
+    //__________________________________________________________________________________
+    bool Owns (void const * p) const {
+        for (unsigned long i = 0UL; i < chunk_count; i++) {
+            if (p >= chunks[i] && p < chunks[i] + CHUNK_SIZE) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //__________________________________________________________________________________
+    inline void CountLive (void) {
+        if (++statistics.live > statistics.peak) {
+            statistics.peak = statistics.live;
+        }
+    }
+
+    _hyPoolSlot *           free_list,
+                *           next_unused,
+                *           chunk_end,
+                *           chunks [MAX_CHUNKS];
+
+    unsigned long           chunk_count,
+                            heap_objects;
+
+    _hyObjectPoolStatistics statistics;
+};
+
+#endif
@@ -42,6 +42,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //#pragma once
 
 #include "hy_strings.h"
+#include "hy_object_pool.h"
 
 
 #define   HY_STRING_BUFFER_ALLOCATION_CHUNK 16UL
@@ -86,9 +87,11 @@ private:
    */
   void PushChar(const char c);
 
+public:
+
   /** Add a character string to buffer; resize if needed
    
-   @param str: the char* to add to buffer
+   @param str: the char* to add to buffer (need not be 0-terminated)
    @param size: the length of the buffer (no checks performed)
    
    *  Revision history
@@ -96,8 +99,6 @@ private:
    */
   void PushCharBuffer(const char* str, const unsigned long size);
 
-public:
-
   /**
    * A constructor that creates a string buffer of a default size
      (HY_STRING_BUFFER_ALLOCATION_CHUNK)
@@ -339,10 +340,9 @@ public:
     
     /// memory buffering
     void * operator new       (size_t size);
-    void   operator delete    (void * p);
+    void   operator delete    (void * p, size_t size);
 
-    static  _SimpleList                    free_slots;
-    static  unsigned char                  preallocated_buffer[];
+    static  _hyObjectPoolStatistics const & PoolStatistics (void);
 
     
 };
@@ -524,6 +524,12 @@ public:
    */
   hyComparisonType CompareIgnoringCase(_String const &rhs) const;
 
+  /** A 32-bit FNV-1a hash of the string contents, used by hash based
+   lookups of identifiers and dictionary keys; equal strings hash equally
+
+   */
+  unsigned long Hash(void) const;
+
   /** Obvious lexicographic comparisons, mostly making calls to Compare
    *  Revision history
    - SLKP 20170517 reviewed while porting from v3 branch
@@ -1370,6 +1376,22 @@ public:
   static regex_t *PrepRegExp(_String const &pattern, int &error_code,
                              bool case_sensitive, bool throw_errors = false);
 
+  /**
+   * Compile a regular expression through a small LRU cache of recently used
+   expressions, so that a pattern applied over and over is compiled only once
+   * @param pattern the regular expression to compile
+   * @param error_code will receive compilation error codes if any
+   * @param case_sensitive controls whether or not the RE is case sensitive
+   * @return the compiled RE, or NULL if compilation failed (failures are not
+   cached). The RE is owned by the cache: do not FlushRegExp it, and do not
+   keep it past the next call, which may evict it. The cache is not
+   synchronized, so this must not be called from OpenMP parallel regions
+
+   * @sa PrepRegExp
+   */
+  static regex_t const *CachedRegExp(_String const &pattern, int &error_code,
+                                     bool case_sensitive);
+
   /**
    * Free a reg_exp datastructure previously returned by PrepRegExp
    * @param re the (opaque) data structure for the regular expression
@@ -0,0 +1,65 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon42@uwo.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+  
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef _HY_JSON_PARSER_
+#define _HY_JSON_PARSER_
+
+#include "hy_strings.h"
+#include "mathobj.h"
+
+HBLObjectRef ParseJSONText (_String const& text);
+/** Convert a JSON document into HBL objects without going through the
+    expression parser (the ParseJSON builtin).
+
+    objects become dictionaries (repeated keys share one _String instance);
+    arrays of numbers (or of strings) become 1xN matrices, and arrays of
+    equal length arrays of numbers (or of strings) become RxC matrices;
+    any other array becomes a dictionary keyed by "0", "1", ...; true/false
+    become 1/0 and null becomes None.
+
+    The dictionary and matrix notation written by fprintf outside of JSON
+    mode ({{1,2}{3,4}} for matrices; nan and inf for non-finite numbers) is
+    also accepted, so that cache files can be read back.
+
+    @param text the document
+    @return the value (a new object)
+    @throws _String describing the position of malformed input
+ */
+
+#endif
@@ -613,6 +613,10 @@ protected:
     bool            hasBeenOptimized,
                     siteArrayPopulated;
 
+    unsigned long   referenceStamp;
+    // variableChangeStamp at the start of the last completed Compute; constraints (re)set
+    // after this stamp are treated as changed when nodes are (re)computed
+
     _Formula*       computingTemplate;
     MSTCache*       mstCache;
 
@@ -44,6 +44,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "avllistx.h"
 #include "variablecontainer.h"
 #include "trie.h"
+#include "string_file_wrapper.h"
 
 #define     _POLYNOMIAL_TYPE 0
 #define     _NUMERICAL_TYPE  1
@@ -386,6 +387,9 @@ public:
 
     virtual     void        toFileStr   (FILE*dest, unsigned long = 0UL);
 
+    void        SerializeTo             (StringFileWrapper&, unsigned long padding = 0UL);
+    /* write the toStr representation of the matrix directly to a string buffer or a file */
+
     bool        AmISparse               (void);
 
     hyFloat  ExpNumberOfSubs         (_Matrix*,bool);
@@ -603,7 +607,6 @@ public:
 
 private:
 
-    void     internal_to_str (_StringBuffer*, FILE*, unsigned long padding);
     void     SetupSparseMatrixAllocations (void);
     bool     is_square_numeric   (bool dense = true) const;
     
@@ -0,0 +1,59 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon42@uwo.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+  
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef _HY_NUMBER_FORMAT_
+#define _HY_NUMBER_FORMAT_
+
+// enough room for any output of ShortestDoubleToChars, including the terminating 0
+const unsigned long kShortestDoubleLength = 32UL;
+
+unsigned long ShortestDoubleToChars (double value, char * buffer);
+/** Write a decimal representation of 'value' that reads back (strtod) as
+    exactly the same double, using as few digits as possible (Grisu3; the
+    rare values it cannot prove shortest go through printf); the layout follows %g:
+    exponential notation for decimal exponents below -4 or above 16.
+    Non-finite values are written as nan, inf and -inf.
+
+    @param value the number to write
+    @param buffer receives the characters and a terminating 0
+                  (at least kShortestDoubleLength long)
+    @return the number of characters written (excluding the terminating 0)
+ */
+
+#endif
@@ -94,6 +94,7 @@ public:
 
     bool            Execute             (_Stack&, _VariableContainer const* = nil, _String* errMsg = nil); //execute this operation
     // see the commend for _Formula::ExecuteFormula for the second argument
+    bool            ExecuteScalar       (_Stack&); // numeric fast path for Execute; returns false if not applicable
     virtual   void          StackDepth          (long&);
 
     bool            ExecutePolynomial   (_Stack&,_VariableContainer* nameSpace = nil, _String* errMsg = nil);
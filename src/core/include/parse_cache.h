@@ -0,0 +1,101 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon42@uwo.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+  
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef _HY_PARSE_CACHE_
+#define _HY_PARSE_CACHE_
+
+class _String;
+class _List;
+
+/**
+    An on-disk cache of the statements that batch files are split into
+    (enabled by setting PARSE_CACHE_DIRECTORY, or with PARSECACHE=path on the command line).
+
+    Most of the time spent reading a batch file goes to scanning its text into
+    statements (_ElementaryCommand::FindNextCommand). While a file is being parsed into
+    an execution list, every text passed to _ExecutionList::BuildList (the file itself,
+    namespace bodies, blocks, and function bodies parsed at definition time) is recorded
+    together with the statements it was split into. These are written to a cache file in the
+    cache directory, named after the batch file and the directory it is in
+    ("name.bf._path_to_directory.hbc").
+
+    The next time the same file is read, its cache file is used only if it has the same
+    format version, HyPhy version, source path, modification time and size. Texts are looked
+    up by their length and a 64-bit hash, and a cached entry is used only if its recorded text
+    is identical to the text being parsed; BuildList then iterates over the cached statements
+    instead of scanning the text. Everything else (function registration, #include, formula
+    parsing) is done as usual, because it has side effects and depends on the state of the program.
+
+    A cache file is (re)written, atomically, only when a file was parsed without errors and
+    some of its statements had to be scanned. Files which can not be read or written
+    are silently ignored.
+ */
+
+struct _hyParseCacheKey {
+    unsigned long   hash,
+                    length;
+    bool            active;   // true if a cache file session is open
+};
+
+bool            ParseCacheBeginFile (_String const & path);
+/** Start a cache session for the batch file at 'path' (if the cache is enabled),
+    loading the cache file for 'path' if it is valid for the current version of the file.
+
+    @return true if a session was started; it must be closed with ParseCacheEndFile
+ */
+
+void            ParseCacheEndFile   (bool success);
+/** Close the innermost cache session; write its cache file if 'success' and some
+    statements were not found in the cache.
+ */
+
+_List const *   ParseCacheLookup    (_String const & text, _hyParseCacheKey & key);
+/** Look up the statements 'text' is split into in the innermost cache session.
+
+    @param key receives the key of 'text' (key.active is false if there is no session)
+    @return the statements or nil if they are not cached
+ */
+
+void            ParseCacheStore     (_hyParseCacheKey const & key, _String * text, _List * statements);
+/** Record the statements that 'text' (which has 'key') was split into, in the innermost
+    cache session. Both 'text' (an unchanged copy of the text passed to ParseCacheLookup)
+    and the list are owned by the cache.
+ */
+
+#endif
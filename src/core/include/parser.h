@@ -196,8 +196,14 @@ hyFloat  AbsNumber   (hyFloat);
 hyFloat  MinusNumber (hyFloat);
 hyFloat  MaxNumbers  (hyFloat, hyFloat);
 hyFloat  MinNumbers  (hyFloat, hyFloat);
+hyFloat  IntDivNumbers (hyFloat, hyFloat);
+hyFloat  ModNumbers  (hyFloat, hyFloat);
 hyFloat  FastMxAccess(hyPointer, hyFloat);
 void        FastMxWrite (hyPointer, hyFloat, hyFloat);
+hyFloat  FastMxAccess2D (hyPointer, hyFloat, hyFloat);
+void        FastMxWrite2D  (hyPointer, hyFloat, hyFloat, hyFloat);
+hyFloat  FastDictAccess (hyPointer, hyPointer);
+void        FastDictWrite  (hyPointer, hyPointer, hyFloat);
 
 BaseRef parameterToString       (hyFloat);
 void    parameterToCharBuffer   (hyFloat, char*, long, bool json = false);
@@ -208,7 +214,7 @@ hyFloat  TrapezoidLevelKSimple   (_Formula&, _Variable*, hyFloat, hyFloat, long,
 
 
 void        PopulateArraysForASimpleFormula
-(_SimpleList&, _SimpleFormulaDatum*);
+(_SimpleList&, _SimpleFormulaDatum*, _SimpleList const * containers = nil, _SimpleList const * checked = nil, bool * checked_numeric = nil);
 
 void        WarnNotDefined (HBLObjectRef, long, _hyExecutionContext* );
 void        WarnWrongNumberOfArguments (HBLObjectRef, long, _hyExecutionContext*, _List *);
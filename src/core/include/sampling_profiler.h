@@ -0,0 +1,109 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon42@uwo.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+  
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef _HY_SAMPLING_PROFILER_
+#define _HY_SAMPLING_PROFILER_
+
+class _ExecutionList;
+class _String;
+
+/**
+    A statistical profiler for HBL code (enabled with PROFILE=path on the command line).
+
+    Every millisecond of CPU time (ITIMER_PROF / SIGPROF), the signal handler records
+    the current HBL call stack -- one frame per executing _ExecutionList, labeled with
+    the function name (or file name) and the 1-based index of the statement being executed --
+    interleaved with the native phases (see _hyProfilerPhaseID) that the main thread entered,
+    each placed after the frame that was innermost when the phase was entered.
+    Identical stacks are counted in a table preallocated when the profiler is started,
+    so that the handler does not allocate memory.
+
+    At shutdown, the counts are written to 'path' in the collapsed stack format
+    understood by flame graph tools, e.g.
+
+        SLAC.bf:112;estimators.FitLF (estimators.bf):53;[optimizer];[likelihood];[prune] 2110
+        SLAC.bf:140;[optimizer];objective (SLAC.bf):4 35
+
+    Frames are pushed and popped by _ExecutionList::Execute and phases by
+    _hyProfilerPhase guards; both are no-ops unless the profiler is running.
+    Only available on UNIX systems.
+ */
+
+enum _hyProfilerPhaseID {
+    kProfilerPhaseOptimizer     = 0,  // _LikelihoodFunction::Optimize
+    kProfilerPhaseLikelihood    = 1,  // _LikelihoodFunction::Compute
+    kProfilerPhaseExponentiate  = 2,  // _TheTree::ExponentiateMatrices
+    kProfilerPhasePrune         = 3,  // tree pruning in _LikelihoodFunction::ComputeBlock
+    kProfilerPhaseIO            = 4,  // reading data files, fprintf / fscanf
+    kProfilerPhaseCount         = 5
+};
+
+extern  bool    hy_sampling_profiler_active;
+
+bool    StartSamplingProfiler       (_String const & path);
+        // returns false if the profiler could not be started (or is not supported on this platform)
+
+void    StopSamplingProfiler        (void);
+        // stop sampling and write collected stacks to the file given to StartSamplingProfiler
+
+long    SamplingProfilerEnter       (_ExecutionList*);
+void    SamplingProfilerLeave       (long);
+        // Enter returns the frame depth to pass to Leave when the execution list returns
+
+long    SamplingProfilerPushPhase   (_hyProfilerPhaseID);
+void    SamplingProfilerPopPhase    (long);
+
+//____________________________________________________________________________________
+
+class _hyProfilerPhase {
+    /** mark the enclosing scope as a native phase for the sampling profiler */
+public:
+    _hyProfilerPhase (_hyProfilerPhaseID phase, bool condition = true) {
+        depth = hy_sampling_profiler_active && condition ? SamplingProfilerPushPhase (phase) : -1L;
+    }
+    ~_hyProfilerPhase (void) {
+        if (depth >= 0L) {
+            SamplingProfilerPopPhase (depth);
+        }
+    }
+private:
+    long depth;
+};
+
+#endif
@@ -62,7 +62,12 @@ struct FileState {
   int fileType, baseLength;
   char repeat, skip;
 
-  _String *theSource, *theNamespace;
+  _String *theNamespace;
+
+  // in-memory input (a string, or the contents of a mapped data file);
+  // nil when reading directly from a FILE*
+  const char *theSource;
+  long sourceLength;
 
   _SimpleList rawLinesFormat;
 
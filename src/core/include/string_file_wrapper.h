@@ -54,6 +54,8 @@ enum StringFileWrapperConstants {
 class StringFileWrapper {
   /** This is a simple convenience flag that unifies << operations
     *  when the LHS is either a _String, or a FILE*
+    *  Writes to a FILE* are collected in a buffer and passed on in large blocks
+    *  (when the buffer fills up, on Flush, and when the wrapper goes out of scope)
    */
 public:
   
@@ -69,7 +71,22 @@ public:
    
    */
   
-  ~StringFileWrapper () {}
+  ~StringFileWrapper ();
+  
+  StringFileWrapper (StringFileWrapper const &) = delete;
+  StringFileWrapper & operator = (StringFileWrapper const &) = delete;
+  
+  void Flush (void);
+  /** Pass the buffered characters on to the FILE* (if any)
+   */
+  
+  StringFileWrapper & Write (const char* buffer, unsigned long length);
+  /** Write 'length' characters to the underlying buffer
+   
+   @param buffer the characters to write
+   @param length how many characters to write
+   @return this for chaining
+   */
   
   StringFileWrapper & operator << (const char* buffer);
   /** Write a literal string to the underlying buffer 
@@ -107,8 +124,12 @@ public:
    */
   
 private:
+  static const unsigned long kFileCacheSize = 65536UL;
+  
   _StringBuffer * string_buffer;
   FILE*     file_buffer;
+  char *    file_cache;
+  unsigned long file_cache_used;
   
 };
 
@@ -47,6 +47,29 @@
 #include "operation.h"
 #include "formula.h"
 
+extern unsigned long variableChangeStamp;
+// incremented whenever the value, constraint or change flag of any variable is modified,
+// or a slot in variablePtrs is replaced; a dependent variable whose memoized HasChanged
+// result carries the current stamp does not need to re-scan its formula
+
+extern unsigned long variableReferenceStamp;
+// the variableChangeStamp at which the current consumer of dependent variables (a likelihood function,
+// or a dependent variable recomputing its value) last used them; a constrained variable whose formula was
+// (re)set after this stamp reports itself as changed. ULONG_MAX (the default) outside such a consumer.
+// Set with _hyVariableReferenceStamp.
+
+extern unsigned long variableSlotStamp;
+// incremented whenever the mapping from variable names to slots in variablePtrs changes
+// in a way that can invalidate a previously resolved index:
+//   - a slot is freed (DeleteVariable, ClearAll / PurgeAll), so that it can be reused by another variable;
+//   - a variable name is re-pointed at a different slot: reference arguments of HBL functions
+//     are bound on entry and restored on exit, and RenameVariables moves names.
+// Creating a variable, or changing its value, type, constraint or namespace contents does NOT
+// change the stamp: formulas refer to variables by slot index, and those indices stay valid.
+// Anything that caches resolved variable indices across executions (the execution list reused by
+// ExecuteCommands, see _HBLCompiledSource; the storage slots of commands; the argument slots of
+// HBL functions) must resolve them again when the stamp differs from the one they were resolved under.
+
 
 class _Variable : public _Constant {
 
@@ -136,7 +159,7 @@ public:
     virtual     void        ClearConstraints    (void);
     virtual     bool        CheckFForDependence (long, bool = false);
     virtual     bool        HasBeenInitialized (void) const {return !(varFlags & HY_VARIABLE_NOTSET);}
-    virtual     void        MarkModified  (void) {varFlags = varFlags | HY_VARIABLE_CHANGED;}
+    virtual     void        MarkModified  (void) {varFlags = varFlags | HY_VARIABLE_CHANGED; variableChangeStamp++;}
 
     _String const     ContextFreeName                 (void) const;
     _String const    ParentObjectName                 (void) const;
@@ -174,6 +197,35 @@ public:
 
     _Formula*  varFormula;
 
+protected:
+
+    unsigned long changeCheckStamp [2],
+                  changeCheckReference [2];
+    bool          changeCheckResult [2];
+    // memoized result of varFormula->HasChanged (ignoreCats = false/true),
+    // valid while changeCheckStamp matches variableChangeStamp
+    // and changeCheckReference matches variableReferenceStamp
+
+    unsigned long formulaStamp,
+                  valueStamp;
+    // the variableChangeStamp when varFormula was last set, and when varValue was last recomputed from it
+
+};
+
+//__________________________________________________________________________________
+
+class _hyVariableReferenceStamp {
+    /** set variableReferenceStamp for the enclosing scope */
+public:
+    _hyVariableReferenceStamp (unsigned long stamp) {
+        saved = variableReferenceStamp;
+        variableReferenceStamp = stamp;
+    }
+    ~_hyVariableReferenceStamp (void) {
+        variableReferenceStamp = saved;
+    }
+private:
+    unsigned long saved;
 };
 
 long    DereferenceVariable (long index, _MathObject const *  context, char reference_type);
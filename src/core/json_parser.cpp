@@ -0,0 +1,804 @@
+/*
+ 
+ HyPhy - Hypothesis Testing Using Phylogenies.
+ 
+ Copyright (C) 1997-now
+ Core Developers:
+ Sergei L Kosakovsky Pond (sergeilkp@icloud.com)
+ Art FY Poon    (apoon42@uwo.ca)
+ Steven Weaver (sweaver@temple.edu)
+ 
+ Module Developers:
+ Lance Hepler (nlhepler@gmail.com)
+ Martin Smith (martin.audacis@gmail.com)
+ 
+ Significant contributions from:
+ Spencer V Muse (muse@stat.ncsu.edu)
+ Simon DW Frost (sdf22@cam.ac.uk)
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utility>
+
+#include "json_parser.h"
+#include "associative_list.h"
+#include "constant.h"
+#include "formula.h"
+#include "fstring.h"
+#include "global_things.h"
+#include "matrix.h"
+
+using namespace hy_global;
+
+/*
+    A single pass recursive descent reader. Numbers are converted without
+    strtod when the decimal significand and exponent are small enough for a
+    single exact multiplication or division (which is then correctly
+    rounded); array cells are collected as raw numbers or strings, so that
+    homogeneous arrays go straight into matrices without creating an object
+    per cell.
+*/
+
+namespace {
+
+  const long          kMaxNestingDepth = 4096L;
+
+  const unsigned long long kMaxExactSignificand = 1ULL << 53;
+
+  const hyFloat       kExactPowersOf10 [] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+#if LDBL_MANT_DIG >= 64
+  // powers of ten that are exact in extended precision (5^27 < 2^64)
+  const long double   kExactExtendedPowersOf10 [] = {1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,
+                                                     1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L,
+                                                     1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L,
+                                                     1e24L, 1e25L, 1e26L, 1e27L};
+#endif
+
+  class _JSONParser;
+
+  //_____________________________________________________________________________________________
+
+  /* the cells of an array being read; numbers and strings are stored as is
+     while all cells have the same type, otherwise every cell becomes an HBL
+     object */
+
+  class _JSONCells {
+    public:
+      enum {
+        kCellsEmpty,
+        kCellsNumeric,
+        kCellsString,
+        kCellsMixed
+      };
+
+      _JSONCells (void) : kind (kCellsEmpty), numbers (nil), count (0UL), capacity (0UL) {}
+      ~_JSONCells (void) {
+        if (numbers) {
+          free (numbers);
+        }
+      }
+
+      int           Kind  (void) const { return kind; }
+      unsigned long Count (void) const { return count; }
+
+      void AppendNumber (hyFloat value) {
+        if (kind == kCellsEmpty) {
+          kind = kCellsNumeric;
+        } else if (kind != kCellsNumeric) {
+          AppendValue (new _Constant (value));
+          return;
+        }
+        if (count == capacity) {
+          capacity = capacity ? capacity << 1 : 16UL;
+          numbers  = (hyFloat*)(numbers ? MemReallocate ((hyPointer)numbers, capacity * sizeof (hyFloat)) : MemAllocate (capacity * sizeof (hyFloat)));
+        }
+        numbers [count++] = value;
+      }
+
+      void AppendString (_String * value) {
+        // takes ownership of 'value'
+        if (kind == kCellsEmpty) {
+          kind = kCellsString;
+        } else if (kind != kCellsString) {
+          AppendValue (new _FString (value));
+          return;
+        }
+        cells.AppendNewInstance (value);
+        count++;
+      }
+
+      void AppendValue (HBLObjectRef value) {
+        // takes ownership of 'value'
+        if (kind != kCellsMixed) {
+          MakeMixed ();
+        }
+        cells.AppendNewInstance (value);
+        count++;
+      }
+
+      void AppendRow (_JSONCells & row) {
+        // 'row' is of the same (numeric or string) kind
+        if (row.kind == kCellsNumeric) {
+          for (unsigned long k = 0UL; k < row.count; k++) {
+            AppendNumber (row.numbers[k]);
+          }
+        } else {
+          kind   = kCellsString;
+          cells << row.cells;
+          count += row.count;
+        }
+      }
+
+      HBLObjectRef ToObject (unsigned long from, unsigned long rows, unsigned long columns, _JSONParser & parser) const;
+      /* cells [from, from + rows*columns) as a rows x columns matrix, or,
+         for mixed cells, as a dictionary keyed by the cell index */
+
+    private:
+
+      void MakeMixed (void) {
+        if (kind == kCellsNumeric) {
+          for (unsigned long k = 0UL; k < count; k++) {
+            cells.AppendNewInstance (new _Constant (numbers[k]));
+          }
+        } else if (kind == kCellsString) {
+          for (unsigned long k = 0UL; k < count; k++) {
+            _String * value = (_String*)cells.GetItem (k);
+            value->AddAReference();
+            cells.Replace (k, new _FString (value), false);
+          }
+        }
+        kind = kCellsMixed;
+      }
+
+      int           kind;
+      hyFloat     * numbers;
+      unsigned long count,
+                    capacity;
+      _List         cells;
+  };
+
+  //_____________________________________________________________________________________________
+
+  class _JSONParser {
+    public:
+      _JSONParser (_String const & text) : source (text), text (text.get_str()), length (text.length()), position (0UL), depth (0L), interned_count (0UL) {}
+
+      HBLObjectRef ParseDocument (void) {
+        if (length >= 3UL && (unsigned char)text[0] == 0xEF && (unsigned char)text[1] == 0xBB && (unsigned char)text[2] == 0xBF) {
+          position = 3UL; // UTF-8 byte order mark
+        }
+        HBLObjectRef value = ParseValue ();
+        SkipSpace ();
+        if (position < length) {
+          DeleteObject (value);
+          Fail ("the end of input");
+        }
+        return value;
+      }
+
+      _String * IndexKey (unsigned long index) {
+        _String key ((long)index);
+        return Intern (key.get_str(), key.length());
+      }
+
+    private:
+
+      HBLObjectRef ParseValue   (void);
+      HBLObjectRef ParseObject  (void);
+      HBLObjectRef ParseArray   (char closing);
+      void         ReadCells    (char closing, _JSONCells & cells);
+      hyFloat      ParseNumber  (void);
+      _String    * ParseString  (bool intern);
+      _String    * Intern       (const char * characters, unsigned long count);
+
+      void SkipSpace (void) {
+        while (position < length) {
+          switch (text[position]) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+              position++;
+              continue;
+          }
+          break;
+        }
+      }
+
+      bool StartsNumber (void) const {
+        char c = text[position];
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'i' || c == 'I' || c == 'N' || (c == 'n' && text[position+1] == 'a');
+      }
+
+      bool MatchWord (const char * word) {
+        unsigned long word_length = strlen (word);
+        if (strncmp (text + position, word, word_length) == 0) {
+          char next = text[position + word_length];
+          if (!((next >= 'a' && next <= 'z') || (next >= 'A' && next <= 'Z') || (next >= '0' && next <= '9') || next == '_')) {
+            position += word_length;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void EnterContainer (void) {
+        if (++depth > kMaxNestingDepth) {
+          Fail ("fewer levels of nesting");
+        }
+      }
+
+      void Fail (const char * expected) const {
+        unsigned long line = 1UL, column = 1UL;
+        for (unsigned long k = 0UL; k < position && k < length; k++) {
+          if (text[k] == '\n') {
+            line++;
+            column = 1UL;
+          } else {
+            column++;
+          }
+        }
+        _String context (source, position, position + 31L);
+        throw _String ("Expected ") & expected & " at line " & _String ((long)line) & ", column " & _String ((long)column) & (position < length ? _String (" (near '") & context & "')" : _String (" (at the end of input)"));
+      }
+
+      _String const & source;
+      const char    * text;
+      unsigned long   length,
+                      position;
+      long            depth;
+
+      _List           interned;
+      _SimpleList     interned_index;
+      unsigned long   interned_count;
+  };
+
+  //_____________________________________________________________________________________________
+
+  HBLObjectRef _JSONCells::ToObject (unsigned long from, unsigned long rows, unsigned long columns, _JSONParser & parser) const {
+    switch (kind) {
+      case kCellsNumeric:
+        return new _Matrix (numbers + from, rows, columns);
+      case kCellsString: {
+        _Matrix * strings = new _Matrix;
+        _Matrix::CreateMatrix (strings, rows, columns, false, true, false);
+        strings->Convert2Formulas ();
+        for (unsigned long r = 0UL; r < rows; r++) {
+          for (unsigned long c = 0UL; c < columns; c++) {
+            _String * value = (_String*)cells.GetItem (from++);
+            value->AddAReference();
+            strings->StoreFormula (r, c, *new _Formula (new _FString (value)), false, false);
+          }
+        }
+        return strings;
+      }
+      case kCellsMixed: {
+        _AssociativeList * list = new _AssociativeList;
+        for (unsigned long k = 0UL; k < count; k++) {
+          _String * key = parser.IndexKey (k);
+          HBLObjectRef value = (HBLObjectRef)cells.GetItem (k);
+          key->AddAReference();
+          value->AddAReference();
+          list->MStore (key, value, false);
+        }
+        return list;
+      }
+    }
+    return new _Matrix;
+  }
+
+  //_____________________________________________________________________________________________
+
+  HBLObjectRef _JSONParser::ParseValue (void) {
+    SkipSpace ();
+
+    switch (text[position]) {
+      case '{': {
+        position++;
+        EnterContainer ();
+        SkipSpace ();
+        // {{...}{...}} is a matrix written outside of JSON mode
+        HBLObjectRef value = text[position] == '{' ? ParseArray ('}') : ParseObject ();
+        depth--;
+        return value;
+      }
+      case '[': {
+        position++;
+        EnterContainer ();
+        HBLObjectRef value = ParseArray (']');
+        depth--;
+        return value;
+      }
+      case '"':
+        return new _FString (ParseString (false));
+      case 't':
+        if (MatchWord ("true")) {
+          return new _Constant (1.);
+        }
+        break;
+      case 'f':
+        if (MatchWord ("false")) {
+          return new _Constant (0.);
+        }
+        break;
+      case 'n':
+        if (MatchWord ("null")) {
+          return new _MathObject;
+        }
+        break;
+    }
+
+    if (StartsNumber ()) {
+      return new _Constant (ParseNumber ());
+    }
+
+    Fail ("a value");
+    return nil;
+  }
+
+  //_____________________________________________________________________________________________
+
+  HBLObjectRef _JSONParser::ParseObject (void) {
+    // the opening brace has been consumed
+    _AssociativeList * object = new _AssociativeList;
+
+    try {
+      SkipSpace ();
+      if (text[position] == '}') {
+        position++;
+        return object;
+      }
+
+      while (true) {
+        SkipSpace ();
+        if (text[position] != '"') {
+          Fail ("a quoted key");
+        }
+        _String * key = ParseString (true);
+        SkipSpace ();
+        if (text[position] != ':') {
+          Fail ("':'");
+        }
+        position++;
+        HBLObjectRef value = ParseValue ();
+        key->AddAReference();
+        if (!object->MStore (key, value, false)) {
+          key->RemoveAReference(); // a repeated key; the value was replaced
+        }
+        SkipSpace ();
+        if (text[position] == ',') {
+          position++;
+        } else if (text[position] == '}') {
+          position++;
+          return object;
+        } else {
+          Fail ("',' or '}'");
+        }
+      }
+    } catch (_String const &) {
+      DeleteObject (object);
+      throw;
+    }
+    return object;
+  }
+
+  //_____________________________________________________________________________________________
+
+  HBLObjectRef _JSONParser::ParseArray (char closing) {
+    // the opening bracket has been consumed; rows of HBL matrices are
+    // enclosed in braces and need not be separated by commas
+
+    SkipSpace ();
+    if (text[position] == closing) {
+      position++;
+      return new _Matrix;
+    }
+
+    if (text[position] != closing - 2) { // '[' for ']' and '{' for '}'
+      _JSONCells cells;
+      ReadCells (closing, cells);
+      return cells.ToObject (0UL, 1UL, cells.Count(), *this);
+    }
+
+    // an array of arrays: stack the rows into a matrix for as long as they
+    // are numeric (or string) and of the same length
+
+    _JSONCells    table,
+                  items;
+    unsigned long rows    = 0UL,
+                  columns = 0UL;
+    bool          stacked = true;
+
+    while (true) {
+      SkipSpace ();
+      if (stacked && text[position] == closing - 2) {
+        position++;
+        EnterContainer ();
+        _JSONCells row;
+        ReadCells (closing, row);
+        depth--;
+        if ((row.Kind () == _JSONCells::kCellsNumeric || row.Kind () == _JSONCells::kCellsString) && (rows == 0UL || (row.Kind () == table.Kind () && row.Count () == columns))) {
+          columns = row.Count ();
+          table.AppendRow (row);
+          rows++;
+        } else {
+          for (unsigned long r = 0UL; r < rows; r++) {
+            items.AppendValue (table.ToObject (r * columns, 1UL, columns, *this));
+          }
+          items.AppendValue (row.ToObject (0UL, 1UL, row.Count (), *this));
+          stacked = false;
+        }
+      } else {
+        if (stacked) {
+          for (unsigned long r = 0UL; r < rows; r++) {
+            items.AppendValue (table.ToObject (r * columns, 1UL, columns, *this));
+          }
+          stacked = false;
+        }
+        items.AppendValue (ParseValue ());
+      }
+
+      SkipSpace ();
+      if (text[position] == ',') {
+        position++;
+      } else if (text[position] == closing) {
+        position++;
+        break;
+      } else if (closing != '}' || text[position] != '{') {
+        Fail (closing == '}' ? "',' or '}'" : "',' or ']'");
+      }
+    }
+
+    return stacked ? table.ToObject (0UL, rows, columns, *this) : items.ToObject (0UL, 1UL, items.Count (), *this);
+  }
+
+  //_____________________________________________________________________________________________
+
+  void _JSONParser::ReadCells (char closing, _JSONCells & cells) {
+    // the opening bracket has been consumed
+    SkipSpace ();
+    if (text[position] == closing) {
+      position++;
+      return;
+    }
+
+    while (true) {
+      SkipSpace ();
+      char c = text[position];
+      if (c == '"') {
+        cells.AppendString (ParseString (false));
+      } else if (c == 't' && MatchWord ("true")) {
+        cells.AppendNumber (1.);
+      } else if (c == 'f' && MatchWord ("false")) {
+        cells.AppendNumber (0.);
+      } else if (c == 'n' && MatchWord ("null")) {
+        cells.AppendValue (new _MathObject);
+      } else if (StartsNumber ()) {
+        cells.AppendNumber (ParseNumber ());
+      } else {
+        cells.AppendValue (ParseValue ());
+      }
+
+      SkipSpace ();
+      if (text[position] == ',') {
+        position++;
+      } else if (text[position] == closing) {
+        position++;
+        return;
+      } else {
+        Fail (closing == '}' ? "',' or '}'" : "',' or ']'");
+      }
+    }
+  }
+
+  //_____________________________________________________________________________________________
+
+  hyFloat _JSONParser::ParseNumber (void) {
+    unsigned long start    = position;
+    bool          negative = false;
+
+    if (text[position] == '-') {
+      negative = true;
+      position++;
+    } else if (text[position] == '+') {
+      position++;
+    }
+
+    char c = text[position];
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+      hyFloat special;
+      if (MatchWord ("nan") || MatchWord ("NaN")) {
+        special = NAN;
+      } else if (MatchWord ("inf") || MatchWord ("Infinity") || MatchWord ("infinity")) {
+        special = INFINITY;
+      } else {
+        Fail ("a number");
+      }
+      return negative ? -special : special;
+    }
+
+    unsigned long long significand = 0ULL;
+    long               digits      = 0L,   // significant digits in 'significand'
+                       exponent    = 0L;
+    bool               any_digits  = false,
+                       truncated   = false;
+
+    for (; text[position] >= '0' && text[position] <= '9'; position++) {
+      any_digits = true;
+      if (digits < 19L) {
+        significand = significand * 10ULL + (text[position] - '0');
+        if (significand) {
+          digits++;
+        }
+      } else {
+        exponent++;
+        truncated = truncated || text[position] != '0';
+      }
+    }
+
+    if (text[position] == '.') {
+      position++;
+      for (; text[position] >= '0' && text[position] <= '9'; position++) {
+        any_digits = true;
+        if (digits < 19L) {
+          significand = significand * 10ULL + (text[position] - '0');
+          if (significand) {
+            digits++;
+          }
+          exponent--;
+        } else {
+          truncated = truncated || text[position] != '0';
+        }
+      }
+    }
+
+    if (!any_digits) {
+      position = start;
+      Fail ("a number");
+    }
+
+    if (text[position] == 'e' || text[position] == 'E') {
+      position++;
+      bool negative_exponent = false;
+      if (text[position] == '-') {
+        negative_exponent = true;
+        position++;
+      } else if (text[position] == '+') {
+        position++;
+      }
+      if (text[position] < '0' || text[position] > '9') {
+        Fail ("the digits of an exponent");
+      }
+      long explicit_exponent = 0L;
+      for (; text[position] >= '0' && text[position] <= '9'; position++) {
+        if (explicit_exponent < 100000L) {
+          explicit_exponent = explicit_exponent * 10L + (text[position] - '0');
+        }
+      }
+      exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (!truncated && significand <= kMaxExactSignificand && exponent >= -22L && exponent <= 22L) {
+      hyFloat value = exponent < 0L ? (hyFloat)significand / kExactPowersOf10[-exponent]
+                                    : (hyFloat)significand * kExactPowersOf10[exponent];
+      return negative ? -value : value;
+    }
+
+#if LDBL_MANT_DIG >= 64
+    /* up to 19 significant digits (doubles are usually written with 16 or
+       17): the correctly rounded extended precision product (or quotient)
+       also rounds to the correctly rounded double, unless it lies exactly
+       halfway between two doubles */
+    if (!truncated && exponent >= -27L && exponent <= 27L) {
+      long double extended = exponent < 0L ? (long double)significand / kExactExtendedPowersOf10[-exponent]
+                                           : (long double)significand * kExactExtendedPowersOf10[exponent];
+      int         binary_exponent;
+      long double scaled = ldexpl (frexpl (extended, &binary_exponent), DBL_MANT_DIG);
+      if (scaled - floorl (scaled) != 0.5L) {
+        hyFloat value = (hyFloat)extended;
+        return negative ? -value : value;
+      }
+    }
+#endif
+
+    return strtod (text + start, nil);
+  }
+
+  //_____________________________________________________________________________________________
+
+  _String * _JSONParser::ParseString (bool intern) {
+    // at the opening quote
+    unsigned long start = ++position;
+
+    while (true) {
+      char c = text[position];
+      if (c == '"') {
+        position++;
+        return intern ? Intern (text + start, position - start - 1UL) : new _String (source, start, (long)position - 2L);
+      }
+      if (c == '\\') {
+        break;
+      }
+      if (position >= length) {
+        Fail ("a closing '\"'");
+      }
+      position++;
+    }
+
+    _StringBuffer decoded (position - start + 16UL);
+    decoded.PushCharBuffer (text + start, position - start);
+
+    while (true) {
+      char c = text[position];
+      if (c == '"') {
+        position++;
+        break;
+      }
+      if (position >= length) {
+        Fail ("a closing '\"'");
+      }
+      position++;
+      if (c != '\\') {
+        decoded << c;
+        continue;
+      }
+
+      c = text[position++];
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          decoded << c;
+          break;
+        case 'b':
+          decoded << '\b';
+          break;
+        case 'f':
+          decoded << '\f';
+          break;
+        case 'n':
+          decoded << '\n';
+          break;
+        case 'r':
+          decoded << '\r';
+          break;
+        case 't':
+          decoded << '\t';
+          break;
+        case 'u': {
+          auto read_code_unit = [this] (void) -> unsigned long {
+            unsigned long code_unit = 0UL;
+            for (int k = 0; k < 4; k++, position++) {
+              char h = text[position];
+              code_unit <<= 4;
+              if (h >= '0' && h <= '9') {
+                code_unit += h - '0';
+              } else if (h >= 'a' && h <= 'f') {
+                code_unit += h - 'a' + 10;
+              } else if (h >= 'A' && h <= 'F') {
+                code_unit += h - 'A' + 10;
+              } else {
+                Fail ("four hexadecimal digits");
+              }
+            }
+            return code_unit;
+          };
+
+          unsigned long code_point = read_code_unit ();
+          if (code_point >= 0xD800UL && code_point < 0xDC00UL && text[position] == '\\' && text[position+1] == 'u') {
+            position += 2UL;
+            unsigned long low_surrogate = read_code_unit ();
+            if (low_surrogate >= 0xDC00UL && low_surrogate < 0xE000UL) {
+              code_point = 0x10000UL + ((code_point - 0xD800UL) << 10) + (low_surrogate - 0xDC00UL);
+            } else {
+              position -= 6UL;
+            }
+          }
+
+          // UTF-8 encoding
+          if (code_point < 0x80UL) {
+            decoded << (char)code_point;
+          } else if (code_point < 0x800UL) {
+            decoded << (char)(0xC0UL | (code_point >> 6))
+                    << (char)(0x80UL | (code_point & 0x3FUL));
+          } else if (code_point < 0x10000UL) {
+            decoded << (char)(0xE0UL | (code_point >> 12))
+                    << (char)(0x80UL | ((code_point >> 6) & 0x3FUL))
+                    << (char)(0x80UL | (code_point & 0x3FUL));
+          } else {
+            decoded << (char)(0xF0UL | (code_point >> 18))
+                    << (char)(0x80UL | ((code_point >> 12) & 0x3FUL))
+                    << (char)(0x80UL | ((code_point >> 6) & 0x3FUL))
+                    << (char)(0x80UL | (code_point & 0x3FUL));
+          }
+          break;
+        }
+        default:
+          position--;
+          Fail ("a valid escape sequence");
+      }
+    }
+
+    if (intern) {
+      return Intern (decoded.get_str(), decoded.length());
+    }
+    return new _String (std::move (decoded));
+  }
+
+  //_____________________________________________________________________________________________
+
+  _String * _JSONParser::Intern (const char * characters, unsigned long count) {
+    // keys that occur repeatedly in a document are stored once; the hash
+    // function is that of _String::Hash
+
+    unsigned long hash = 2166136261UL;
+    for (unsigned long k = 0UL; k < count; k++) {
+      hash = ((hash ^ (unsigned char)characters[k]) * 16777619UL) & 0xffffffffUL;
+    }
+
+    if ((interned_count + 1UL) * 2UL > interned_index.lLength) {
+      unsigned long capacity = interned_index.lLength ? interned_index.lLength << 1 : 64UL,
+                    mask     = capacity - 1UL;
+      interned_index.Populate (capacity, -1L, 0L);
+      for (unsigned long k = 0UL; k < interned.lLength; k++) {
+        unsigned long i = ((_String const*)interned.GetItem (k))->Hash () & mask;
+        while (interned_index.list_data[i] >= 0L) {
+          i = (i + 1UL) & mask;
+        }
+        interned_index.list_data[i] = k;
+      }
+    }
+
+    unsigned long mask = interned_index.lLength - 1UL,
+                  i    = hash & mask;
+
+    while (interned_index.list_data[i] >= 0L) {
+      _String * key = (_String*)interned.GetItem (interned_index.list_data[i]);
+      if (key->length () == count && memcmp (key->get_str (), characters, count) == 0) {
+        return key;
+      }
+      i = (i + 1UL) & mask;
+    }
+
+    _StringBuffer * key = new _StringBuffer (count);
+    key->PushCharBuffer (characters, count);
+    interned_index.list_data[i] = interned.lLength;
+    interned.AppendNewInstance (key);
+    interned_count++;
+    return key;
+  }
+
+}
+
+//_____________________________________________________________________________________________
+
+HBLObjectRef ParseJSONText (_String const& text) {
+  _JSONParser parser (text);
+  return parser.ParseDocument ();
+}
@@ -55,6 +55,7 @@
 #include "global_object_lists.h"
 #include "global_things.h"
 #include "time_difference.h"
+#include "sampling_profiler.h"
 #include "scfg.h"
 #include "tree_iterator.h"
 #include "vector.h"
@@ -553,6 +554,7 @@ void _LikelihoodFunction::Init (void)
     mstCache            = nil;
     nonConstantDep      = nil;
     evalsSinceLastSetup = 0;
+    referenceStamp      = 0UL;
     siteArrayPopulated  = false;
     smoothingTerm       = 0.;
     smoothingPenalty    = 0.;
@@ -762,6 +764,7 @@ void     _LikelihoodFunction::Rebuild (bool rescan_parameters) {
   computationalResults.Clear();
   hasBeenSetUp     = 0;
   hasBeenOptimized = false;
+  referenceStamp   = 0UL;
   _String ignored_error;
   try {
     for (unsigned long k = 0UL; k < theDataFilters.lLength; k++) {
@@ -809,6 +812,7 @@ void     _LikelihoodFunction::Clear (void)
     leafSkips.Clear();
     hasBeenSetUp            = 0;
     hasBeenOptimized        = false;
+    referenceStamp          = 0UL;
     if (computingTemplate) {
         delete computingTemplate;
         computingTemplate = nil;
@@ -1873,6 +1877,7 @@ void    _LikelihoodFunction::PostCompute        (void) {
         _Variable * this_p = GetIthIndependentVar(i);
         if (this_p->varFlags & HY_VARIABLE_CHANGED) {
           this_p->varFlags -= HY_VARIABLE_CHANGED;
+          variableChangeStamp++;
         }
         //this_p->varFlags = this_p->varFlags & HY_HY_VARIABLE_CHANGED_CLEAR;
     }
@@ -1950,6 +1955,9 @@ hyFloat  _LikelihoodFunction::Compute        (void)
 */
 {
 
+    _hyProfilerPhase profiler_phase (kProfilerPhaseLikelihood);
+    unsigned long const compute_stamp = variableChangeStamp;
+    _hyVariableReferenceStamp reference (referenceStamp);
     hyFloat result = 0.;
 
     if (!PreCompute()) {
@@ -2212,6 +2220,7 @@ hyFloat  _LikelihoodFunction::Compute        (void)
         likeFuncEvalCallCount ++;
         evalsSinceLastSetup   ++;
         PostCompute ();
+        referenceStamp = compute_stamp;
 #ifdef _UBER_VERBOSE_LF_DEBUG
         fprintf (stderr, "%g\n", result);
 #endif
@@ -3514,8 +3523,6 @@ void            _LikelihoodFunction::SetupLFCaches              (void) {
              iNodeCount        = cT->GetINodeCount(),
              atomSize      = theFilter->GetUnitLength();
 
-        long ambig_resolution_count = 1L;
-
         if (leafCount > 1UL) {
             conditionalInternalNodeLikelihoodCaches[i] = (hyFloat*)MemAllocate (sizeof(hyFloat)*patternCount*stateSpaceDim*iNodeCount*cT->categoryCount, false, 64);
             branchCaches[i]                            = (hyFloat*)MemAllocate (sizeof(hyFloat)*2*patternCount*stateSpaceDim*cT->categoryCount, false, 64);
@@ -3536,14 +3543,14 @@ void            _LikelihoodFunction::SetupLFCaches              (void) {
         InitializeArray(siteScalingFactors[i] , patternCount*iNodeCount*cT->categoryCount, 1.);
 
         // now process filter characters by site / column
+        // leaf states are resolved once per data set / unit / exclusions, and
+        // the resolutions of ambiguous states are shared with other filters
 
-        _List        foundCharactersAux;
-        _AVLListX    foundCharacters (&foundCharactersAux);
+        _DataSetStateCache * shared_states = theFilter->GetStateCache();
         _String      aState ((unsigned long)atomSize);
 
         char  const ** columnBlock      = (char const**)alloca(atomSize*sizeof (const char*));
         hyFloat      * translationCache  = (hyFloat*)alloca (sizeof (hyFloat)* stateSpaceDim);
-        _Vector  * ambigs            = new _Vector();
 
         for (unsigned long siteID = 0UL; siteID < patternCount; siteID ++) {
             siteScalingFactors[i][siteID] = 1.;
@@ -3561,23 +3568,13 @@ void            _LikelihoodFunction::SetupLFCaches              (void) {
                     aState.set_char (k, columnBlock[k][mappedLeaf]);
                 }
 
-                translation = foundCharacters.Find (&aState);
-                if (translation < 0L) {
-                    translation = theFilter->Translate2Frequencies (aState, translationCache, true);
-                    if (translation < 0L) {
-                        for (unsigned long j = 0UL; j < stateSpaceDim; j++) {
-                            ambigs->Store(translationCache[j]);
-                        }
-                        translation = -ambig_resolution_count++;
-                    }
-                    foundCharacters.Insert (new _String(aState), translation);
-                } else {
-                    translation = foundCharacters.GetXtra (translation);
+                if (!shared_states->Lookup (aState, translation)) {
+                    translation = shared_states->Store (aState, theFilter->Translate2Frequencies (aState, translationCache, true), translationCache, stateSpaceDim);
                 }
                 conditionalTerminalNodeStateFlag [i][leafID*patternCount + siteID] = translation;
             }
         }
-        conditionalTerminalNodeLikelihoodCaches < ambigs;
+        conditionalTerminalNodeLikelihoodCaches << shared_states->Ambiguities();
 
 #ifdef MDSOCL
 		OCLEval[i].init(patternCount, theFilter->GetDimension(), conditionalInternalNodeLikelihoodCaches[i]);
@@ -3746,6 +3743,8 @@ void _LikelihoodFunction::CleanupParameterMapping (void)
 //_______________________________________________________________________________________
 
 _Matrix*        _LikelihoodFunction::Optimize (_AssociativeList const * options) {
+    _hyProfilerPhase profiler_phase (kProfilerPhaseOptimizer);
+    
     // various optimization-only env variables
     
     
@@ -7840,8 +7839,13 @@ void    _LikelihoodFunction::UpdateIndependent (long index, bool purgeResults, _
 
         for (f=0; f<newVars.countitems(); f++) {
             _Variable* cv = LocateVar(newVars.list_data[f]);
-            if (cv->IsIndependent()&& theList->Find(newVars.list_data[f])==-1) {
-                (*theList) << newVars.list_data[f];
+            if (cv->IsIndependent()) {
+                if (theList->Find(newVars.list_data[f])==-1) {
+                    (*theList) << newVars.list_data[f];
+                }
+            } else if (!cv->IsCategory() && secondList->Find(newVars.list_data[f])==-1) {
+                // constrained variables the new constraint goes through, as ScanAllVariables would list them
+                (*secondList) << newVars.list_data[f];
             }
         }
 
@@ -8076,6 +8080,8 @@ hyFloat  _LikelihoodFunction::ComputeBlock (long index, hyFloat* siteRes, long c
 */
 {
 
+    _hyVariableReferenceStamp reference (referenceStamp);
+
     // set up global matrix frequencies
 
     _SimpleList               *sl = (_SimpleList*)optimalOrders.GetItem(index);
@@ -8209,7 +8215,8 @@ hyFloat  _LikelihoodFunction::ComputeBlock (long index, hyFloat* siteRes, long c
             if (matrices->lLength) {
                 t->ExponentiateMatrices(*matrices, GetThreadCount(),catID);
             }
-
+            
+            _hyProfilerPhase profiler_phase (kProfilerPhasePrune);
 
 
             hyFloat sum  = 0.;
@@ -8402,6 +8409,8 @@ hyFloat  _LikelihoodFunction::ComputeBlock (long index, hyFloat* siteRes, long c
             if (mc.lLength) {
                 t->ExponentiateMatrices(mc, GetThreadCount(),catID);
             }
+            
+            _hyProfilerPhase profiler_phase (kProfilerPhasePrune);
 
             //branchedGlobalCache.Clear(false);
             //matricesGlobalCache.Clear(false);
@@ -9643,6 +9652,8 @@ void    _LikelihoodFunction::StateCounter (long functionCallback) const {
   void    _LikelihoodFunction::Simulate (_DataSet &target, _List& theExclusions, _Matrix* catValues, _Matrix* catNames, _Matrix* spawnValues, _String const* storeIntermediates) const {
       // will step thru multiple trees of the project and simulate  a dataset from the likelihood function
 
+    _hyVariableReferenceStamp reference (referenceStamp);
+
     enum {
       kLFSimulateCategoriesNone,
       kLFSimulateCategoriesDiscrete,
@@ -0,0 +1,503 @@
+/*
+ 
+ HyPhy - Hypothesis Testing Using Phylogenies.
+ 
+ Copyright (C) 1997-now
+ Core Developers:
+ Sergei L Kosakovsky Pond (sergeilkp@icloud.com)
+ Art FY Poon    (apoon42@uwo.ca)
+ Steven Weaver (sweaver@temple.edu)
+ 
+ Module Developers:
+ Lance Hepler (nlhepler@gmail.com)
+ Martin Smith (martin.audacis@gmail.com)
+ 
+ Significant contributions from:
+ Spencer V Muse (muse@stat.ncsu.edu)
+ Simon DW Frost (sdf22@cam.ac.uk)
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ */
+
+/*
+    A stand-in for the MPI message layer (MPISendString / MPIRecvString) for HyPhy
+    builds without MPI support.
+
+    When HyPhy is started with WORKERS=N, MPI_NODE_COUNT is set to N+1, and a message
+    sent to node k (1..N) is delivered to a worker process. All workers are forked
+    by StartLocalWorkers right after GlobalStartup, while the master is still single
+    threaded (a process forked after OpenMP has started its thread pool can deadlock
+    in its first parallel region). Like MPI slave nodes, workers start from a clean
+    state: libv3/tasks/mpi.bf sends them the headers, models and likelihood functions
+    that a job queue needs. Each worker services requests the same way an MPI slave
+    node does (see mpiNormalLoop), until it receives an empty message or the master
+    goes away, and writes its console output and log files to stdout.mpinode<k>,
+    messages.log.mpinode<k> and errors.log.mpinode<k> (empty files are removed on exit).
+
+    Messages travel over a pair of pipes per worker, each framed as a
+    signed length (negative for error messages) followed by the message body.
+*/
+
+#include "batchlan.h"
+
+#ifdef __HYPHY_LOCAL_WORKERS__
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "likefunc.h"
+#include "dataset.h"
+#include "global_object_lists.h"
+#include "global_things.h"
+#include "hbl_env.h"
+#include "hy_string_buffer.h"
+
+using namespace hy_global;
+
+static  _String const     kLocalWorkerPreserveState  ("PRESERVE_SLAVE_NODE_STATE"),
+                          kLocalWorkerNexusReturn    ("MPI_NEXUS_FILE_RETURN"),
+                          kLocalWorkerStdout         ("stdout"),
+                          kLocalWorkerFileSuffix     (".mpinode");
+
+static  _SimpleList       local_worker_pids,        // 0 if the worker for this node could not be started
+                          local_worker_requests,    // write end of the master -> worker pipe
+                          local_worker_responses,   // read end of the worker -> master pipe
+                          local_worker_pending;     // the number of messages sent to the worker and not yet answered
+
+static  int               local_master_requests  = -1,  // [worker only] the read end of the master -> worker pipe
+                          local_master_responses = -1;  // [worker only] the write end of the worker -> master pipe
+
+static  _String           local_worker_stdout;          // [worker only] the file which stdout is redirected to
+
+static  unsigned long     local_worker_poll_start = 0UL;
+
+//____________________________________________________________________________________
+
+static bool _LocalWorkerWrite (int fd, const void * buffer, size_t length) {
+    const char * data = (const char*)buffer;
+    while (length) {
+        ssize_t written = write (fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data   += written;
+        length -= written;
+    }
+    return true;
+}
+
+//____________________________________________________________________________________
+
+static bool _LocalWorkerRead (int fd, void * buffer, size_t length) {
+    // false if the other end was closed before 'length' bytes were read
+    char * data = (char*)buffer;
+    while (length) {
+        ssize_t got = read (fd, data, length);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data   += got;
+        length -= got;
+    }
+    return true;
+}
+
+//____________________________________________________________________________________
+
+static void _LocalWorkerOpenFiles (long node) {
+    // redirect stdout to, and (re)open the log files as, the files of this worker
+
+    _String const suffix = kLocalWorkerFileSuffix & node;
+
+    long const path_end = hy_messages_log_name.FindBackwards ("/", 0L, kStringEnd);
+    local_worker_stdout = (path_end >= 0L ? hy_messages_log_name.Cut (0L, path_end) : kEmptyString) & kLocalWorkerStdout & suffix;
+
+    FILE * output = doFileOpen (local_worker_stdout.get_str(), "w");
+    if (output) {
+        dup2   (fileno (output), STDOUT_FILENO);
+        fclose (output);
+    }
+    has_terminal_stdout = false;
+
+    _String * names [2] = {&hy_error_log_name, &hy_messages_log_name};
+    FILE ** handles [2] = {&hy_error_log_file, &hy_message_log_file};
+
+    for (long file_index = 0; file_index < 2; file_index++) {
+        if (*handles[file_index]) {
+            fclose (*handles[file_index]);
+        }
+        *names[file_index]   = *names[file_index] & suffix;
+        *handles[file_index] = doFileOpen (names[file_index]->get_str(), "w+");
+    }
+}
+
+//____________________________________________________________________________________
+
+static void _LocalWorkerCloseFiles (void) {
+    // close the output files of this worker, and remove those which are empty
+
+    fflush (nil);
+
+    struct stat output_info;
+    if (fstat (STDOUT_FILENO, &output_info) == 0 && output_info.st_size == 0) {
+        remove (local_worker_stdout.get_str());
+    }
+
+    _String * names [2] = {&hy_error_log_name, &hy_messages_log_name};
+    FILE ** handles [2] = {&hy_error_log_file, &hy_message_log_file};
+
+    for (long file_index = 0; file_index < 2; file_index++) {
+        if (*handles[file_index]) {
+            fseek (*handles[file_index], 0, SEEK_END);
+            bool const is_empty = ftell (*handles[file_index]) == 0L;
+            fclose (*handles[file_index]);
+            *handles[file_index] = nil;
+            if (is_empty) {
+                remove (names[file_index]->get_str());
+            }
+        }
+    }
+}
+
+//____________________________________________________________________________________
+
+static void _LocalWorkerLoop (_String const & base_directory) {
+    // the equivalent of mpiNormalLoop for a forked worker; never returns
+
+    long         sender_id = 0L;
+    _String    * message   = MPIRecvString (0L, sender_id);
+
+    while (message->nonempty()) {
+        hy_env :: EnvVariableSet (hy_env ::mpi_node_id, new _Constant (hy_mpi_node_rank), false);
+        hy_env :: EnvVariableSet (hy_env ::mpi_node_count, new _Constant (hy_mpi_node_count), false);
+
+        _StringBuffer * result = nil;
+
+        if (message->BeginsWith ("#NEXUS")) {
+            ReadDataSetFile (nil,true,message);
+            _Variable * lf_name = FetchVar(LocateVarByName(kLocalWorkerNexusReturn));
+
+            if (lf_name) {
+                result = new _StringBuffer ((_String*)lf_name->Compute()->toStr());
+            } else {
+                _FString * lf_id = (_FString*)FetchObjectFromVariableByType (&lf2SendBack, STRING);
+                if (!lf_id) {
+                    HandleApplicationError (_String("[MPI] Malformed MPI likelihood function optimization request - did not specify the LF name to return in variable ") & lf2SendBack & ".\n\n\n" );
+                    break;
+                }
+
+                long type = HY_BL_LIKELIHOOD_FUNCTION, index;
+                _LikelihoodFunction * lf = (_LikelihoodFunction *)hyphy_global_objects::_HYRetrieveBLObjectByName (lf_id->get_str(), type, &index, false, false);
+
+                if (!lf) {
+                    HandleApplicationError (_String("[MPI] Malformed MPI likelihood function optimization request - '") & lf_id->get_str() &"' did not refer to a well-defined likelihood function.\n\n\n");
+                    break;
+                }
+
+                result = new _StringBuffer (1024UL);
+                lf->SerializeLF(*result,hy_env::EnvVariableTrue (hy_env::short_mpi_return) ? _hyphyLFSerializeModeShortMPI:_hyphyLFSerializeModeLongMPI);
+            }
+        } else {
+            _ExecutionList commands (*message);
+            HBLObjectRef   return_value = commands.Execute();
+            if (return_value) {
+                result = new _StringBuffer ((_String*)return_value->toStr());
+            } else {
+                result = new _StringBuffer ("0");
+            }
+        }
+
+        MPISendString (*result, 0L);
+        DeleteObject  (result);
+
+        if (hy_env::EnvVariableTrue (kLocalWorkerPreserveState) == false) {
+            _String base (base_directory);
+            PurgeAll            (true);
+            InitializeGlobals   ();
+            PushFilePath        (base, false, false);
+        }
+
+        DeleteObject (message);
+        message = MPIRecvString (0L, sender_id);
+    }
+
+    DeleteObject (message);
+    _LocalWorkerCloseFiles ();
+    _exit  (0);
+}
+
+//____________________________________________________________________________________
+
+static void _StartLocalWorker (long node) {
+    int  requests  [2],
+         responses [2];
+
+    if (pipe (requests) != 0 || pipe (responses) != 0) {
+        HandleApplicationError (_String ("Failed to create the pipes for local worker node ") & node);
+        return;
+    }
+
+    fflush (nil);
+    pid_t pid = fork ();
+
+    if (pid < 0) {
+        HandleApplicationError (_String ("Failed to start local worker node ") & node);
+        return;
+    }
+
+    if (pid == 0) {
+        close (requests[1]);
+        close (responses[0]);
+
+        for (unsigned long k = 1UL; k < local_worker_pids.countitems(); k++) {
+            if (local_worker_pids.get (k)) {
+                close (local_worker_requests.get (k));
+                close (local_worker_responses.get (k));
+            }
+        }
+        local_worker_pids.Clear();
+        local_worker_requests.Clear();
+        local_worker_responses.Clear();
+        local_worker_pending.Clear();
+
+        local_master_requests  = requests[0];
+        local_master_responses = responses[1];
+        hy_mpi_node_rank       = node;
+
+        _LocalWorkerOpenFiles (node);
+
+        // MPI nodes are seeded from their own process ids; forked workers would share the seed of the master
+        hy_random_seed = getpid () + (long)time (nil);
+        init_genrand   (hy_random_seed);
+        hy_env :: EnvVariableSet (hy_env::random_seed, new _Constant (hy_random_seed), false);
+
+        _String base_directory (pathNames.countitems() ? *(_String*)pathNames.GetItem (0) : hy_base_directory);
+        _LocalWorkerLoop (base_directory);
+    }
+
+    close (requests[0]);
+    close (responses[1]);
+
+    local_worker_pids.list_data      [node] = pid;
+    local_worker_requests.list_data  [node] = requests[1];
+    local_worker_responses.list_data [node] = responses[0];
+}
+
+//____________________________________________________________________________________
+
+void    StartLocalWorkers   (void) {
+    // fork a worker for each of the nodes 1 .. hy_mpi_node_count - 1; this must happen
+    // before the master enters any OpenMP parallel region
+
+    if (hy_mpi_node_rank > 0 || hy_mpi_node_count < 2 || local_worker_pids.nonempty()) {
+        return;
+    }
+
+    // a worker which has gone away should show up as a failed write, not a signal
+    signal (SIGPIPE, SIG_IGN);
+
+    for (long node = 0L; node < hy_mpi_node_count; node++) {
+        local_worker_pids      << 0L;
+        local_worker_requests  << -1L;
+        local_worker_responses << -1L;
+        local_worker_pending   << 0L;
+    }
+
+    for (long node = 1L; node < hy_mpi_node_count; node++) {
+        _StartLocalWorker (node);
+    }
+}
+
+//____________________________________________________________________________________
+
+void    MPISendString       (_String const& message, long destination, bool is_error) {
+    int fd;
+
+    if (hy_mpi_node_rank > 0) {
+        fd = local_master_responses;
+    } else {
+        if (destination < 1L || destination >= (long)local_worker_pids.countitems()) {
+            HandleApplicationError (_String ("Invalid local worker node index ") & destination);
+            return;
+        }
+
+        if (local_worker_pids.get (destination) == 0L) {
+            HandleApplicationError (_String ("Local worker node ") & destination & " is not running");
+            return;
+        }
+
+        fd = local_worker_requests.get (destination);
+    }
+
+    long length = is_error ? -(long)message.length() : (long)message.length();
+
+    if (!_LocalWorkerWrite (fd, &length, sizeof (long)) || !_LocalWorkerWrite (fd, message.get_str(), message.length())) {
+        if (hy_mpi_node_rank > 0) {
+            _exit (1);
+        }
+        HandleApplicationError (_String ("Failed to send a message to local worker node ") & destination);
+        return;
+    }
+
+    if (hy_mpi_node_rank == 0) {
+        local_worker_pending.list_data[destination]++;
+    }
+
+    _Variable *   last_message = CheckReceptacle (&hy_env::mpi_last_sent_message, kEmptyString, false);
+    last_message->SetValue (new _FString ((_String*)message.makeDynamic()), false);
+}
+
+//____________________________________________________________________________________
+
+_String*    MPIRecvString       (long sender, long& sender_id) {
+    int fd;
+
+    if (hy_mpi_node_rank > 0) {
+        fd        = local_master_requests;
+        sender_id = 0L;
+    } else {
+        if (sender < 0L) {
+            // wait for the first worker with a message to deliver; scan from a rotating start
+            // so that one busy worker does not starve the rest
+
+            _SimpleList   nodes;
+
+            for (unsigned long k = 1UL; k < local_worker_pids.countitems(); k++) {
+                if (local_worker_pending.get (k)) {
+                    nodes << k;
+                }
+            }
+
+            if (nodes.empty()) {
+                HandleApplicationError ("MPIReceive is waiting for a message, but no local worker node has a request to answer");
+                return new _String;
+            }
+
+            struct pollfd * descriptors = new struct pollfd [nodes.countitems()];
+
+            for (unsigned long k = 0UL; k < nodes.countitems(); k++) {
+                descriptors[k].fd      = local_worker_responses.get (nodes.get (k));
+                descriptors[k].events  = POLLIN;
+                descriptors[k].revents = 0;
+            }
+
+            int poll_status;
+            while ((poll_status = poll (descriptors, nodes.countitems(), -1)) < 0 && errno == EINTR) {}
+
+            sender = nodes.get (0);
+            for (unsigned long k = 0UL; k < nodes.countitems(); k++) {
+                unsigned long i = (k + local_worker_poll_start) % nodes.countitems();
+                if (descriptors[i].revents) {
+                    sender = nodes.get (i);
+                    local_worker_poll_start = i + 1UL;
+                    break;
+                }
+            }
+
+            delete [] descriptors;
+
+            if (poll_status < 0) {
+                HandleApplicationError ("Failed to poll local worker nodes");
+                return new _String;
+            }
+        } else if (sender < 1L || sender >= (long)local_worker_pids.countitems() || local_worker_pending.get (sender) == 0L) {
+            HandleApplicationError (_String ("MPIReceive is waiting for a message from local worker node ") & sender & ", which has no request to answer");
+            return new _String;
+        }
+
+        fd        = local_worker_responses.get (sender);
+        sender_id = sender;
+        local_worker_pending.list_data[sender]--;
+    }
+
+    long length;
+
+    if (!_LocalWorkerRead (fd, &length, sizeof (long))) {
+        if (hy_mpi_node_rank > 0) {
+            // the master has gone away; treat as a shutdown request
+            return new _String;
+        }
+        HandleApplicationError (_String ("Local worker node ") & sender_id & " terminated unexpectedly");
+        return new _String;
+    }
+
+    bool is_error = length < 0L;
+    if (is_error) {
+        length = -length;
+    }
+
+    _String * message = new _String ((unsigned long)length);
+
+    if (length && !_LocalWorkerRead (fd, (void*)message->get_str(), length)) {
+        HandleApplicationError ("Failed in MPIRecvString - some data was not properly received\n");
+    }
+
+    if (is_error) {
+        HandleApplicationError (*message);
+    }
+
+    return message;
+}
+
+//____________________________________________________________________________________
+
+void    StopLocalWorkers    (void) {
+    // send every running worker an empty (shutdown) message and wait for it to exit
+
+    if (hy_mpi_node_rank > 0) {
+        return;
+    }
+
+    for (unsigned long k = 1UL; k < local_worker_pids.countitems(); k++) {
+        if (local_worker_pids.get (k)) {
+            long shutdown = 0L;
+            _LocalWorkerWrite (local_worker_requests.get (k), &shutdown, sizeof (long));
+            close (local_worker_requests.get (k));
+            close (local_worker_responses.get (k));
+        }
+    }
+
+    for (unsigned long k = 1UL; k < local_worker_pids.countitems(); k++) {
+        if (local_worker_pids.get (k)) {
+            waitpid ((pid_t)local_worker_pids.get (k), nil, 0);
+        }
+    }
+
+    local_worker_pids.Clear();
+    local_worker_requests.Clear();
+    local_worker_responses.Clear();
+    local_worker_pending.Clear();
+}
+
+#endif
@@ -2757,7 +2757,7 @@ HBLObjectRef   _Matrix::EvaluateSimple (void) {
                     cmd->varValues[i].value = LocateVar (cmd->varIndex.list_data[i])->Compute()->Value();
                 }
             } else {
-                cmd->varValues[i].reference = (hyPointer)((_Matrix*)LocateVar (cmd->varIndex.list_data[i])->Compute())->theData;
+                cmd->varValues[i].reference = (hyPointer)LocateVar (cmd->varIndex.list_data[i])->Compute();
             }
         }
     }
@@ -6904,9 +6904,8 @@ _Matrix     _Matrix::operator - (_Matrix& m)
 }
 
 //_________________________________________________________
-void    _Matrix::internal_to_str (_StringBuffer* string, FILE * file, unsigned long padding) {
+void    _Matrix::SerializeTo (StringFileWrapper& res, unsigned long padding) {
     
-    StringFileWrapper res (string, file);
    _String padder (" ", padding);
     
     static const _String kUseJSONForMatrix ("USE_JSON_FOR_MATRIX");
@@ -6916,22 +6915,19 @@ void    _Matrix::internal_to_str (_StringBuffer* string, FILE * file, unsigned l
     
     if (directly_printable) {
         
-        long digs         = -1L;
-        
         bool doJSON = hy_env::EnvVariableTrue(kUseJSONForMatrix);
         
         char openBracket  = doJSON ? '[' : '{',
              closeBracket = doJSON ? ']' : '}';
         
         if (is_numeric_mx) {
-            digs = MIN (print_digit_specification = hy_env::EnvVariableGetDefaultNumber(hy_env::print_float_digits), 15);
+            // read by parameterToCharBuffer
+            print_digit_specification = hy_env::EnvVariableGetDefaultNumber(hy_env::print_float_digits);
         }
         res << padder << openBracket << kStringFileWrapperNewLine;
 
         if (is_numeric_mx) {
             
-            _String formatStr = _String("%") &_String(digs+6)&'.'&_String(digs)&'g';
-            
              char  number_buffer [256];
  
             for (long i = 0L; i<hDim; i++) {
@@ -6966,7 +6962,14 @@ void    _Matrix::internal_to_str (_StringBuffer* string, FILE * file, unsigned l
                     if (f) {
                         HBLObjectRef fv = f->Compute();
                         if (fv) {
-                          res << _String ((_String*)fv->toStr());
+                          if (doJSON) {
+                            // JSON strings must escape quotes, backslashes and line breaks
+                            _StringBuffer sanitized;
+                            sanitized.SanitizeAndAppend (_String ((_String*)fv->toStr()));
+                            res << sanitized;
+                          } else {
+                            res << _String ((_String*)fv->toStr());
+                          }
                           //;((_FString*)fv)->get_str();
                         }
                     }
@@ -6980,7 +6983,7 @@ void    _Matrix::internal_to_str (_StringBuffer* string, FILE * file, unsigned l
     } else if (storageType==_POLYNOMIAL_TYPE) {
         ANALYTIC_COMPUTATION_FLAG  = hy_env::EnvVariableTrue (ANAL_COMP_FLAG);
         if (!ANALYTIC_COMPUTATION_FLAG) {
-            ((_Matrix*)Compute())->internal_to_str (string, file, padding);
+            ((_Matrix*)Compute())->SerializeTo (res, padding);
             return;
         }
         for (long i = 0; i<hDim; i++) {
@@ -7002,19 +7005,21 @@ void    _Matrix::internal_to_str (_StringBuffer* string, FILE * file, unsigned l
         }
     } else {
         _Matrix* eval = (_Matrix*)(storageType==3?EvaluateSimple():Evaluate(false));
-        eval->internal_to_str(string, file, padding);
+        eval->SerializeTo (res, padding);
         DeleteObject (eval);
     }
 }
 //_________________________________________________________
 void    _Matrix::toFileStr (FILE*dest, unsigned long padding){
-    internal_to_str(nil, dest, padding);
+    StringFileWrapper res (nil, dest);
+    SerializeTo (res, padding);
 }
 //_____________________________________________________________________________________________
 
 BaseRef _Matrix::toStr(unsigned long padding) {
     _StringBuffer * serialized = new _StringBuffer (2048L);
-    internal_to_str (serialized, nil, padding);
+    StringFileWrapper res (serialized, nil);
+    SerializeTo (res, padding);
     return serialized;
 }
 
@@ -7026,7 +7031,8 @@ void     _Matrix::Serialize (_StringBuffer& res, _String& myID) {
         res <<  myID;
         if (is_numeric()) {
             res << '=';
-            res.AppendNewInstance((_String*)toStr());
+            StringFileWrapper write_here (&res, nil);
+            SerializeTo (write_here);
             res << ';';
         } else if (is_expression_based()) {
             res << (_String ("={") & hDim & ',' & vDim & "};\n");
@@ -615,7 +615,7 @@ void    ProcessNexusTrees (FileState& fState, long pos, FILE*f, _String& Current
                 if (readResult) {
                     break;
                 }
-                if  ((f&&feof(f))||(fState.theSource&&(fState.theSource->length()<=fState.pInSrc))) {
+                if  ((f&&feof(f))||(fState.theSource&&(fState.sourceLength<=fState.pInSrc))) {
                     break;
                 }
                 offset = 0;
@@ -1217,7 +1217,7 @@ bool    ProcessNexusData (FileState& fState, long pos, FILE*f, _String& CurrentL
                         break;    // finished reading
                     }
 
-                if  ((f&&feof(f))||(fState.theSource&&(fState.theSource->length()<=fState.pInSrc))) {
+                if  ((f&&feof(f))||(fState.theSource&&(fState.sourceLength<=fState.pInSrc))) {
                     break;
                 }
             }
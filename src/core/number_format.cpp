@@ -0,0 +1,402 @@
+/*
+ 
+ HyPhy - Hypothesis Testing Using Phylogenies.
+ 
+ Copyright (C) 1997-now
+ Core Developers:
+ Sergei L Kosakovsky Pond (sergeilkp@icloud.com)
+ Art FY Poon    (apoon42@uwo.ca)
+ Steven Weaver (sweaver@temple.edu)
+ 
+ Module Developers:
+ Lance Hepler (nlhepler@gmail.com)
+ Martin Smith (martin.audacis@gmail.com)
+ 
+ Significant contributions from:
+ Spencer V Muse (muse@stat.ncsu.edu)
+ Simon DW Frost (sdf22@cam.ac.uk)
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ */
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "number_format.h"
+
+/*
+    Grisu3 (F. Loitsch, "Printing floating-point numbers quickly and
+    accurately with integers", PLDI 2010): the double and its rounding
+    boundaries are scaled by a cached power of ten so that the digits can be
+    generated with 64-bit integer arithmetic; digit generation stops as soon
+    as the digits identify the double uniquely. The scaled boundaries carry
+    a small error, so Grisu3 also reports when it cannot prove that its
+    digits are the shortest (and closest) ones; that happens for about 0.5%
+    of doubles, which are then handled by printf at the smallest precision
+    that reads back.
+*/
+
+namespace {
+
+  const unsigned long long kHiddenBit       = 0x0010000000000000ULL,
+                           kSignificandMask = 0x000FFFFFFFFFFFFFULL,
+                           kExponentMask    = 0x7FF0000000000000ULL;
+
+  const int                kSignificandSize = 52,
+                           kExponentBias    = 0x3FF + kSignificandSize;
+
+  struct _DiyFp {
+    unsigned long long f;
+    int                e;
+
+    _DiyFp (void) : f (0ULL), e (0) {}
+    _DiyFp (unsigned long long significand, int exponent) : f (significand), e (exponent) {}
+
+    explicit _DiyFp (double value) {
+      unsigned long long bits;
+      memcpy (&bits, &value, sizeof (double));
+      int biased_exponent = (int)((bits & kExponentMask) >> kSignificandSize);
+      unsigned long long significand = bits & kSignificandMask;
+      if (biased_exponent) {
+        f = significand + kHiddenBit;
+        e = biased_exponent - kExponentBias;
+      } else {
+        f = significand;
+        e = 1 - kExponentBias;
+      }
+    }
+
+    _DiyFp operator - (_DiyFp const& rhs) const {
+      return _DiyFp (f - rhs.f, e);
+    }
+
+    _DiyFp operator * (_DiyFp const& rhs) const {
+      // upper 64 bits of the product, rounded
+      unsigned __int128 product = (unsigned __int128)f * rhs.f;
+      unsigned long long high = (unsigned long long)(product >> 64),
+                         low  = (unsigned long long)product;
+      if (low & (1ULL << 63)) {
+        high++;
+      }
+      return _DiyFp (high, e + rhs.e + 64);
+    }
+
+    _DiyFp Normalize (void) const {
+      int shift = __builtin_clzll (f);
+      return _DiyFp (f << shift, e - shift);
+    }
+
+    // the normalized upper (m_plus) and lower (m_minus) rounding boundaries
+    void NormalizedBoundaries (_DiyFp & m_minus, _DiyFp & m_plus) const {
+      _DiyFp upper ((f << 1) + 1ULL, e - 1);
+      while (!(upper.f & (kHiddenBit << 1))) {
+        upper.f <<= 1;
+        upper.e--;
+      }
+      upper.f <<= 64 - kSignificandSize - 2;
+      upper.e  -= 64 - kSignificandSize - 2;
+
+      // the lower boundary is closer for powers of two, except for the smallest normal exponent
+      _DiyFp lower = f == kHiddenBit && e > 1 - kExponentBias ? _DiyFp ((f << 2) - 1ULL, e - 2) : _DiyFp ((f << 1) - 1ULL, e - 1);
+      lower.f <<= lower.e - upper.e;
+      lower.e   = upper.e;
+
+      m_minus = lower;
+      m_plus  = upper;
+    }
+  };
+
+  // normalized 64-bit significands and binary exponents of 10^-348, 10^-340, ..., 10^340
+  const unsigned long long kCachedPowersF[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,  };
+
+  const short kCachedPowersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,  };
+
+  const unsigned long long kPowersOf10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+  };
+
+  // a cached power c = 10^-k, such that c * 2^e has its binary exponent in [-60,-32]
+  _DiyFp CachedPower (int e, int & k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int    ik = (int)dk;
+    if (dk - ik > 0.0) {
+      ik++;
+    }
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    k = -(-348 + (int)(index << 3));
+    return _DiyFp (kCachedPowersF[index], kCachedPowersE[index]);
+  }
+
+  int CountDecimalDigits (unsigned n) {
+    int digits = 1;
+    while (digits < 10 && n >= kPowersOf10[digits]) {
+      digits++;
+    }
+    return digits;
+  }
+
+  /* nudge the last digit towards the scaled value w while staying inside
+     the (unsafe) interval; returns false if the digits could not be proven
+     to be the shortest, closest representation given the scaling error
+     of 'unit' in the last place */
+  bool RoundWeed (char * buffer, int length, unsigned long long distance_too_high_w,
+                  unsigned long long unsafe_interval, unsigned long long rest,
+                  unsigned long long ten_kappa, unsigned long long unit) {
+    unsigned long long const small_distance = distance_too_high_w - unit,
+                             big_distance   = distance_too_high_w + unit;
+
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)) {
+      buffer[length - 1]--;
+      rest += ten_kappa;
+    }
+
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance)) {
+      return false;
+    }
+
+    return 2ULL * unit <= rest && rest <= unsafe_interval - 4ULL * unit;
+  }
+
+  bool GenerateDigits (_DiyFp const& low, _DiyFp const& w, _DiyFp const& high,
+                       char * buffer, int & length, int & kappa) {
+    unsigned long long unit = 1ULL;
+    _DiyFp const too_low  (low.f - unit, low.e),
+                 too_high (high.f + unit, high.e),
+                 one      (1ULL << -w.e, w.e);
+    unsigned long long unsafe_interval = (too_high - too_low).f;
+
+    unsigned           integrals   = (unsigned)(too_high.f >> -one.e);
+    unsigned long long fractionals = too_high.f & (one.f - 1ULL);
+
+    kappa  = CountDecimalDigits (integrals);
+    length = 0;
+
+    while (kappa > 0) {
+      unsigned divisor = (unsigned)kPowersOf10[kappa - 1],
+               digit   = integrals / divisor;
+      integrals %= divisor;
+      if (digit || length) {
+        buffer[length++] = (char)('0' + digit);
+      }
+      kappa--;
+      unsigned long long rest = ((unsigned long long)integrals << -one.e) + fractionals;
+      if (rest < unsafe_interval) {
+        return length > 0 && RoundWeed (buffer, length, (too_high - w).f, unsafe_interval, rest,
+                                        (unsigned long long)divisor << -one.e, unit);
+      }
+    }
+
+    for (;;) {
+      fractionals     *= 10ULL;
+      unit            *= 10ULL;
+      unsafe_interval *= 10ULL;
+      char digit = (char)(fractionals >> -one.e);
+      if (digit || length) {
+        buffer[length++] = (char)('0' + digit);
+      }
+      fractionals &= one.f - 1ULL;
+      kappa--;
+      if (fractionals < unsafe_interval) {
+        return length > 0 && RoundWeed (buffer, length, (too_high - w).f * unit, unsafe_interval,
+                                        fractionals, one.f, unit);
+      }
+    }
+  }
+
+  /* digits of a positive, finite 'value' such that value = digits * 10^k;
+     returns false if the digits may not be the shortest ones */
+  bool Grisu3 (double value, char * buffer, int & length, int & k) {
+    _DiyFp const v (value);
+    _DiyFp m_minus, m_plus;
+    v.NormalizedBoundaries (m_minus, m_plus);
+
+    _DiyFp const c_mk = CachedPower (m_plus.e, k);
+    int kappa;
+    bool const shortest = GenerateDigits (m_minus * c_mk, v.Normalize () * c_mk, m_plus * c_mk,
+                                          buffer, length, kappa);
+    k += kappa;
+    return shortest;
+  }
+
+  /* correctly rounded fallback: the smallest precision whose printf
+     output reads back as 'value' (reading back is monotone in precision) */
+  void ShortestByPrintf (double value, char * buffer, int & length, int & k) {
+    char formatted [kShortestDoubleLength];
+    int  low = 1, high = 17;
+
+    while (low < high) {
+      int const middle = (low + high) >> 1;
+      snprintf (formatted, kShortestDoubleLength, "%.*e", middle - 1, value);
+      if (strtod (formatted, NULL) == value) {
+        high = middle;
+      } else {
+        low = middle + 1;
+      }
+    }
+
+    snprintf (formatted, kShortestDoubleLength, "%.*e", low - 1, value);
+
+    // d.ddddde[+-]xx
+    char const * c = formatted;
+    length = 0;
+    for (; *c != 'e'; c++) {
+      if (*c != '.') {
+        buffer[length++] = *c;
+      }
+    }
+    while (length > 1 && buffer[length - 1] == '0') {
+      length--;
+    }
+    k = atoi (c + 1) - (length - 1);
+  }
+
+  char * WriteExponent (int exponent, char * buffer) {
+    *buffer++ = 'e';
+    if (exponent < 0) {
+      *buffer++ = '-';
+      exponent = -exponent;
+    } else {
+      *buffer++ = '+';
+    }
+    if (exponent >= 100) {
+      *buffer++ = (char)('0' + exponent / 100);
+      exponent %= 100;
+    }
+    *buffer++ = (char)('0' + exponent / 10);
+    *buffer++ = (char)('0' + exponent % 10);
+    return buffer;
+  }
+}
+
+//__________________________________________________________________________________
+
+unsigned long ShortestDoubleToChars (double value, char * buffer) {
+  char * start = buffer;
+
+  if (value != value) {
+    memcpy (buffer, "nan", 4);
+    return 3UL;
+  }
+
+  if (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0)) {
+    *buffer++ = '-';
+    value     = -value;
+  }
+
+  if (value == 0.0) {
+    *buffer++ = '0';
+    *buffer   = 0;
+    return buffer - start;
+  }
+
+  if (value > DBL_MAX) {
+    memcpy (buffer, "inf", 4);
+    return buffer - start + 3UL;
+  }
+
+  char digits [kShortestDoubleLength];
+  int  length, k = 0;
+
+  if (!Grisu3 (value, digits, length, k)) {
+    ShortestByPrintf (value, digits, length, k);
+  }
+
+  // the decimal exponent of the leading digit; the layout mimics %g
+  int const exponent = length + k - 1;
+
+  if (exponent < -4 || exponent >= 17) {
+    *buffer++ = digits[0];
+    if (length > 1) {
+      *buffer++ = '.';
+      memcpy (buffer, digits + 1, length - 1);
+      buffer += length - 1;
+    }
+    buffer = WriteExponent (exponent, buffer);
+  } else if (exponent < 0) {
+    *buffer++ = '0';
+    *buffer++ = '.';
+    for (int i = exponent + 1; i < 0; i++) {
+      *buffer++ = '0';
+    }
+    memcpy (buffer, digits, length);
+    buffer += length;
+  } else if (exponent + 1 >= length) {
+    memcpy (buffer, digits, length);
+    buffer += length;
+    for (int i = length; i <= exponent; i++) {
+      *buffer++ = '0';
+    }
+  } else {
+    memcpy (buffer, digits, exponent + 1);
+    buffer += exponent + 1;
+    *buffer++ = '.';
+    memcpy (buffer, digits + exponent + 1, length - exponent - 1);
+    buffer += length - exponent - 1;
+  }
+
+  *buffer = 0;
+  return buffer - start;
+}
@@ -47,6 +47,8 @@
 #include "parser.h"
 #include "global_things.h"
 
+#include <typeinfo>
+
 using namespace hy_global;
 
 
@@ -411,6 +413,18 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
 
       bool        need_to_purge = false;
 
+      _ExecutionList * function_body = &GetBFFunctionBody(opCode);
+    
+      // argument name -> variable slot lookups are reused from the previous call
+      // unless a slot has since been freed or a name re-pointed
+      unsigned long const slot_stamp       = variableSlotStamp;
+      bool          const use_cached_slots = function_body->argument_slots_stamp == slot_stamp && function_body->argument_slots.countitems() == arguments;
+    
+      if (!use_cached_slots) {
+        function_body->argument_slots.Clear();
+        function_body->argument_slots.Populate (arguments, -1L, 0L);
+      }
+
       //printf ("***** Calling %s\n", GetBFFunctionNameByIndex (opCode).sData);
 
       for (long k = arguments-1L; k >= 0; k--) {
@@ -437,7 +451,12 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
           }
         }
         
-        _Variable* argument_var = CheckReceptacle (argument_k, kEmptyString, false, false, false);
+        _Variable* argument_var = use_cached_slots ? LocateVar (function_body->argument_slots.get (k)) : nil;
+        
+        if (!argument_var) {
+          argument_var = CheckReceptacle (argument_k, kEmptyString, false, false, false);
+          function_body->argument_slots[k] = argument_var->get_index();
+        }
         
         if (!isRefVar) {
           if (argument_var->IsIndependent() && (argument_var->ObjectClass() & (TREE|TOPOLOGY)) == 0) {
@@ -451,6 +470,7 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
             displacedValues<<argument_var->varValue;
             argument_var->varFlags |= HY_VARIABLE_CHANGED;
             argument_var->varValue = nthterm;
+            variableChangeStamp++;
             existingIVars<<argument_var->get_index();
           } else {
             _Variable *newV = new _Variable (*argument_k);
@@ -459,6 +479,7 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
             displacedVars<<argument_var; // 2 references
             argument_var->AddAReference(); // 3 references
             variablePtrs.Replace (argument_var->get_index(),newV,false); // 2 references
+            variableChangeStamp++;
           }
         } else {
 
@@ -479,11 +500,12 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
           }
           
           variableNames.SetXtra (new_index, reference_var->get_index());
+          variableSlotStamp++;
           DeleteObject (nthterm);
         }
       }
 
-      _ExecutionList * function_body = &GetBFFunctionBody(opCode);
+      function_body->argument_slots_stamp = slot_stamp == variableSlotStamp ? slot_stamp : 0UL;
 
       if (need_to_purge) {
         function_body->ResetFormulae();
@@ -546,7 +568,14 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
       }
 
       if (ret) {
-        theScrap.Push (ret);
+        if (ret == function_body->result) {
+            // hand the reference over to the stack, so that the caller may
+            // take ownership of the returned value instead of copying it
+            function_body->result = nil;
+            theScrap.Push (ret, false);
+        } else {
+            theScrap.Push (ret);
+        }
       } else {
         theScrap.Push (new _MathObject);
       }
@@ -557,10 +586,18 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
         variableNames.SetXtra(LocateVarByName (*(_String*)referenceArgs(di)),displacedReferences.list_data[di]);
       }
 
+      if (referenceArgs.nonempty()) {
+        variableSlotStamp++;
+      }
+
       for (unsigned long dv = 0UL; dv < displacedVars.lLength; dv++) {
         variablePtrs.Replace (existingDVars.list_data[dv],(HBLObjectRef)displacedVars(dv), false);
       }
 
+      if (displacedVars.nonempty() || displacedValues.nonempty()) {
+        variableChangeStamp++;
+      }
+
 
       for (unsigned long dv2 = 0; dv2 < displacedValues.lLength; dv2++) {
         _Variable* theV = LocateVar (existingIVars.list_data[dv2]);
@@ -581,6 +618,10 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
   HBLObjectRef arg0 = ((HBLObjectRef)theScrap.theStack.list_data[theScrap.theStack.lLength-numberOfTerms]),
             temp;
 
+  if (numberOfTerms <= 2L && ExecuteScalar (theScrap)) {
+    return true;
+  }
+
   _hyExecutionContext localContext (nameSpace, errMsg);
 
   if (numberOfTerms > 1) {
@@ -609,6 +650,106 @@ bool        _Operation::Execute (_Stack& theScrap, _VariableContainer const* nam
 
 }
 
+//__________________________________________________________________________________
+bool        _Operation::ExecuteScalar (_Stack& theScrap) {
+  /**
+      Fast path for elementary arithmetic / comparison operations on two (or one, for unary minus) numbers.
+      Bypasses ExecuteSingleOp dispatch, and writes the result into an operand that is a temporary
+      (owned only by the stack) instead of boxing it into a new _Constant.
+      Returns false if the operation / operands are not handled here; the stack is left untouched in that case.
+   */
+
+  long            const stack_depth = theScrap.theStack.lLength;
+  HBLObjectRef  * const operands    = (HBLObjectRef*)theScrap.theStack.list_data + (stack_depth - numberOfTerms);
+
+  if (operands[0]->ObjectClass() != NUMBER || (numberOfTerms == 2L && operands[1]->ObjectClass() != NUMBER)) {
+    return false;
+  }
+
+  hyFloat   const a = operands[0]->Value();
+  hyFloat         result;
+
+  if (numberOfTerms == 1L) {
+    if (opCode != HY_OP_CODE_SUB) {
+      return false;
+    }
+    result = -a;
+  } else {
+    hyFloat const b = operands[1]->Value();
+    switch (opCode) {
+      case HY_OP_CODE_ADD:
+        result = a + b;
+        break;
+      case HY_OP_CODE_SUB:
+        result = a - b;
+        break;
+      case HY_OP_CODE_MUL:
+        result = a * b;
+        break;
+      case HY_OP_CODE_DIV:
+        result = a / b;
+        break;
+      case HY_OP_CODE_LESS:
+        result = a < b;
+        break;
+      case HY_OP_CODE_LEQ:
+        result = a <= b;
+        break;
+      case HY_OP_CODE_GREATER:
+        result = a > b;
+        break;
+      case HY_OP_CODE_GEQ:
+        result = a >= b;
+        break;
+      case HY_OP_CODE_EQ:
+        result = a == 0.0 ? b == 0.0 : fabs ((a-b)/a) < tolerance;
+        break;
+      case HY_OP_CODE_NEQ:
+        result = a == 0.0 ? b != 0.0 : fabs ((a-b)/a) >= tolerance;
+        break;
+      case HY_OP_CODE_AND:
+        result = long (a) && long (b);
+        break;
+      case HY_OP_CODE_OR:
+        result = long (a) || long (b);
+        break;
+      case HY_OP_CODE_MIN:
+        result = a < b ? a : b;
+        break;
+      case HY_OP_CODE_MAX:
+        result = a > b ? a : b;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  auto is_temporary = [] (HBLObjectRef o) -> bool {
+    return o->SingleReference() && typeid (*o) == typeid (_Constant);
+  };
+
+  HBLObjectRef target = nil;
+
+  for (long k = 0L; k < numberOfTerms; k++) {
+    if (!target && is_temporary (operands[k])) {
+      target = operands[k];
+    } else {
+      DeleteObject (operands[k]);
+    }
+  }
+
+  theScrap.theStack.lLength = stack_depth - numberOfTerms;
+
+  if (target) {
+    ((_Constant*)target)->SetValue (result);
+    theScrap.theStack.Place (target);
+  } else {
+    theScrap.theStack.Place (new _Constant (result));
+  }
+
+  return true;
+}
+
 //__________________________________________________________________________________
 void        _Operation::StackDepth (long& depth)
 {
@@ -0,0 +1,335 @@
+/*
+
+HyPhy - Hypothesis Testing Using Phylogenies.
+
+Copyright (C) 1997-now
+Core Developers:
+  Sergei L Kosakovsky Pond (spond@ucsd.edu)
+  Art FY Poon    (apoon42@uwo.ca)
+  Steven Weaver (sweaver@ucsd.edu)
+  
+Module Developers:
+	Lance Hepler (nlhepler@gmail.com)
+	Martin Smith (martin.audacis@gmail.com)
+
+Significant contributions from:
+  Spencer V Muse (muse@stat.ncsu.edu)
+  Simon DW Frost (sdf22@cam.ac.uk)
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+#include "parse_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "avllistxl.h"
+#include "global_things.h"
+#include "hbl_env.h"
+#include "hy_strings.h"
+#include "list.h"
+
+using namespace hy_global;
+
+/*
+    Cache file layout (all integers are 64-bit, in host byte order; strings are
+    written as their length followed by their characters)
+
+        "HBLPARSE"                      magic
+        kParseCacheFormat               bumped whenever FindNextCommand or this layout changes
+        signature                       HyPhy version, source path, modification time and size
+        entry count
+        for each entry
+            key                         hash and length of a text passed to BuildList
+            text                        the text itself, compared with the text being parsed on lookup
+            statement count
+            statements
+*/
+
+static  char const          kParseCacheMagic  [] = "HBLPARSE";
+static  const unsigned long kParseCacheFormat = 1UL;
+
+//____________________________________________________________________________________
+
+class _hyParseCacheSession {
+public:
+    _hyParseCacheSession (void) : statements (&keys), dirty (false) {}
+
+    _String         cache_path,
+                    signature;
+    _List           keys;
+    _AVLListXL      statements;     // key -> _List of two: the text and the _List of its statements
+    bool            dirty;          // true if statements were added since the cache file was read
+};
+
+static  _SimpleList         parse_cache_sessions;   // _hyParseCacheSession*, innermost last
+
+//____________________________________________________________________________________
+
+static unsigned long _ParseCacheHash (_String const & text) {
+    // 64-bit FNV-1a
+    unsigned long hash = 0xcbf29ce484222325UL;
+    char const * data  = text.get_str();
+    for (unsigned long i = 0UL; i < text.length(); i++) {
+        hash = (hash ^ (unsigned char) data[i]) * 0x100000001b3UL;
+    }
+    return hash;
+}
+
+//____________________________________________________________________________________
+
+static _String _ParseCacheKeyString (unsigned long hash, unsigned long length) {
+    char buffer [64];
+    snprintf (buffer, sizeof (buffer), "%016lx:%lu", hash, length);
+    return _String (buffer);
+}
+
+//____________________________________________________________________________________
+
+static void _ParseCacheWriteInteger (FILE * file, unsigned long value) {
+    fwrite (&value, sizeof (value), 1, file);
+}
+
+//____________________________________________________________________________________
+
+static void _ParseCacheWriteString (FILE * file, _String const & value) {
+    _ParseCacheWriteInteger (file, value.length());
+    fwrite (value.get_str(), 1, value.length(), file);
+}
+
+//____________________________________________________________________________________
+
+static bool _ParseCacheReadInteger (_String const & contents, unsigned long & position, unsigned long & value) {
+    if (position + sizeof (value) > contents.length()) {
+        return false;
+    }
+    memcpy (&value, contents.get_str() + position, sizeof (value));
+    position += sizeof (value);
+    return true;
+}
+
+//____________________________________________________________________________________
+
+static _String * _ParseCacheReadString (_String const & contents, unsigned long & position) {
+    unsigned long length;
+    if (!_ParseCacheReadInteger (contents, position, length) || length > contents.length() - position) {
+        return nil;
+    }
+    _String * value = length ? new _String (contents, position, position + length - 1UL) : new _String;
+    position += length;
+    return value;
+}
+
+//____________________________________________________________________________________
+
+static void _ParseCacheRead (_hyParseCacheSession & session) {
+    // a cache file that is missing, stale or damaged in any way is ignored
+
+    FILE * cache_file = doFileOpen (session.cache_path.get_str(), "rb");
+    if (!cache_file) {
+        return;
+    }
+    _String contents (cache_file);
+    fclose (cache_file);
+
+    unsigned long position = strlen (kParseCacheMagic),
+                  format,
+                  entry_count;
+
+    if (!contents.BeginsWith (kParseCacheMagic) || !_ParseCacheReadInteger (contents, position, format) || format != kParseCacheFormat) {
+        return;
+    }
+
+    _String * signature = _ParseCacheReadString (contents, position);
+    bool      valid     = signature && *signature == session.signature && _ParseCacheReadInteger (contents, position, entry_count);
+    DeleteObject (signature);
+
+    _List     keys;
+    _List     entries;
+
+    for (unsigned long entry = 0UL; valid && entry < entry_count; entry++) {
+        _String * key  = _ParseCacheReadString (contents, position),
+                * text = key ? _ParseCacheReadString (contents, position) : nil;
+        unsigned long statement_count;
+        if (!text || !_ParseCacheReadInteger (contents, position, statement_count)) {
+            DeleteObject (key);
+            DeleteObject (text);
+            valid = false;
+            break;
+        }
+        keys.AppendNewInstance (key);
+        _List * entry_record = new _List,
+              * statements   = new _List;
+        entries.AppendNewInstance (entry_record);
+        entry_record->AppendNewInstance (text);
+        entry_record->AppendNewInstance (statements);
+        for (unsigned long s = 0UL; s < statement_count; s++) {
+            _String * statement = _ParseCacheReadString (contents, position);
+            if (!statement) {
+                valid = false;
+                break;
+            }
+            statements->AppendNewInstance (statement);
+        }
+    }
+
+    if (valid && position == contents.length()) {
+        for (unsigned long entry = 0UL; entry < keys.countitems(); entry++) {
+            // both the key and the entry are shared with the local lists
+            keys.GetItem (entry)->AddAReference();
+            session.statements.Insert (keys.GetItem (entry), (long) entries.GetItem (entry), true);
+        }
+    }
+}
+
+//____________________________________________________________________________________
+
+static void _ParseCacheWrite (_hyParseCacheSession & session) {
+    // write to a temporary file first, so that concurrent HyPhy processes never see a partial cache file
+
+    _String   temporary_path = session.cache_path & '.' & _String ((long) getpid ()) & ".tmp";
+    FILE    * cache_file     = doFileOpen (temporary_path.get_str(), "wb");
+
+    if (!cache_file) {
+        return;
+    }
+
+    fwrite (kParseCacheMagic, 1, strlen (kParseCacheMagic), cache_file);
+    _ParseCacheWriteInteger (cache_file, kParseCacheFormat);
+    _ParseCacheWriteString  (cache_file, session.signature);
+    _ParseCacheWriteInteger (cache_file, session.statements.countitems());
+
+    for (unsigned long entry = 0UL; entry < session.keys.countitems(); entry++) {
+        _List const * entry_record = (_List const*) session.statements.GetXtra (entry),
+                    * statements   = (_List const*) entry_record->GetItem (1);
+        _ParseCacheWriteString  (cache_file, *(_String const*) session.keys.GetItem (entry));
+        _ParseCacheWriteString  (cache_file, *(_String const*) entry_record->GetItem (0));
+        _ParseCacheWriteInteger (cache_file, statements->countitems());
+        for (unsigned long s = 0UL; s < statements->countitems(); s++) {
+            _ParseCacheWriteString (cache_file, *(_String const*) statements->GetItem (s));
+        }
+    }
+
+    bool written = !ferror (cache_file);
+    if (fclose (cache_file) != 0 || !written || rename (temporary_path.get_str(), session.cache_path.get_str()) != 0) {
+        remove (temporary_path.get_str());
+    }
+}
+
+//____________________________________________________________________________________
+
+bool ParseCacheBeginFile (_String const & path) {
+    _FString * directory = (_FString*) hy_env::EnvVariableGet (hy_env::parse_cache_directory, STRING);
+
+    if (!directory || directory->empty() || path.empty()) {
+        return false;
+    }
+
+    struct stat file_info;
+    if (stat (path.get_str(), &file_info) != 0) {
+        return false;
+    }
+
+    _hyParseCacheSession * session = new _hyParseCacheSession;
+
+    session->cache_path = directory->get_str();
+    if (session->cache_path.get_char (session->cache_path.length() - 1UL) != get_platform_directory_char()) {
+        session->cache_path = session->cache_path & get_platform_directory_char();
+    }
+    // name.bf._path_to_directory.hbc, so that cache files for the same batch file in different directories do not collide
+    long const file_name_start = path.FindBackwards (_String (get_platform_directory_char()), 0L, kStringEnd) + 1L;
+    session->cache_path = session->cache_path & path.Cut (file_name_start, kStringEnd) & '.'
+                          & (file_name_start > 1L ? path.Cut (0L, file_name_start - 2L).Replace (get_platform_directory_char(), '_', true) : kEmptyString) & ".hbc";
+
+    session->signature = kHyPhyVersion & '\n' & path & '\n' & _String ((long) file_info.st_mtime) & '\n'
+                         & _String ((long) file_info.st_size);
+
+    _ParseCacheRead (*session);
+    parse_cache_sessions << (long) session;
+    return true;
+}
+
+//____________________________________________________________________________________
+
+void ParseCacheEndFile (bool success) {
+    if (parse_cache_sessions.empty()) {
+        return;
+    }
+
+    _hyParseCacheSession * session = (_hyParseCacheSession*) parse_cache_sessions.Pop();
+
+    if (success && session->dirty) {
+        _ParseCacheWrite (*session);
+    }
+    delete session;
+}
+
+//____________________________________________________________________________________
+
+_List const * ParseCacheLookup (_String const & text, _hyParseCacheKey & key) {
+    key.active = parse_cache_sessions.nonempty();
+    if (!key.active) {
+        return nil;
+    }
+
+    key.hash   = _ParseCacheHash (text);
+    key.length = text.length();
+
+    _hyParseCacheSession * session = (_hyParseCacheSession*) parse_cache_sessions.Element (-1L);
+    _String  const         key_string (_ParseCacheKeyString (key.hash, key.length));
+    _List    const       * entry_record = (_List const*) session->statements.GetDataByKey (&key_string);
+
+    // the key only narrows the search down; a text with the same hash and length is not necessarily the same text
+    if (entry_record && *(_String const*) entry_record->GetItem (0) == text) {
+        return (_List const*) entry_record->GetItem (1);
+    }
+    return nil;
+}
+
+//____________________________________________________________________________________
+
+void ParseCacheStore (_hyParseCacheKey const & key, _String * text, _List * statements) {
+    if (!key.active || parse_cache_sessions.empty()) {
+        DeleteObject (text);
+        DeleteObject (statements);
+        return;
+    }
+
+    _hyParseCacheSession * session = (_hyParseCacheSession*) parse_cache_sessions.Element (-1L);
+    _String  const         key_string (_ParseCacheKeyString (key.hash, key.length));
+    _List                * entry_record = new _List;
+
+    entry_record->AppendNewInstance (text);
+    entry_record->AppendNewInstance (statements);
+
+    // an entry for a different text with the same key (which did not match on lookup) is replaced
+    long const existing = session->statements.Find (&key_string);
+    if (existing >= 0L) {
+        session->statements.SetXtra (existing, entry_record, false);
+    } else {
+        session->statements.Insert (new _String (key_string), (long) entry_record, false);
+    }
+    session->dirty = true;
+}
@@ -52,6 +52,11 @@
 #include "polynoml.h"
 #include "batchlan.h"
 #include "global_things.h"
+#include "number_format.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 using namespace hy_global;
 
@@ -80,7 +85,6 @@ _List           BuiltInFunctions;
 
 
 _SimpleList     freeSlots,
-                deferIsConstant,
                 *deferSetFormula = nil;
 
 bool            useGlobalUpdateFlag = false;
@@ -138,6 +142,13 @@ void     parameterToCharBuffer (hyFloat value, char* dump, long length, bool jso
         if (round(value) == value && fabs (value) < long_max) {
             snprintf (dump,length, "%ld",lrint (value));
         } else {
+#ifndef __USE_LONG_DOUBLE__
+            // JSON output is meant to be read back: write the shortest string that restores 'value' exactly
+            if (json && length >= kShortestDoubleLength) {
+                ShortestDoubleToChars (value, dump);
+                return;
+            }
+#endif
             snprintf (dump,length, PRINTF_FORMAT_STRING,value);
         }
     } else {
@@ -302,8 +313,34 @@ HBLObjectRef   FetchObjectFromVariableByTypeIndex (long idx, const unsigned long
 }
 
 //__________________________________________________________________________________
+/* a direct mapped cache of identifier hash -> variableNames slot;
+   entries are verified against the stored name on every hit, so they never need to be
+   invalidated: a stale entry (deleted or reused slot) simply falls through to the AVL search */
+
+static const unsigned long kVariableLookupCacheSize = 4096UL;
+static long _hy_variable_lookup_cache [kVariableLookupCacheSize];
+
 long LocateVarByName (_String const& name) {
-    return variableNames.Find (&name);
+    long * cached = _hy_variable_lookup_cache + (name.Hash() & (kVariableLookupCacheSize - 1UL));
+    long   slot   = *cached - 1L;
+    
+    if (slot >= 0L && slot < (long)varNamesSupportList.lLength) {
+        _String const * stored = (_String const*)varNamesSupportList.list_data[slot];
+        if (stored && *stored == name) {
+            return slot;
+        }
+    }
+    
+    slot = variableNames.Find (&name);
+    
+#ifdef _OPENMP
+    if (slot >= 0L && !omp_in_parallel()) {
+#else
+    if (slot >= 0L) {
+#endif
+        *cached = slot + 1L;
+    }
+    return slot;
 }
 
 //__________________________________________________________________________________
@@ -416,6 +453,8 @@ void DeleteVariable (long dv, bool deleteself, bool do_checks) {
 
             variableNames.Delete (variableNames.Retrieve(dv),true);
             variablePtrs[vidx] = nil;
+            variableChangeStamp++;
+            variableSlotStamp++;
             DeleteObject (self_variable);
             freeSlots<<vidx;
         } else {
@@ -486,6 +525,7 @@ void DeleteTreeVariable (long dv, _SimpleList & parms, bool doDeps)
         if (delvar->ObjectClass() != TREE) {
             variableNames.Delete (variableNames.Retrieve(dv),true);
             (*((_SimpleList*)&variablePtrs))[vidx]=0;
+            variableSlotStamp++;
             freeSlots<<vidx;
             DeleteObject (delvar);
         } else {
@@ -679,6 +719,7 @@ void  InsertVar (_Variable* theV) {
         variablePtrs&&theV;
     }
     variableNames.SetXtra (pos, theV->theIndex);
+    variableChangeStamp++;
 }
 
 //__________________________________________________________________________________
@@ -738,6 +779,10 @@ void  RenameVariable (_String* oldName, _String* newName)
         variableNames.Insert (thisVar->GetName(),xtras.list_data[k]);
         thisVar->GetName()->AddAReference();
     }
+    
+    if (toRename.nonempty()) {
+        variableSlotStamp++;
+    }
 }
 
 //__________________________________________________________________________________
@@ -747,6 +792,7 @@ void  ReplaceVar (_Variable* theV) {
         pos = variableNames.GetXtra(pos);
         UpdateChangingFlas   (pos);
         variablePtrs.Replace (pos,theV,true);
+        variableChangeStamp++;
     } else {
         InsertVar (theV);
     }
@@ -792,7 +838,8 @@ void    SetupOperationLists (void) {
              "Simplex" <
              "Type" <
              "Eval" <
-             "LnGamma";
+             "LnGamma" <
+             "ParseJSON";
  
 
     BinOps<<'|'*256+'|';
@@ -857,9 +904,13 @@ void    SetupOperationLists (void) {
 
         //HY_OP_CODE_IDIV
         BuiltInFunctions.AppendNewInstance (new _String ('$'));
+        simpleOperationCodes    << HY_OP_CODE_IDIV;
+        simpleOperationFunctions<< (long)IntDivNumbers;
 
         //HY_OP_CODE_MOD
         BuiltInFunctions.AppendNewInstance (new _String ('%'));
+        simpleOperationCodes    << HY_OP_CODE_MOD;
+        simpleOperationFunctions<< (long)ModNumbers;
 
         //HY_OP_CODE_REF
         BuiltInFunctions.AppendNewInstance (new _String ('&'));
@@ -1050,6 +1101,9 @@ void    SetupOperationLists (void) {
         BuiltInFunctions.AppendNewInstance (new _String ("PSTreeString"));
         FunctionNameList.Insert (*(_String*)BuiltInFunctions (HY_OP_CODE_PSTREESTRING), 3L);
 
+        //HY_OP_CODE_PARSEJSON
+        BuiltInFunctions.AppendNewInstance (new _String ("ParseJSON"));
+
 
         //HY_OP_CODE_RANDOM
         BuiltInFunctions.AppendNewInstance (new _String ("Random"));
@@ -1132,7 +1186,7 @@ void    SetupOperationLists (void) {
 
 void  FinishDeferredSF (void) {
     if (deferSetFormula->nonempty()) {
-        SortLists (deferSetFormula, &deferIsConstant);
+        deferSetFormula->Sort();
         
         for (AVLListXIteratorKeyValue variable_record : AVLListXIterator (&variableNames)) {
             _Variable * theV = LocateVar(variable_record.get_value());
@@ -1145,7 +1199,7 @@ void  FinishDeferredSF (void) {
             if (((_String*)likeFuncNamesList(idx))->nonempty()) {
                 _LikelihoodFunction * lf = (_LikelihoodFunction*)lf_object;
                 for (long k = 0L; k < deferSetFormula->countitems(); k++) {
-                    lf->UpdateIndependent(deferSetFormula->get(k),deferIsConstant.get(k));
+                    lf->UpdateIndependent(deferSetFormula->get(k),true);
                 }
             }
         });
@@ -1155,5 +1209,4 @@ void  FinishDeferredSF (void) {
     }
     DeleteObject (deferSetFormula);
     deferSetFormula = nil;
-    deferIsConstant.Clear();
 }
@@ -120,18 +120,153 @@ hyFloat  MaxNumbers  (hyFloat x, hyFloat y) {
 hyFloat  MinNumbers  (hyFloat x, hyFloat y) {
     return x<y?x:y;
 }
+hyFloat  IntDivNumbers (hyFloat x, hyFloat y) {
+    long denom = y;
+    return denom != 0L ? (long(x) / denom) : 0.0;
+}
+hyFloat  ModNumbers  (hyFloat x, hyFloat y) {
+    long denom = y;
+    return denom != 0L ? (long(x) % denom) : x;
+}
 hyFloat  ExpNumbers  (hyFloat x) {
     return exp(x);
 }
 hyFloat  LogNumbers  (hyFloat x) {
     return log(x);
 }
+//__________________________________________________________________________________
+/*
+    Element access for compiled formulas. The container argument is the object
+    placed into the value array by PopulateArraysForASimpleFormula; dense numeric
+    matrices are read and written directly, everything else goes through the
+    same operations the interpreter would use, and reads must produce a number.
+*/
+
+static hyFloat  _SimpleAccessResult (HBLObjectRef result) {
+    hyFloat value = 0.0;
+    if (result->ObjectClass() == NUMBER) {
+        value = result->Value();
+    } else {
+        _FString * type = (_FString*)result->Type();
+        HandleApplicationError (_String ("Compiled code expected a numeric value from [], but got a ") & type->get_str());
+        DeleteObject (type);
+    }
+    DeleteObject (result);
+    return value;
+}
+
+static hyFloat  _SimpleAccessFallback (HBLObjectRef container, HBLObjectRef index, HBLObjectRef index2 = nil) {
+    _List arguments;
+    arguments << index;
+    if (index2) {
+        arguments << index2;
+    }
+    return _SimpleAccessResult (container->ExecuteSingleOp (HY_OP_CODE_MACCESS, &arguments));
+}
+
+static void  _SimpleMatrixStore (_Matrix * m, long row, long column, hyFloat value) {
+    if (m->CheckCoordinates (row, column)) {
+        _Formula value_formula (new _Constant (value));
+        m->MStore (row, column, value_formula);
+        m->CheckIfSparseEnough();
+    }
+}
+
+static inline bool  _IsDenseNumericMatrix (HBLObjectRef container) {
+    return container->ObjectClass() == MATRIX && ((_Matrix*)container)->is_dense() && ((_Matrix*)container)->is_numeric();
+}
+
+//__________________________________________________________________________________
 hyFloat  FastMxAccess(hyPointer m, hyFloat index) {
-    return ((hyFloat*)m)[(unsigned long)index];
+    HBLObjectRef container = (HBLObjectRef)m;
+    long         i         = index;
+    if (_IsDenseNumericMatrix (container)) {
+        _Matrix * mx = (_Matrix*)container;
+        if (i >= 0L && i < mx->GetHDim() * mx->GetVDim()) {
+            return mx->theData[i];
+        }
+    }
+    _Constant key (index);
+    return _SimpleAccessFallback (container, &key);
 }
 
+//__________________________________________________________________________________
 void  FastMxWrite(hyPointer m, hyFloat index, hyFloat value) {
-  ((hyFloat*)m)[(unsigned long)index] = value;
+    HBLObjectRef container = (HBLObjectRef)m;
+    long         i         = index;
+    switch (container->ObjectClass()) {
+        case MATRIX: {
+            _Matrix * mx = (_Matrix*)container;
+            if (_IsDenseNumericMatrix (container) && i >= 0L && i < mx->GetHDim() * mx->GetVDim()) {
+                mx->theData[i] = value;
+            } else {
+                _SimpleMatrixStore (mx, i, -1L, value);
+            }
+            return;
+        }
+        case ASSOCIATIVE_LIST: {
+            _Constant key (index);
+            ((_AssociativeList*)container)->MStore (_String ((_String*)key.toStr()), new _Constant (value), false);
+            return;
+        }
+    }
+    HandleApplicationError ("Matrix/List LHS expected but not supplied.");
+}
+
+//__________________________________________________________________________________
+hyFloat  FastMxAccess2D (hyPointer m, hyFloat row, hyFloat column) {
+    HBLObjectRef container = (HBLObjectRef)m;
+    long         r         = row,
+                 c         = column;
+    if (_IsDenseNumericMatrix (container)) {
+        _Matrix * mx = (_Matrix*)container;
+        if (r >= 0L && c >= 0L && r < mx->GetHDim() && c < mx->GetVDim()) {
+            return mx->theData[r * mx->GetVDim() + c];
+        }
+    }
+    _Constant key (row), key2 (column);
+    return _SimpleAccessFallback (container, &key, &key2);
+}
+
+//__________________________________________________________________________________
+void  FastMxWrite2D (hyPointer m, hyFloat row, hyFloat column, hyFloat value) {
+    HBLObjectRef container = (HBLObjectRef)m;
+    long         r         = row,
+                 c         = column;
+    if (container->ObjectClass() == MATRIX) {
+        _Matrix * mx = (_Matrix*)container;
+        if (_IsDenseNumericMatrix (container) && r >= 0L && c >= 0L && r < mx->GetHDim() && c < mx->GetVDim()) {
+            mx->theData[r * mx->GetVDim() + c] = value;
+        } else {
+            _SimpleMatrixStore (mx, r, c, value);
+        }
+        return;
+    }
+    HandleApplicationError ("Matrix expected but not supplied.");
+}
+
+//__________________________________________________________________________________
+hyFloat  FastDictAccess (hyPointer d, hyPointer key) {
+    HBLObjectRef container = (HBLObjectRef)d;
+    if (container->ObjectClass() == ASSOCIATIVE_LIST) {
+        HBLObjectRef value = ((_AssociativeList*)container)->GetByKey (((_FString*)key)->get_str());
+        if (!value) {
+            return 0.0;
+        }
+        value->AddAReference();
+        return _SimpleAccessResult (value);
+    }
+    return _SimpleAccessFallback (container, (HBLObjectRef)key);
+}
+
+//__________________________________________________________________________________
+void  FastDictWrite (hyPointer d, hyPointer key, hyFloat value) {
+    HBLObjectRef container = (HBLObjectRef)d;
+    if (container->ObjectClass() == ASSOCIATIVE_LIST) {
+        ((_AssociativeList*)container)->MStore ((HBLObjectRef)key, new _Constant (value), false);
+        return;
+    }
+    HandleApplicationError ("Matrix/List LHS expected but not supplied.");
 }
 
 hyFloat  AndNumbers  (hyFloat x, hyFloat y) {
@@ -163,15 +298,43 @@ hyFloat  EqualNumbers(hyFloat a, hyFloat b) {
 }
 
 //_______________________________________________________________________________________
-void        PopulateArraysForASimpleFormula (_SimpleList& vars, _SimpleFormulaDatum* values) {
+void        PopulateArraysForASimpleFormula (_SimpleList& vars, _SimpleFormulaDatum* values, _SimpleList const * containers, _SimpleList const * checked, bool * checked_numeric) {
+    /* 'checked' variables (sorted value array indices) may hold values of any type;
+       if one of them is not a number, *checked_numeric is set to false and the
+       formulae that read them must not be computed from the array */
     try {
+        unsigned long next_container = 0UL,
+                      next_checked   = 0UL;
+        if (checked_numeric) {
+            *checked_numeric = true;
+        }
         vars.Each ([&] (long var_index, unsigned long array_index) -> void {
             HBLObjectRef var_value = LocateVar (var_index)->Compute();
+            bool         is_indexed = false,
+                         is_checked = false;
+          
+            if (checked && next_checked < checked->countitems() && checked->get (next_checked) == (long)array_index) {
+                next_checked++;
+                is_checked = true;
+            }
+          
+            if (containers && next_container < containers->countitems() && containers->get (next_container) == (long)array_index) {
+                next_container++;
+                is_indexed = true;
+                if ((var_value->ObjectClass() & (MATRIX | ASSOCIATIVE_LIST)) == 0UL) {
+                    throw (_String ("Compiled code expected ") & LocateVar (var_index)->GetName()->Enquote() & " to be a matrix or a dictionary");
+                }
+            }
+          
             if (var_value->ObjectClass() == NUMBER) {
                 values[array_index].value = var_value->Value();
+            } else if (is_checked) {
+                values[array_index].value = 0.0;
+                *checked_numeric = false;
             } else {
-                if (var_value->ObjectClass() == MATRIX) {
-                    values[array_index].reference = (hyPointer)((_Matrix*)var_value)->theData;
+                if (var_value->ObjectClass() == MATRIX || (is_indexed && var_value->ObjectClass() == ASSOCIATIVE_LIST)) {
+                    // containers are passed by reference; see FastMxAccess
+                    values[array_index].reference = (hyPointer)var_value;
                 } else {
                     throw (_String("Internal error in PopulateArraysForASimpleFormula; this means that a prospectively compiled batch code was passed arguments it does not support (e.g. a dict argument to a cfunction)"));
                 }
@@ -200,6 +363,22 @@ void        WarnWrongNumberOfArguments (HBLObjectRef p, long opCode, _hyExecutio
 }
 
 
+//__________________________________________________________________________________
+
+static HBLObjectRef  _ValueForAssignment (HBLObjectRef value) {
+    /** a container value (matrix, dictionary or string) that is referenced only
+        by the evaluation stack of the formula that produced it (the result of an
+        operation or a function call) is a temporary; the receptacle can share it
+        instead of making a deep copy. Anything else is copied, so that the
+        assignment still has value semantics. */
+    
+    if (value->CanFreeMe() && (value->ObjectClass() & (MATRIX | ASSOCIATIVE_LIST | STRING))) {
+        value->AddAReference();
+        return value;
+    }
+    return (HBLObjectRef)value->makeDynamic();
+}
+
 //__________________________________________________________________________________
 
 long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference, _VariableContainer* nameSpace, char assignment_type) {
@@ -224,7 +403,7 @@ long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference,
         if (code == HY_FORMULA_VARIABLE_VALUE_ASSIGNMENT) {
             // copy by value or by reference?
             //formulaValue->AddAReference();
-            LocateVar (reference)->SetValue (formulaValue);
+            LocateVar (reference)->SetValue (_ValueForAssignment (formulaValue), false);
             return 1;
         }
 
@@ -232,7 +411,7 @@ long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference,
             _hyExecutionContext localContext (nameSpace);
             _Variable * theV = f->Dereference(assignment_type == kStringGlobalDeference, &localContext);
             if (theV) {
-                theV->SetValue (formulaValue);
+                theV->SetValue (_ValueForAssignment (formulaValue), false);
             } else {
                 return 0;
             }
@@ -305,6 +484,7 @@ long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference,
 
     if ( code== HY_FORMULA_FORMULA_FORMULA_ASSIGNMENT || code== HY_FORMULA_FORMULA_VALUE_ASSIGNMENT || code == HY_FORMULA_FORMULA_VALUE_INCREMENT) {
         _Formula newF;
+        HBLObjectRef rhs_value = nil;
 
         if (f2->IsEmpty()) {
             HandleApplicationError ("Empty RHS in an assignment.");
@@ -314,7 +494,8 @@ long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference,
         if (code == HY_FORMULA_FORMULA_FORMULA_ASSIGNMENT) {
             newF.DuplicateReference(f2);
         } else {
-            newF.theFormula.AppendNewInstance(new _Operation((HBLObjectRef)f2->Compute(0, nameSpace)->makeDynamic()));
+            rhs_value = _ValueForAssignment (f2->Compute(0, nameSpace));
+            newF.theFormula.AppendNewInstance(new _Operation(rhs_value));
         }
 
         long stackD = -1L,
@@ -400,7 +581,13 @@ long       ExecuteFormula (_Formula*f , _Formula* f2, long code, long reference,
                 mmx->CheckIfSparseEnough();
             }
         } else if (mma) { // Associative array LHS
-            mma->MStore (coordMx, newF.Compute(), true, (code==HY_FORMULA_FORMULA_VALUE_INCREMENT)?HY_OP_CODE_ADD:HY_OP_CODE_NONE);
+            if (rhs_value) {
+                // store the already copied value, rather than a copy of it
+                rhs_value->AddAReference();
+                mma->MStore (coordMx, rhs_value, false, (code==HY_FORMULA_FORMULA_VALUE_INCREMENT)?HY_OP_CODE_ADD:HY_OP_CODE_NONE);
+            } else {
+                mma->MStore (coordMx, newF.Compute(), true, (code==HY_FORMULA_FORMULA_VALUE_INCREMENT)?HY_OP_CODE_ADD:HY_OP_CODE_NONE);
+            }
         }
 
         return 1;
@@ -0,0 +1,430 @@
+/*
+ 
+ HyPhy - Hypothesis Testing Using Phylogenies.
+ 
+ Copyright (C) 1997-now
+ Core Developers:
+ Sergei L Kosakovsky Pond (sergeilkp@icloud.com)
+ Art FY Poon    (apoon42@uwo.ca)
+ Steven Weaver (sweaver@temple.edu)
+ 
+ Module Developers:
+ Lance Hepler (nlhepler@gmail.com)
+ Martin Smith (martin.audacis@gmail.com)
+ 
+ Significant contributions from:
+ Spencer V Muse (muse@stat.ncsu.edu)
+ Simon DW Frost (sdf22@cam.ac.uk)
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ */
+
+#include "sampling_profiler.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "batchlan.h"
+#include "global_things.h"
+#include "hy_string_buffer.h"
+
+#if defined __UNIX__ && !defined __MINGW32__
+    #define __HYPHY_SAMPLING_PROFILER__
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+using namespace hy_global;
+
+bool                      hy_sampling_profiler_active = false;
+
+#ifdef __HYPHY_SAMPLING_PROFILER__
+
+static  const long        kProfilerMaxFrames       = 256L,
+                          kProfilerMaxPhases       = 16L,
+                          kProfilerMaxKey          = 2L + 3L * kProfilerMaxFrames + kProfilerMaxPhases,
+                          kProfilerTableSize       = 1L << 16,        // distinct stacks; must be a power of 2
+                          kProfilerArenaSize       = 1L << 22,        // longs available to store distinct stacks
+                          kProfilerIntervalUSec    = 1000L;
+
+static  char const *      kProfilerPhaseNames [kProfilerPhaseCount] = {"[optimizer]", "[likelihood]", "[exponentiate]", "[prune]", "[io]"};
+
+struct  _hyProfilerStack {
+    unsigned long         hash,
+                          offset,   // in profiler_arena
+                          length,
+                          count;    // 0 for an unused slot
+};
+
+/* the current HBL call stack and native phase stack; written by the main thread,
+   read by the SIGPROF handler (on whichever thread receives it) */
+
+static  _ExecutionList *  profiler_lists       [kProfilerMaxFrames];
+static  long              profiler_frames       [kProfilerMaxFrames],   // index into profiler_frame_names
+                          profiler_call_sites   [kProfilerMaxFrames],   // currentCommand of frame i when frame i+1 was entered
+                          profiler_phase_starts [kProfilerMaxFrames];   // profiler_phase_depth when frame i was entered
+static  unsigned char     profiler_phases       [kProfilerMaxPhases];
+
+/* phases entered while frame i was the innermost frame (indices profiler_phase_starts[i] to
+   profiler_phase_starts[i+1]) follow frame i in a sample; e.g. an HBL function called back
+   from the optimizer is reported as ...;[optimizer];callback:3, not as running in [optimizer] itself */
+
+static  volatile long     profiler_depth       = 0L,
+                          profiler_phase_depth = 0L;
+
+/* sample storage, preallocated by StartSamplingProfiler */
+
+static  _hyProfilerStack* profiler_table       = nil;
+static  long*             profiler_arena       = nil;
+static  unsigned long     profiler_arena_used  = 0UL,
+                          profiler_table_used  = 0UL,
+                          profiler_samples     = 0UL,
+                          profiler_dropped     = 0UL;
+static  int               profiler_busy        = 0;
+
+static  _List             profiler_frame_names;
+static  _String           profiler_path;
+static  pid_t             profiler_owner;
+static  struct sigaction  profiler_stashed_action;
+
+//____________________________________________________________________________________
+
+static void _SamplingProfilerSignal (int) {
+    if (__sync_lock_test_and_set (&profiler_busy, 1)) {
+        // another thread is recording a sample
+        __sync_fetch_and_add (&profiler_dropped, 1UL);
+        return;
+    }
+
+    int             saved_errno = errno;
+    long            key [kProfilerMaxKey],
+                    length = 0L,
+                    depth  = profiler_depth,
+                    phases = profiler_phase_depth,
+                    phase  = 0L;
+
+    if (depth > kProfilerMaxFrames) {
+        depth = kProfilerMaxFrames;
+    }
+    if (phases > kProfilerMaxPhases) {
+        phases = kProfilerMaxPhases;
+    }
+
+    /* the key is: the number of phases entered before the outermost frame, those phases,
+       the number of frames, then for each frame: its name, its current statement,
+       the number of phases it entered, and those phases */
+
+    auto add_phases = [&] (long until) -> void {
+        until = MIN (MAX (until, phase), phases);
+        key [length++] = until - phase;
+        for (; phase < until; phase++) {
+            key [length++] = profiler_phases[phase];
+        }
+    };
+
+    add_phases (depth > 0L ? profiler_phase_starts[0] : phases);
+    key [length++] = depth;
+    for (long i = 0L; i < depth; i++) {
+        key [length++] = profiler_frames[i];
+        if (i + 1L < depth) {
+            key [length++] = profiler_call_sites[i];
+            add_phases (profiler_phase_starts[i + 1L]);
+        } else {
+            key [length++] = profiler_lists[i] ? profiler_lists[i]->currentCommand : 0L;
+            add_phases (phases);
+        }
+    }
+
+    unsigned long hash = 0x811C9DC5UL;
+    for (long i = 0L; i < length; i++) {
+        hash = (hash ^ (unsigned long)key[i]) * 0x01000193UL;
+    }
+
+    profiler_samples ++;
+
+    for (unsigned long probe = 0UL, slot = hash & (kProfilerTableSize - 1L); probe < kProfilerTableSize; probe++, slot = (slot + 1UL) & (kProfilerTableSize - 1L)) {
+        _hyProfilerStack & entry = profiler_table[slot];
+        if (entry.count == 0UL) {
+            if (profiler_table_used * 4UL >= kProfilerTableSize * 3UL || profiler_arena_used + length > kProfilerArenaSize) {
+                profiler_dropped ++;
+            } else {
+                memcpy (profiler_arena + profiler_arena_used, key, length * sizeof (long));
+                entry.hash    = hash;
+                entry.offset  = profiler_arena_used;
+                entry.length  = length;
+                entry.count   = 1UL;
+                profiler_arena_used += length;
+                profiler_table_used ++;
+            }
+            break;
+        }
+        if (entry.hash == hash && entry.length == (unsigned long)length && memcmp (profiler_arena + entry.offset, key, length * sizeof (long)) == 0) {
+            entry.count ++;
+            break;
+        }
+    }
+
+    errno = saved_errno;
+    __sync_lock_release (&profiler_busy);
+}
+
+//____________________________________________________________________________________
+
+static long _SamplingProfilerFrameName (_ExecutionList const * list) {
+    /* function bodies are labeled with the function name and the file that defined it,
+       other execution lists with the name of the file they were read from */
+
+    _String      file_name = list->GetFileName();
+    long         separator = file_name.FindBackwards ("/");
+    if (separator != kNotFound) {
+        file_name.Trim (separator + 1L, kStringEnd);
+    }
+
+    _StringBuffer * label = new _StringBuffer;
+
+    for (unsigned long i = 0UL; i < batchLanguageFunctions.countitems(); i++) {
+        if (batchLanguageFunctions.GetItem (i) == list) {
+            (*label) << GetBFFunctionNameByIndex (i);
+            break;
+        }
+    }
+
+    if (label->empty() && list->sourceFile.nonempty()) {
+        (*label) << file_name;
+    } else {
+        if (label->empty()) {
+            (*label) << "ExecuteCommands";
+        }
+        if (file_name.nonempty()) {
+            (*label) << " (" << file_name << ')';
+        }
+    }
+
+    // ';' separates frames in the output
+    for (unsigned long i = 0UL; i < label->length(); i++) {
+        if (label->char_at (i) == ';') {
+            label->set_char (i, ',');
+        }
+    }
+
+    profiler_frame_names < label;
+    return profiler_frame_names.countitems() - 1L;
+}
+
+#endif
+
+//____________________________________________________________________________________
+
+bool StartSamplingProfiler (_String const & path) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+    if (hy_sampling_profiler_active) {
+        return true;
+    }
+
+    profiler_path = path;
+#ifdef __HYPHYMPI__
+    if (hy_mpi_node_rank > 0) {
+        profiler_path = profiler_path & '.' & _String ((long)hy_mpi_node_rank);
+    }
+#endif
+
+    FILE * test_output = doFileOpen (profiler_path.get_str(), "w");
+    if (!test_output) {
+        return false;
+    }
+    fclose (test_output);
+
+    profiler_table = (_hyProfilerStack*) calloc (kProfilerTableSize, sizeof (_hyProfilerStack));
+    profiler_arena = (long*) malloc (kProfilerArenaSize * sizeof (long));
+    if (!profiler_table || !profiler_arena) {
+        free (profiler_table);
+        free (profiler_arena);
+        profiler_table = nil;
+        profiler_arena = nil;
+        return false;
+    }
+
+    profiler_owner              = getpid ();
+    profiler_depth              = 0L;
+    profiler_phase_depth        = 0L;
+    hy_sampling_profiler_active = true;
+
+    struct sigaction handler;
+    memset (&handler, 0, sizeof (handler));
+    handler.sa_handler = _SamplingProfilerSignal;
+    handler.sa_flags   = SA_RESTART;
+    sigemptyset (&handler.sa_mask);
+    sigaction   (SIGPROF, &handler, &profiler_stashed_action);
+
+    struct itimerval interval;
+    interval.it_interval.tv_sec  = 0;
+    interval.it_interval.tv_usec = kProfilerIntervalUSec;
+    interval.it_value            = interval.it_interval;
+    setitimer (ITIMER_PROF, &interval, nil);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//____________________________________________________________________________________
+
+void StopSamplingProfiler (void) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+    if (!hy_sampling_profiler_active) {
+        return;
+    }
+
+    hy_sampling_profiler_active = false;
+
+    if (getpid () != profiler_owner) {
+        // a forked worker (see local_workers.cpp); the parent writes the profile
+        return;
+    }
+
+    struct itimerval stop;
+    memset    (&stop, 0, sizeof (stop));
+    setitimer (ITIMER_PROF, &stop, nil);
+    sigaction (SIGPROF, &profiler_stashed_action, nil);
+
+    FILE * output = doFileOpen (profiler_path.get_str(), "w");
+
+    if (output) {
+        for (unsigned long slot = 0UL; slot < kProfilerTableSize; slot++) {
+            _hyProfilerStack const & entry = profiler_table[slot];
+            if (entry.count == 0UL) {
+                continue;
+            }
+
+            long const *  key    = profiler_arena + entry.offset;
+            _StringBuffer stack (256UL);
+
+            auto add_phases = [&] (void) -> void {
+                for (long phases = *key++; phases > 0L; phases--) {
+                    if (stack.nonempty()) {
+                        stack << ';';
+                    }
+                    stack << kProfilerPhaseNames[*key++];
+                }
+            };
+
+            add_phases ();
+            for (long depth = *key++; depth > 0L; depth--) {
+                if (stack.nonempty()) {
+                    stack << ';';
+                }
+                stack << *(_String*)profiler_frame_names.GetItem (key[0]) << ':' << _String (key[1] > 0L ? key[1] : 1L);
+                key += 2;
+                add_phases ();
+            }
+
+            if (stack.empty()) {
+                stack << "[native]";
+            }
+
+            fprintf (output, "%s %lu\n", stack.get_str(), entry.count);
+        }
+        fclose (output);
+    }
+
+    ReportWarning (_String ("Sampling profiler recorded ") & _String ((long)profiler_samples) & " samples (" & _String ((long)profiler_dropped) & " dropped) in " & _String ((long)profiler_table_used) & " distinct stacks; written to " & profiler_path.Enquote());
+
+    free (profiler_table);
+    free (profiler_arena);
+    profiler_table = nil;
+    profiler_arena = nil;
+    profiler_arena_used = profiler_table_used = profiler_samples = profiler_dropped = 0UL;
+    profiler_frame_names.Clear();
+#endif
+}
+
+//____________________________________________________________________________________
+
+long SamplingProfilerEnter (_ExecutionList * list) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+#ifdef _OPENMP
+    if (omp_in_parallel()) {
+        return -1L;
+    }
+#endif
+    long depth = profiler_depth;
+    if (depth < kProfilerMaxFrames) {
+        if (list->profile_frame < 0L) {
+            list->profile_frame = _SamplingProfilerFrameName (list);
+        }
+        profiler_frames [depth] = list->profile_frame;
+        profiler_lists  [depth] = list;
+        if (depth > 0L) {
+            profiler_call_sites [depth - 1L] = profiler_lists [depth - 1L]->currentCommand;
+        }
+        profiler_phase_starts [depth] = profiler_phase_depth;
+    }
+    profiler_depth = depth + 1L;
+    return depth;
+#else
+    return -1L;
+#endif
+}
+
+//____________________________________________________________________________________
+
+void SamplingProfilerLeave (long depth) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+    if (depth >= 0L) {
+        profiler_depth = depth;
+    }
+#endif
+}
+
+//____________________________________________________________________________________
+
+long SamplingProfilerPushPhase (_hyProfilerPhaseID phase) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+#ifdef _OPENMP
+    if (omp_in_parallel()) {
+        return -1L;
+    }
+#endif
+    long depth = profiler_phase_depth;
+    if (depth < kProfilerMaxPhases) {
+        profiler_phases [depth] = (unsigned char) phase;
+    }
+    profiler_phase_depth = depth + 1L;
+    return depth;
+#else
+    return -1L;
+#endif
+}
+
+//____________________________________________________________________________________
+
+void SamplingProfilerPopPhase (long depth) {
+#ifdef __HYPHY_SAMPLING_PROFILER__
+    profiler_phase_depth = depth;
+#endif
+}
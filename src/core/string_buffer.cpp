@@ -48,8 +48,7 @@ using namespace hy_global;
 #include <utility>  // for std::move
 
 
-unsigned char               _StringBuffer::preallocated_buffer [_HY_STRING_BUFFER_PREALLOCATE_SLOTS*sizeof (_StringBuffer)];
-_SimpleList                 _StringBuffer::free_slots;
+static _hyObjectPool <_StringBuffer, _HY_STRING_BUFFER_PREALLOCATE_SLOTS>    _hy_string_buffer_pool;
 
 
 /*
@@ -485,30 +484,18 @@ void _StringBuffer::AppendVariableValueAVL (_String const* id, _SimpleList const
 
 //__________________________________________________________________________________
 void * _StringBuffer::operator new (size_t size) {
-    if (_StringBuffer::free_slots.nonempty()) {
-        _StringBuffer * result = (_StringBuffer *)(_StringBuffer::preallocated_buffer) + _StringBuffer::free_slots.Pop();
-        //printf ("Allocate slot %ld\n", _StringBuffer::free_slots.get (_StringBuffer::free_slots.countitems()));
-        //result->Initialize();
-        return result;
-    }
-    //printf ("Allocating string buffer %ld\n", size);
-    return ::operator new(size);
+    return _hy_string_buffer_pool.Allocate (size);
 }
 
 
 //__________________________________________________________________________________
-void  _StringBuffer::operator delete (void * p) {
-    _StringBuffer * sb = (_StringBuffer*) p,
-                  * sbb = (_StringBuffer *)_StringBuffer::preallocated_buffer;
-    
-    if (sb >= sbb &&  sb < (sbb+ _HY_STRING_BUFFER_PREALLOCATE_SLOTS)) {
-        //printf ("Free slot %ld\n", ((long)(sb - _StringBuffer::preallocated_buffer)));
-        //sb->_StringBuffer::Clear();
-        free_slots << ((long)(sb - sbb));
-    } else {
-        //printf ("%p\n", p);
-        ::operator delete (p);
-    }
+void  _StringBuffer::operator delete (void * p, size_t size) {
+    _hy_string_buffer_pool.Release (p, size);
+}
+
+//__________________________________________________________________________________
+_hyObjectPoolStatistics const & _StringBuffer::PoolStatistics (void) {
+    return _hy_string_buffer_pool.Statistics();
 }
 
 
@@ -37,18 +37,51 @@
  
  */
 
+#include <string.h>
+
 #include "string_file_wrapper.h"
 
 StringFileWrapper::StringFileWrapper (_StringBuffer *string, FILE *file) {
   string_buffer = string;
-  file_buffer = file;
+  file_buffer = string ? nil : file;
+  file_cache = file_buffer ? new char [kFileCacheSize] : nil;
+  file_cache_used = 0UL;
+}
+
+StringFileWrapper::~StringFileWrapper (void) {
+  Flush ();
+  delete [] file_cache;
+}
+
+void StringFileWrapper::Flush (void) {
+  if (file_cache_used) {
+    fwrite (file_cache, 1, file_cache_used, file_buffer);
+    file_cache_used = 0UL;
+  }
+}
+
+StringFileWrapper& StringFileWrapper::Write (const char* buffer, unsigned long length) {
+  if (string_buffer) {
+    string_buffer->PushCharBuffer (buffer, length);
+  } else if (file_buffer) {
+    if (file_cache_used + length > kFileCacheSize) {
+      Flush ();
+      if (length > kFileCacheSize) {
+        fwrite (buffer, 1, length, file_buffer);
+        return *this;
+      }
+    }
+    memcpy (file_cache + file_cache_used, buffer, length);
+    file_cache_used += length;
+  }
+  return *this;
 }
 
 StringFileWrapper& StringFileWrapper::operator << (const char* buffer) {
   if (string_buffer) {
     *string_buffer << buffer;
   } else if (file_buffer) {
-    fprintf (file_buffer, buffer);
+    Write (buffer, strlen (buffer));
   }
   return *this;
 }
@@ -57,18 +90,16 @@ StringFileWrapper& StringFileWrapper::operator << (const char letter) {
   if (string_buffer) {
     *string_buffer << letter;
   } else if (file_buffer) {
-    fputc (letter, file_buffer);
+    if (file_cache_used == kFileCacheSize) {
+      Flush ();
+    }
+    file_cache [file_cache_used++] = letter;
   }
   return *this;
 }
 
 StringFileWrapper& StringFileWrapper::operator << (const _String& buffer) {
-  if (string_buffer) {
-    *string_buffer << buffer;
-  } else if (file_buffer) {
-    fprintf (file_buffer, "%s", (const char*)buffer);
-  }
-  return *this;
+  return Write (buffer.get_str(), buffer.length());
 }
 
 StringFileWrapper& StringFileWrapper::operator << (const _String* buffer) {
@@ -76,31 +107,13 @@ StringFileWrapper& StringFileWrapper::operator << (const _String* buffer) {
 }
 
 StringFileWrapper& StringFileWrapper::operator << (const StringFileWrapperConstants& special) {
-  if (string_buffer) {
-    switch (special) {
-      case kStringFileWrapperNewLine:
-        *string_buffer << '\n';
-        break;
-      case kStringFileWrapperLinefeed:
-        *string_buffer << '\r';
-        break;
-      case kStringFileWrapperTab:
-        *string_buffer << '\t';
-        break;
-    }
-  } else if (file_buffer) {
-    switch (special) {
-      case kStringFileWrapperNewLine:
-        fputc ('\n', file_buffer);
-        break;
-      case kStringFileWrapperLinefeed:
-        fputc ('\r', file_buffer);
-       break;
-      case kStringFileWrapperTab:
-        fputc ('\t', file_buffer);
-       break;
-    }
+  switch (special) {
+    case kStringFileWrapperNewLine:
+      return (*this) << '\n';
+    case kStringFileWrapperLinefeed:
+      return (*this) << '\r';
+    case kStringFileWrapperTab:
+      return (*this) << '\t';
   }
   return *this;
 }
-
@@ -50,6 +50,10 @@
 #include "function_templates.h"
 #include "hy_string_buffer.h"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 
 _String   compileDate = __DATE__,
           __HYPHY__VERSION__ = _String ("2.5.0");
@@ -475,6 +479,11 @@ const _String _String::FormatTimeString(long time_diff){
 
 hyComparisonType _String::Compare(_String const& rhs) const {
     
+    if (this == &rhs) {
+        // shared keys/identifiers are frequently compared against themselves
+        return kCompareEqual;
+    }
+    
     if (s_length <= rhs.s_length) {
         for (unsigned long i = 0UL; i < s_length; i++) {
             int diff = s_data[i] - rhs.s_data[i];
@@ -554,14 +563,24 @@ hyComparisonType _String::CompareIgnoringCase(_String const& rhs) const {
 
 //=============================================================
 
-bool _String::operator==(const _String& s) const { return Compare  (s) == kCompareEqual; }
+unsigned long _String::Hash(void) const {
+    unsigned long h = 2166136261UL;
+    for (unsigned long i = 0UL; i < s_length; i++) {
+        h = ((h ^ (unsigned char)s_data[i]) * 16777619UL) & 0xffffffffUL;
+    }
+    return h;
+}
+
+//=============================================================
+
+bool _String::operator==(const _String& s) const { return s_length == s.s_length && Compare  (s) == kCompareEqual; }
 bool _String::operator>(const _String & s) const { return Compare  (s) == kCompareGreater; }
 bool _String::operator<=(const _String & s) const { return Compare (s) != kCompareGreater; }
 bool _String::operator>=(const _String & s) const { return Compare (s) != kCompareLess; }
-bool _String::operator!=(const _String & s) const { return Compare (s) != kCompareEqual; }
+bool _String::operator!=(const _String & s) const { return s_length != s.s_length || Compare (s) != kCompareEqual; }
 bool _String::operator<(const _String & s) const { return Compare  (s) == kCompareLess; }
 
-bool _String::Equal(const _String& s) const { return Compare  (s) == kCompareEqual; };
+bool _String::Equal(const _String& s) const { return s_length == s.s_length && Compare  (s) == kCompareEqual; };
 bool _String::EqualIgnoringCase(const _String& s) const { return CompareIgnoringCase  (s) == kCompareEqual; };
 bool _String::Equal(const char c) const {
     return s_length == 1UL && s_data[0] == c;
@@ -1187,10 +1206,32 @@ bool _String::StripQuotes(char open_char, char close_char) {
 }
 
 
+//=============================================================
+
+static bool _IsReservedWord (_String const& word) {
+  // hyReservedWords is sorted (see the end of BuiltInFunctions setup)
+  long top    = (long)hyReservedWords.countitems() - 1L,
+       bottom = 0L;
+  
+  while (bottom <= top) {
+    long middle = (top + bottom) >> 1;
+    hyComparisonType cmp = word.Compare (*(_String const*)hyReservedWords.GetItem (middle));
+    if (cmp == kCompareEqual) {
+      return true;
+    }
+    if (cmp == kCompareLess) {
+      top = middle - 1L;
+    } else {
+      bottom = middle + 1L;
+    }
+  }
+  return false;
+}
+
 //=============================================================
 
 bool _String::IsValidIdentifier(int options) const {
-  return s_length > 0UL && _IsValidIdentifierAux (options & fIDAllowCompound, options & fIDAllowFirstNumeric) == s_length - 1UL && hyReservedWords.FindObject (this) == kNotFound;
+  return s_length > 0UL && _IsValidIdentifierAux (options & fIDAllowCompound, options & fIDAllowFirstNumeric) == s_length - 1UL && !_IsReservedWord (*this);
 }
 
 //=============================================================
@@ -1466,14 +1507,97 @@ const _SimpleList _String::RegExpAllMatches(regex_t const* re) const {
 
 //=============================================================
 
+/**
+    A small LRU cache of regular expressions compiled for RegExpMatch / RegExpAllMatches
+    with a _String pattern (the HBL $ and ^ operators) and other callers of CachedRegExp,
+    keyed by the pattern and case sensitivity. Scripts which apply the same pattern to
+    every sequence or node name no longer recompile it on every call.
+ */
+
+struct _hyRegExpCache {
+  static const unsigned long kCacheSize = 64UL;
+  
+  _String         patterns        [kCacheSize];
+  regex_t       * compiled        [kCacheSize];
+  unsigned long   hashes          [kCacheSize],
+                  last_used       [kCacheSize],
+                  clock;
+  bool            case_sensitive  [kCacheSize];
+  
+  _hyRegExpCache (void) {
+    clock = 0UL;
+    for (unsigned long i = 0UL; i < kCacheSize; i++) {
+      compiled[i] = nil;
+    }
+  }
+  
+  ~_hyRegExpCache (void) {
+    for (unsigned long i = 0UL; i < kCacheSize; i++) {
+      if (compiled[i]) {
+        _String::FlushRegExp (compiled[i]);
+      }
+    }
+  }
+  
+  regex_t * Fetch (_String const & pattern, bool is_case_sensitive, int & error_code) {
+    // returns nil (and sets error_code) if the pattern does not compile
+    unsigned long hash  = pattern.Hash(),
+                  evict = 0UL;
+    
+    for (unsigned long i = 0UL; i < kCacheSize; i++) {
+      if (compiled[i]) {
+        if (hashes[i] == hash && case_sensitive[i] == is_case_sensitive && patterns[i] == pattern) {
+          last_used[i] = ++clock;
+          return compiled[i];
+        }
+        if (compiled[evict] && last_used[i] < last_used[evict]) {
+          evict = i;
+        }
+      } else if (compiled[evict]) {
+        evict = i;
+      }
+    }
+    
+    regex_t * regex = _String::PrepRegExp (pattern, error_code, is_case_sensitive);
+    if (regex) {
+      if (compiled[evict]) {
+        _String::FlushRegExp (compiled[evict]);
+      }
+      compiled[evict]       = regex;
+      patterns[evict]       = pattern;
+      hashes[evict]         = hash;
+      case_sensitive[evict] = is_case_sensitive;
+      last_used[evict]      = ++clock;
+    }
+    return regex;
+  }
+};
+
+//=============================================================
+
+regex_t const* _String::CachedRegExp (const _String& pattern, int &error_code, bool case_sensitive) {
+  static _hyRegExpCache regexp_cache;
+  error_code = 0; // not set by cache hits
+  return regexp_cache.Fetch (pattern, case_sensitive, error_code);
+}
+
+//=============================================================
+
 const _SimpleList _String::_IntRegExpMatch (const _String & pattern,
                                            bool case_sensitive, bool handle_errors, bool match_all) const {
   if (s_length) {
-    int err_code = 0;
-    regex_t* regex = PrepRegExp(pattern, err_code, case_sensitive);
+    int  err_code  = 0;
+    bool use_cache = true;
+#ifdef _OPENMP
+    use_cache = !omp_in_parallel(); // the cache is not synchronized
+#endif
+    
+    regex_t const* regex = use_cache ? CachedRegExp (pattern, err_code, case_sensitive) : PrepRegExp(pattern, err_code, case_sensitive);
     if (regex) {
       _SimpleList hits = match_all ? RegExpAllMatches(regex) : RegExpMatch(regex);
-      FlushRegExp(regex);
+      if (!use_cache) {
+        FlushRegExp((regex_t*)regex);
+      }
       return hits;
     } else if (handle_errors) {
       HandleApplicationError(GetRegExpError(err_code));
@@ -150,6 +150,7 @@ void    _TreeTopology::PostTreeConstructor (bool make_copy, _AssociativeList * m
     auto variable_handler = [&] (void) -> void {
         /** TODO SLKP 20171211, make sure the semantics are unchanged */
         variablePtrs.Replace (get_index(), make_copy ? this->makeDynamic() : this, false);
+        variableChangeStamp++;
         setParameter (WrapInNamespace (_TreeTopology::kMeta, GetName()), meta ? meta : new _MathObject, nil, false);
 
       
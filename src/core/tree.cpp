@@ -49,6 +49,7 @@
 #include "hbl_env.h"
 #include "category.h"
 #include "likefunc.h"
+#include "sampling_profiler.h"
 
 const _String kTreeErrorMessageEmptyTree ("Cannot construct empty trees");
 
@@ -392,6 +393,7 @@ void    _TheTree::PostTreeConstructor (bool make_copy, _AssociativeList* meta) {
     /** TODO SLKP 20171211, make sure the semantics are unchanged */
     // existing variable is a CalcNode
     variablePtrs.Replace (get_index(), make_copy ? this->makeDynamic() : this, false);
+    variableChangeStamp++;
     setParameter (WrapInNamespace (_TreeTopology::kMeta, GetName()), meta ? meta : new _MathObject, nil, false);
     //printf ("makecopy = %d [%ld]\n", make_copy, this->SingleReference());
   };
@@ -2740,6 +2742,8 @@ void     _TheTree::AddNodeNamesToDS (_DataSet* ds, bool doTips, bool doInternals
 
 /*----------------------------------------------------------------------------------------------------------*/
 void        _TheTree::ExponentiateMatrices  (_List& expNodes, long tc, long catID) {
+    _hyProfilerPhase profiler_phase (kProfilerPhaseExponentiate);
+    
     _List           matrixQueue, nodesToDo;
     
     _SimpleList     isExplicitForm;
@@ -37,6 +37,8 @@
  
  */
 
+#include <climits>
+
 #include "defines.h"
 #include "variable.h"
 #include "operation.h"
@@ -52,7 +54,10 @@
 using namespace hy_global;
 
 extern _SimpleList freeSlots;
-extern _SimpleList deferIsConstant;
+
+unsigned long variableChangeStamp     = 1UL,
+              variableReferenceStamp = ULONG_MAX,
+              variableSlotStamp      = 1UL;
 
 //__________________________________________________________________________________
 
@@ -63,6 +68,8 @@ _Variable::_Variable (void)
     theName    = nil;
     varValue   = nil;
     theIndex   = -1;
+    changeCheckStamp[0] = changeCheckStamp[1] = 0UL;
+    formulaStamp = valueStamp = 0UL;
     SetBounds (DEFAULTLOWERBOUND, DEFAULTUPPERBOUND);
 }
 
@@ -75,6 +82,8 @@ void _Variable::Initialize (bool)
     varValue = nil;
     theIndex = -1;
     varFlags = HY_VARIABLE_NOTSET;
+    changeCheckStamp[0] = changeCheckStamp[1] = 0UL;
+    formulaStamp = valueStamp = 0UL;
     SetBounds (DEFAULTLOWERBOUND, DEFAULTUPPERBOUND);
 }
 
@@ -103,6 +112,8 @@ void _Variable::Duplicate (BaseRefConst r) {
     upperBound = v->upperBound;
     //hasBeenChanged = v->hasBeenChanged;
     varFlags = v->varFlags;
+    changeCheckStamp[0] = changeCheckStamp[1] = 0UL;
+    formulaStamp = valueStamp = 0UL;
 }
 
 //__________________________________________________________________________________
@@ -182,6 +193,8 @@ _Variable::_Variable (_String const&s, bool isG) {
     varFlags        = HY_VARIABLE_NOTSET|(isG?HY_VARIABLE_GLOBAL:0);
     varValue        = nil;
     varFormula      = nil;
+    changeCheckStamp[0] = changeCheckStamp[1] = 0UL;
+    formulaStamp = valueStamp = 0UL;
     SetBounds       (DEFAULTLOWERBOUND, DEFAULTUPPERBOUND);
     InsertVar       (this);
 }
@@ -194,6 +207,8 @@ _Variable::_Variable (_String const&s, _String const &f, bool isG) {
     theName     = new _String(s);
     varFlags    = isG?HY_VARIABLE_GLOBAL:0;
     varValue    = nil;
+    changeCheckStamp[0] = changeCheckStamp[1] = 0UL;
+    formulaStamp = valueStamp = 0UL;
     SetBounds   (DEFAULTLOWERBOUND, DEFAULTUPPERBOUND);
     InsertVar   (this);
     varFormula = new _Formula (f);
@@ -257,10 +272,17 @@ HBLObjectRef  _Variable::Compute (void) // compute or return the value
     // call_count++;
     
     auto update_var_value = [this] () -> void {
-        if (!varValue || varFormula->HasChanged()) {
+        bool needs_update = !varValue;
+        if (!needs_update) {
+            // constraints (re)set since varValue was computed also make it stale
+            _hyVariableReferenceStamp reference (valueStamp);
+            needs_update = varFormula->HasChanged();
+        }
+        if (needs_update) {
             HBLObjectRef new_value = (HBLObjectRef)varFormula->Compute()->makeDynamic();
             DeleteObject (varValue);
             varValue = new_value;
+            valueStamp = variableChangeStamp;
             //DeleteObject (varValue);
             //(varValue = varFormula->Compute())->AddAReference();
         }
@@ -346,6 +368,7 @@ void  _Variable::SetValue (HBLObjectRef theP, bool dup) // set the value of the
   
     varFlags &= HY_VARIABLE_SET;
     varFlags |= HY_VARIABLE_CHANGED;
+    variableChangeStamp++;
 
     long     valueClass = theP->ObjectClass();
   
@@ -440,6 +463,7 @@ void  _Variable::SetNumericValue (hyFloat v) // set the value of the var to a nu
 
     varFlags &= HY_VARIABLE_SET;
     varFlags |= HY_VARIABLE_CHANGED;
+    variableChangeStamp++;
     theValue = v;
 
     if (theValue<lowerBound || theValue>upperBound) {
@@ -458,6 +482,7 @@ void  _Variable::CheckAndSet (hyFloat c, bool oob) // set the value of the var
     //hasBeenChanged = true;
     varFlags &= HY_VARIABLE_SET;
     varFlags |= HY_VARIABLE_CHANGED;
+    variableChangeStamp++;
     hyFloat l = lowerBound+1.0e-30,
                u = upperBound-1.0e-30;
     if (c<l || c>u ) {
@@ -596,6 +621,10 @@ void  _Variable::SetFormula (_Formula& theF) {
     if (varFlags & HY_VARIABLE_CHANGED) {
         varFlags -= HY_VARIABLE_CHANGED;
     }
+    
+    // a new formula changes the value even if none of its arguments have changed;
+    // HasChanged reports it to every consumer which last looked before this stamp
+    formulaStamp = ++variableChangeStamp;
 
     if (varFlags & HY_DEP_V_COMPUTED) {
         varFlags -= HY_DEP_V_COMPUTED;
@@ -624,7 +653,6 @@ void  _Variable::SetFormula (_Formula& theF) {
     if (changeMe) {
           if (deferSetFormula) {
               *deferSetFormula << theIndex;
-              deferIsConstant  << isAConstant;
           } else {
               
               for (AVLListXIteratorKeyValue variable_record : AVLListXIterator (&variableNames)) {
@@ -639,12 +667,23 @@ void  _Variable::SetFormula (_Formula& theF) {
                   }
               }
               
-              likeFuncNamesList.ForEach ([this, isAConstant] (BaseRef lf_name, unsigned long idx) -> void {
+              likeFuncNamesList.ForEach ([this] (BaseRef lf_name, unsigned long idx) -> void {
                   if (((_String*)lf_name)->nonempty()) {
-                      ((_LikelihoodFunction*)likeFuncList(idx))->UpdateIndependent(theIndex,isAConstant);
+                      ((_LikelihoodFunction*)likeFuncList(idx))->UpdateIndependent(theIndex,true);
                   }
               });
           }
+    } else {
+        // a replaced constraint: the independent variables are unchanged, so cached results
+        // of the likelihood functions which depend on this variable can no longer be reused
+        likeFuncNamesList.ForEach ([this] (BaseRef lf_name, unsigned long idx) -> void {
+            if (((_String*)lf_name)->nonempty()) {
+                _LikelihoodFunction * lf = (_LikelihoodFunction*)likeFuncList(idx);
+                if (lf->GetDependentVars().Find (theIndex) >= 0L) {
+                    lf->VoidOldResults();
+                }
+            }
+        });
     }
 
     if (&theF!=right_hand_side) {
@@ -679,6 +718,10 @@ void  _Variable::PostMarkChanged (void) {
 bool  _Variable::HasChanged (bool ignoreCats) {
     // does this variable need recomputing 
     if (varFormula) {
+        if (formulaStamp > variableReferenceStamp) { // the formula itself was (re)set
+            return true;
+        }
+        
         if (useGlobalUpdateFlag && (varFlags&HY_DEP_V_COMPUTED)) {
             return false;
         }
@@ -688,7 +731,23 @@ bool  _Variable::HasChanged (bool ignoreCats) {
         }*/
         // SLKP 20170202: seems to be unused
 
-       return  !varValue || varFormula->HasChanged(ignoreCats) ;
+        if (!varValue) {
+            return true;
+        }
+
+        if (useGlobalUpdateFlag) {
+            // HY_DEP_V_COMPUTED flags of dependent variables in the formula also enter the result
+            return varFormula->HasChanged(ignoreCats);
+        }
+
+        unsigned char const slot = ignoreCats ? 1 : 0;
+        if (changeCheckStamp[slot] != variableChangeStamp || changeCheckReference[slot] != variableReferenceStamp) {
+            unsigned long const stamp = variableChangeStamp;
+            changeCheckResult[slot]    = varFormula->HasChanged(ignoreCats);
+            changeCheckStamp[slot]     = stamp;
+            changeCheckReference[slot] = variableReferenceStamp;
+        }
+        return changeCheckResult[slot];
 
     } else {
         if (varValue && varValue->IsVariable()) {
@@ -707,6 +766,7 @@ bool  _Variable::HasChanged (bool ignoreCats) {
 void _Variable::MarkDone (void) {
     if (!varFormula && (varFlags & HY_VARIABLE_CHANGED) && !(varValue && varValue->IsVariable())) {
         varFlags -= HY_VARIABLE_CHANGED;
+        variableChangeStamp++;
     }
 }
 
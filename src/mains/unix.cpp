@@ -40,6 +40,7 @@ using namespace hy_global;
 #include "batchlan.h"
 #include "calcnode.h"
 #include "polynoml.h"
+#include "sampling_profiler.h"
 
 #if defined __MINGW32__
     #include <shlwapi.h>
@@ -59,10 +60,14 @@ const char hy_usage[] =
 "[-d] "
 "[-i] "
 "[-p] "
+"[-s] "
 "[BASEPATH=directory path] "
 "[CPU=integer] "
 "[LIBPATH=library path] "
+"[PARSECACHE=directory path] "
+"[PROFILE=file path] "
 "[USEPATH=library path] "
+"[WORKERS=integer] "
 "[<standard analysis name> or <path to hyphy batch file>] [--keyword value ...] [positional arguments ...]"
 "\n";
 
@@ -82,14 +87,24 @@ const char hy_help_message [] =
 "  -d                       debug mode; causes HyPhy to drop into an expression evaluation mode upon script error\n"
 "  -i                       interactive mode; causes HyPhy to always prompt the user for analysis options, even when defaults are available\n"
 "  -p                       postprocessor mode; drops HyPhy into an interactive mode where general post-processing scripts can be selected\n"
-"                           upon analysis completion\n\n"
+"                           upon analysis completion\n"
+"  -s                       strict mode; parse the bodies of all HBL functions when they are defined, instead of when they are first called,\n"
+"                           so that syntax errors in unused functions are also reported\n\n"
 "optional global arguments:\n"
 "  BASEPATH=directory path  defines the base directory for all path operations (default is pwd)\n"
 "  CPU=integer              if compiled with OpenMP multithreading support, requests this many threads; HyPhy could use fewer than this\n"
 "                           but never more; default is the number of CPU cores (as computed by OpenMP) on the system\n"
 "  LIBPATH=directory path   defines the directory where HyPhy library files are located (default installed location is /usr/local/lib/hyphy\n"
 "                           or as configured during CMake installation\n"
-"  USEPATH=directory path   specifies the optional working and relative path directory (default is BASEPATH)\n\n"
+"  PARSECACHE=directory path\n"
+"                           keep the statements scanned from each batch file that is read in a binary cache file in this (existing)\n"
+"                           directory, and reuse them when the unchanged file is read again (sets PARSE_CACHE_DIRECTORY)\n"
+"  PROFILE=file path        sample the HBL call stack (and native phases, like [optimizer] or [prune]) every millisecond of CPU time\n"
+"                           and write the counts to this file in the collapsed stack format read by flame graph tools\n"
+"  USEPATH=directory path   specifies the optional working and relative path directory (default is BASEPATH)\n"
+"  WORKERS=integer          if compiled without MPI support, run MPI job queues (e.g. libv3/tasks/mpi.bf) on this many local worker\n"
+"                           processes, forked when HyPhy starts; MPI_NODE_COUNT is set to integer + 1. Worker k writes its output and logs\n"
+"                           to stdout.mpinodek, messages.log.mpinodek and errors.log.mpinodek. Default is 0 (no workers)\n\n"
 "  batch file to run        if specified, execute this file, otherwise drop into an interactive mode\n"
 "  analysis arguments       if batch file is present, all remaining positional arguments are interpreted as inputs to analysis prompts\n\n"
 "optional keyword arguments (can appear anywhere); will be consumed by the requested analysis\n"
@@ -585,6 +600,12 @@ void    ProcessConfigStr (_String const & conf) {
              break;
          }
                 
+          case 's':
+          case 'S': {
+              hy_strict_function_parsing = true;
+              break;
+          }
+                
           case 'u':
           case 'U': {
               updateMode = true;
@@ -748,7 +769,9 @@ int main (int argc, char* argv[]) {
     _List positional_arguments;
     _AssociativeList kwargs;
   
-    const _String path_consts [] = {"BASEPATH=", "LIBPATH=", "USEPATH=", "CPU="};
+    const _String path_consts [] = {"BASEPATH=", "LIBPATH=", "USEPATH=", "CPU=", "WORKERS=", "PROFILE=", "PARSECACHE="};
+    _String       profile_path,
+                  parse_cache_path;
 
     for (unsigned long i=1UL; i<argc; i++) {
       _String thisArg (argv[i]);
@@ -796,12 +819,33 @@ int main (int argc, char* argv[]) {
           pathNames&&         &baseDir;
       } else if (thisArg.BeginsWith (path_consts[3])) {
           system_CPU_count  = Maximum (1L, thisArg.Cut(path_consts[3].length(),kStringEnd).to_long());
+#ifdef __HYPHY_LOCAL_WORKERS__
+      } else if (thisArg.BeginsWith (path_consts[4])) {
+          hy_mpi_node_count = 1L + Maximum (0L, thisArg.Cut(path_consts[4].length(),kStringEnd).to_long());
+#endif
+      } else if (thisArg.BeginsWith (path_consts[5])) {
+          profile_path = thisArg.Cut(path_consts[5].length(),kStringEnd);
+      } else if (thisArg.BeginsWith (path_consts[6])) {
+          parse_cache_path = thisArg.Cut(path_consts[6].length(),kStringEnd);
       } else
       //argFile = thisArg;
       positional_arguments && &thisArg;
     }
     
     GlobalStartup();
+    
+    if (parse_cache_path.nonempty()) {
+        hy_env::EnvVariableSet (hy_env::parse_cache_directory, new _FString (parse_cache_path, false), false);
+    }
+    
+#ifdef __HYPHY_LOCAL_WORKERS__
+    StartLocalWorkers ();
+#endif
+    
+    if (profile_path.nonempty() && !StartSamplingProfiler (profile_path)) {
+        HandleApplicationError (_String ("Could not start the sampling profiler (writing to ") & profile_path.Enquote() & ")");
+    }
+    
     ReadInTemplateFiles();
     
     if (positional_arguments.empty () && run_help_message) {
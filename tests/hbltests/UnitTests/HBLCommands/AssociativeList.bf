@@ -0,0 +1,116 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "AssociativeList";
+}
+
+
+// dictionaries with more than 16 keys look keys up through a hash index kept next to the key tree;
+// the index must follow every deletion (which leaves a tombstone) and every re-insertion
+// (which reuses a deleted slot), so lookups always agree with the contents
+
+// the contents of 'dict' must be exactly the keys in 'expected', mapped to their values
+function checkContents (dict, expected, what) {
+  assert (Abs (dict) == Abs (expected), what + ": wrong number of keys. Had " + Abs (dict) + ", expected " + Abs (expected));
+  assert ("" + dict == "" + expected, what + ": wrong contents");
+  dict_keys = Rows (dict);
+  assert (Columns (dict_keys) == Abs (expected), what + ": wrong number of keys listed by Rows");
+  for (check_k = 0; check_k < Columns (dict_keys); check_k += 1) {
+    assert (expected / dict_keys[check_k] && dict[dict_keys[check_k]] == expected[dict_keys[check_k]], what + ": wrong value for key " + dict_keys[check_k]);
+  }
+  return 0;
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  keyCount = 100;
+  dict = {};
+  for (k = 0; k < keyCount; k += 1) {
+    dict ["key" + k] = k;
+  }
+
+  // delete every other key
+  expected = {};
+  for (k = 0; k < keyCount; k += 1) {
+    if (k % 2) {
+      dict - ("key" + k);
+    } else {
+      expected ["key" + k] = k;
+    }
+  }
+  checkContents (dict, expected, "After deleting every other key");
+  for (k = 1; k < keyCount; k += 2) {
+    assert ((dict / ("key" + k)) == 0, "Found the deleted key key" + k);
+  }
+
+  // re-insert the deleted keys with new values, which reuses their slots
+  for (k = 1; k < keyCount; k += 2) {
+    dict ["key" + k] = -k;
+    expected ["key" + k] = -k;
+  }
+  checkContents (dict, expected, "After re-inserting the deleted keys");
+
+  // delete and re-insert the same keys many times, so that deleted entries pile up in the index
+  for (round = 0; round < 20; round += 1) {
+    for (k = round % 3; k < keyCount; k += 3) {
+      dict - ("key" + k);
+      expected - ("key" + k);
+    }
+    assert ((dict / ("key" + (round % 3))) == 0 && (dict / "never inserted") == 0, "Found a deleted key in round " + round);
+    for (k = round % 3; k < keyCount; k += 3) {
+      dict ["key" + k] = round * 1000 + k;
+      expected ["key" + k] = round * 1000 + k;
+    }
+  }
+  checkContents (dict, expected, "After repeated deletes and re-inserts");
+
+  // keys removed by subtracting another dictionary
+  toRemove = {};
+  for (k = 0; k < keyCount; k += 4) {
+    toRemove ["key" + k] = 1;
+    expected - ("key" + k);
+  }
+  dict - toRemove;
+  checkContents (dict, expected, "After subtracting a dictionary of keys");
+
+  // a copy made after deletes has its own index
+  copy = dict;
+  copy ["key0"] = "in the copy";
+  copy - "key1";
+  assert ((dict / "key0") == 0 && dict["key1"] == expected["key1"], "Changing a copy of a dictionary changed the original");
+  assert (copy["key0"] == "in the copy" && (copy / "key1") == 0 && Abs (copy) == Abs (dict), "Incorrect copy of a dictionary after deletes");
+
+  // delete everything, then grow from empty (below and then above the index threshold)
+  allKeys = Rows (dict);
+  for (k = 0; k < Columns (allKeys); k += 1) {
+    dict - allKeys[k];
+  }
+  assert (Abs (dict) == 0 && (dict / "key2") == 0, "Failed to delete every key");
+  expected = {};
+  for (k = 0; k < 40; k += 1) {
+    dict ["key" + (k * 7)] = k;
+    expected ["key" + (k * 7)] = k;
+    if (k == 10) {
+      checkContents (dict, expected, "After re-inserting into an emptied dictionary");
+    }
+  }
+  checkContents (dict, expected, "After growing an emptied dictionary past the index threshold");
+
+  // numeric keys are the same as their string forms
+  dict [5] = "five";
+  assert (dict["5"] == "five" && dict / 5 && dict / "5", "Numeric and string keys do not agree");
+  dict - 5;
+  assert ((dict / "5") == 0 && (dict / 5) == 0, "Failed to delete a numeric key");
+
+  testResult = 1;
+
+  return testResult;
+}
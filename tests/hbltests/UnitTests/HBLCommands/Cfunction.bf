@@ -0,0 +1,85 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "Cfunction";
+}
+
+// each cfunction below has an identical interpreted twin; the results
+// (and side effects on arguments) must be the same
+
+function f_factorial (x) { if (x <= 1) { return 1; } return x * f_factorial (x - 1); }
+cfunction c_factorial (x) { if (x <= 1) { return 1; } return x * c_factorial (x - 1); }
+
+function f_factorial2 (x) { if (x <= 1) { return 1; } y = x * f_factorial2 (x - 1); return y; }
+cfunction c_factorial2 (x) { if (x <= 1) { return 1; } y = x * c_factorial2 (x - 1); return y; }
+
+function f_calls_later (x) { y = f_defined_later (x) * 2; return y; }
+cfunction c_calls_later (x) { y = c_defined_later (x) * 2; return y; }
+function f_defined_later (x) { return x + 1; }
+cfunction c_defined_later (x) { return x + 1; }
+
+function f_missing (d) { x = d["missing"]; y = d["present"] + x + 1; return y; }
+cfunction c_missing (d) { x = d["missing"]; y = d["present"] + x + 1; return y; }
+
+function f_dict_write (d, n) { for (i = 0; i < n; i += 1) { d[i % 3] = d[i % 3] + i; d["total"] = d["total"] + i; } return d["total"]; }
+cfunction c_dict_write (d, n) { for (i = 0; i < n; i += 1) { d[i % 3] = d[i % 3] + i; d["total"] = d["total"] + i; } return d["total"]; }
+
+function f_matrix_write (m, n) { s = 0; for (i = 0; i < n; i += 1) { m[i % 4] = m[i % 4] + i; m[(i+1) % 2][i % 2] = s; s = s + m[i % 4]; } return s; }
+cfunction c_matrix_write (m, n) { s = 0; for (i = 0; i < n; i += 1) { m[i % 4] = m[i % 4] + i; m[(i+1) % 2][i % 2] = s; s = s + m[i % 4]; } return s; }
+
+function f_new_key (d) { d["new"] = 5; return Abs (d); }
+cfunction c_new_key (d) { d["new"] = 5; return Abs (d); }
+
+function f_identity (x) { y = 1; return x; }
+cfunction c_identity (x) { y = 1; return x; }
+
+function f_square (x) { return x * x; }
+cfunction c_square (x) { return x * x; }
+
+function f_key (d) { y = 1; return d["name"]; }
+cfunction c_key (d) { y = 1; return d["name"]; }
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // RECURSION AND CALLS
+  //---------------------------------------------------------------------------------------------------------
+  assert (c_factorial (6) == f_factorial (6) && c_factorial (6) == 720, "A recursive return in a cfunction gave " + c_factorial (6));
+  assert (c_factorial2 (6) == f_factorial2 (6) && c_factorial2 (6) == 720, "A recursive assignment in a cfunction gave " + c_factorial2 (6));
+  assert (c_calls_later (3) == f_calls_later (3) && c_calls_later (3) == 8, "A cfunction calling a function defined after it gave " + c_calls_later (3));
+  assert (c_square (3) + c_square (-2) == 13, "A compiled function with a numeric return gave a wrong result");
+
+  //---------------------------------------------------------------------------------------------------------
+  // CONTAINERS
+  //---------------------------------------------------------------------------------------------------------
+  assert (c_missing ({"present" : 2}) == f_missing ({"present" : 2}), "Reading a missing dictionary key in a cfunction gave " + c_missing ({"present" : 2}));
+
+  d1 = {"total" : 0};
+  d2 = {"total" : 0};
+  assert (c_dict_write (d1, 100) == f_dict_write (d2, 100), "Writing to a dictionary in a cfunction gave a different result");
+  assert (d1["total"] == d2["total"] && d1[0] == d2[0] && d1[1] == d2[1] && d1[2] == d2[2], "Writing to a dictionary in a cfunction left it in a different state");
+
+  m1 = {2,2}["_MATRIX_ELEMENT_ROW_*2+_MATRIX_ELEMENT_COLUMN_"];
+  m2 = {2,2}["_MATRIX_ELEMENT_ROW_*2+_MATRIX_ELEMENT_COLUMN_"];
+  assert (c_matrix_write (m1, 50) == f_matrix_write (m2, 50), "Writing to a matrix in a cfunction gave a different result");
+  assert (m1 == m2, "Writing to a matrix in a cfunction left it in a different state");
+
+  //---------------------------------------------------------------------------------------------------------
+  // NON-NUMERIC RETURN VALUES
+  //---------------------------------------------------------------------------------------------------------
+  assert (c_new_key ({"a" : 1}) == f_new_key ({"a" : 1}) && c_new_key ({"a" : 1}) == 2, "Returning a function of a dictionary from a cfunction gave " + c_new_key ({"a" : 1}));
+  assert (c_identity ({"a" : 1}) == f_identity ({"a" : 1}), "Returning a dictionary argument from a cfunction gave " + c_identity ({"a" : 1}));
+  assert (c_identity ({{1,2}}) == {{1,2}} && c_identity ("text") == "text", "Returning a matrix or a string argument from a cfunction gave a different value");
+  assert (c_identity (5) == 5, "Returning a numeric argument from a cfunction gave a different value");
+  assert (c_square ({{1,2}{3,4}}) == f_square ({{1,2}{3,4}}), "Squaring a matrix in a cfunction gave " + c_square ({{1,2}{3,4}}));
+  assert (c_key ({"name" : "value"}) == "value", "Returning a string dictionary value from a cfunction gave " + c_key ({"name" : "value"}));
+
+  testResult = 1;
+
+  return testResult;
+}
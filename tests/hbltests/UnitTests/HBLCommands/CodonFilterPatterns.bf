@@ -0,0 +1,77 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "CodonFilterPatterns";
+}
+
+
+// the codon pattern of every block of 'patternMap' (a filter of 'sequences' restricted to
+// 'species', starting at 'firstSite') must be numbered in the order of first occurrence;
+// returns the first block which is not, or -1
+lfunction codonPatternMismatch (patternMap, sequences, species, firstSite) {
+  seen = {};
+  for (b = 0; b < Columns (patternMap); b += 1) {
+    block = "";
+    for (k = 0; k < Columns (species); k += 1) {
+      block = block + (sequences[species[k]])[firstSite + 3*b][firstSite + 3*b + 2];
+    }
+    if ((seen / block) == 0) {
+      seen [block] = Abs (seen);
+    }
+    if (seen [block] != patternMap[b]) {
+      return b;
+    }
+  }
+  return -1;
+}
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // identical codon blocks are found by hashing; blocks which differ in a single character, or
+  // only in the order of their columns, must stay distinct, and blocks which differ only in the
+  // sequences left out of the filter must be merged
+  codonLetters = {{"A","C","G","T"}};
+  codonSequences = {};
+  codonFasta = "";
+  codonFasta * 128;
+  for (s = 0; s < 6; s += 1) {
+    sequence = "";
+    sequence * 1024;
+    for (c = 0; c < 900; c += 1) {
+      if (Random (0, 1) < 0.9) {
+        sequence * codonLetters[c % 2];
+      } else {
+        sequence * codonLetters[2 + s % 2];
+      }
+    }
+    sequence * 0;
+    codonSequences [s] = sequence;
+    codonFasta * (">s" + s + "\n" + sequence + "\n");
+  }
+  codonFasta * 0;
+  DataSet codonData = ReadFromString (codonFasta);
+
+  DataSetFilter codonAll = CreateFilter (codonData, 3);
+  GetDataInfo (codonAllMap, codonAll);
+  assert (Columns (codonAllMap) == 300 && codonPatternMismatch (codonAllMap, codonSequences, {{0,1,2,3,4,5}}, 0) < 0, "Incorrect codon patterns of a filter with all sequences. Had " + codonAllMap);
+
+  DataSetFilter codonSubset = CreateFilter (codonData, 3, "", "0,2,4");
+  GetDataInfo (codonSubsetMap, codonSubset);
+  assert (Columns (codonSubsetMap) == 300 && codonPatternMismatch (codonSubsetMap, codonSequences, {{0,2,4}}, 0) < 0, "Incorrect codon patterns of a filter with some of the sequences. Had " + codonSubsetMap);
+  assert (Max (codonSubsetMap, 0) <= Max (codonAllMap, 0), "A filter with fewer sequences has more codon patterns");
+
+  DataSetFilter codonShifted = CreateFilter (codonData, 3, "1-897", "1,3,5");
+  GetDataInfo (codonShiftedMap, codonShifted);
+  assert (Columns (codonShiftedMap) == 299 && codonPatternMismatch (codonShiftedMap, codonSequences, {{1,3,5}}, 1) < 0, "Incorrect codon patterns of a filter in another reading frame. Had " + codonShiftedMap);
+
+  testResult = 1;
+
+  return testResult;
+}
@@ -9,7 +9,7 @@ function getTestName () {
 
 function runTest () {
 	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
-	testResult = TRUE;
+	testResult = 0;
   
 
   //---------------------------------------------------------------------------------------------------------
@@ -20,6 +20,120 @@ function runTest () {
   DataSet 2fas = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/2.fas');
   DataSet cd2Phylip = ReadDataFile(PATH_TO_CURRENT_BF  + '/../../data/CD2.phylip');
   
+  // Streamed (column block) reading of FASTA files must produce the same data set as line-by-line reading
+  DataSet fasLineByLine = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/5.fas');
+  DATA_FILE_STREAMING_THRESHOLD = 1;
+  DataSet fasStreamed = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/5.fas');
+  DATA_FILE_STREAMING_THRESHOLD = 0;
+  
+  assert (fasLineByLine.species == fasStreamed.species && fasLineByLine.sites == fasStreamed.sites && fasLineByLine.unique_sites == fasStreamed.unique_sites, "Streamed reading of a FASTA file changed the dimensions of the data set");
+  GetDataInfo (patternsLineByLine, fasLineByLine);
+  GetDataInfo (patternsStreamed, fasStreamed);
+  assert (patternsLineByLine == patternsStreamed, "Streamed reading of a FASTA file changed the site to pattern map");
+  for (k = 0; k < fasStreamed.species; k += 1) {
+    GetString (nameLineByLine, fasLineByLine, k);
+    GetString (nameStreamed, fasStreamed, k);
+    GetDataInfo (sequenceLineByLine, fasLineByLine, k);
+    GetDataInfo (sequenceStreamed, fasStreamed, k);
+    assert (nameLineByLine == nameStreamed && sequenceLineByLine == sequenceStreamed, "Streamed reading of a FASTA file changed sequence " + k);
+  }
+  
+  // gzip compressed files are decompressed on the fly
+  DataSet fasCompressed = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/5.fas.gz');
+  GetDataInfo (patternsCompressed, fasCompressed);
+  assert (fasLineByLine.species == fasCompressed.species && patternsLineByLine == patternsCompressed, "Reading a gzip compressed FASTA file changed the data set");
+  for (k = 0; k < fasCompressed.species; k += 1) {
+    GetDataInfo (sequenceLineByLine, fasLineByLine, k);
+    GetDataInfo (sequenceCompressed, fasCompressed, k);
+    assert (sequenceLineByLine == sequenceCompressed, "Reading a gzip compressed FASTA file changed sequence " + k);
+  }
+  
+  // and so are zstd compressed files, unless this build was made without libzstd
+  LAST_HBL_EXECUTION_ERROR = "";
+  SetParameter (HBL_EXECUTION_ERROR_HANDLING, 1, 0);
+  DataSet fasZstd = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/5.fas.zst');
+  SetParameter (HBL_EXECUTION_ERROR_HANDLING, 0, 0);
+  if ((LAST_HBL_EXECUTION_ERROR $ "libzstd was not available")[0] >= 0) {
+    fprintf (stdout, "Skipped reading a zstd compressed file: this build can not decode zstd\n");
+  } else {
+    assert (Abs (LAST_HBL_EXECUTION_ERROR) == 0, "Failed to read a zstd compressed FASTA file: " + LAST_HBL_EXECUTION_ERROR);
+    GetDataInfo (patternsZstd, fasZstd);
+    assert (fasLineByLine.species == fasZstd.species && patternsLineByLine == patternsZstd, "Reading a zstd compressed FASTA file changed the data set");
+    for (k = 0; k < fasZstd.species; k += 1) {
+      GetDataInfo (sequenceLineByLine, fasLineByLine, k);
+      GetDataInfo (sequenceZstd, fasZstd, k);
+      assert (sequenceLineByLine == sequenceZstd, "Reading a zstd compressed FASTA file changed sequence " + k);
+    }
+    
+    // fscanf continues from the last position in the decompressed text
+    fscanf (PATH_TO_CURRENT_BF  + '/../../data/5.fas', REWIND, "Raw", fasText);
+    fscanf (PATH_TO_CURRENT_BF  + '/../../data/5.fas.zst', REWIND, "String,String", zstdName, zstdSequence);
+    fscanf (PATH_TO_CURRENT_BF  + '/../../data/5.fas.zst', "Raw", zstdRest);
+    assert (zstdName + "\n" + zstdSequence + zstdRest == fasText, "fscanf read a zstd compressed file incorrectly");
+  }
+  
+  // Exported binary snapshots are read back (from strings and files) as the same data set
+  Export (cd2Snapshot, cd2nex);
+  DataSet cd2FromSnapshot = ReadFromString (cd2Snapshot);
+  assert (cd2nex.species == cd2FromSnapshot.species && cd2nex.sites == cd2FromSnapshot.sites && cd2nex.unique_sites == cd2FromSnapshot.unique_sites, "Restoring a data set snapshot changed the dimensions of the data set");
+  GetDataInfo (patternsOriginal, cd2nex);
+  GetDataInfo (patternsSnapshot, cd2FromSnapshot);
+  assert (patternsOriginal == patternsSnapshot, "Restoring a data set snapshot changed the site to pattern map");
+  for (k = 0; k < cd2nex.species; k += 1) {
+    GetString (nameOriginal, cd2nex, k);
+    GetString (nameSnapshot, cd2FromSnapshot, k);
+    GetDataInfo (sequenceOriginal, cd2nex, k);
+    GetDataInfo (sequenceSnapshot, cd2FromSnapshot, k);
+    assert (nameOriginal == nameSnapshot && sequenceOriginal == sequenceSnapshot, "Restoring a data set snapshot changed sequence " + k);
+  }
+  
+  DataSet protein = ReadDataFile (PATH_TO_CURRENT_BF  + '/../../data/2.prot');
+  Export (proteinSnapshot, protein);
+  snapshotPath = PATH_TO_CURRENT_BF  + '/../../data/tempFileTesting-snapshot' + Random(0,1);
+  fprintf (snapshotPath, CLEAR_FILE, proteinSnapshot);
+  DataSet proteinFromSnapshot = ReadDataFile (snapshotPath);
+  DataSetFilter proteinFilter = CreateFilter (protein, 1);
+  DataSetFilter proteinFilterFromSnapshot = CreateFilter (proteinFromSnapshot, 1);
+  assert (proteinFilter.unique_sites == proteinFilterFromSnapshot.unique_sites && Format (proteinFilter, 1, 1) == Format (proteinFilterFromSnapshot, 1, 1), "Restoring a protein data set snapshot from a file changed the data");
+  
+  assert (runCommandWithSoftErrors ('DataSet damagedSnapshot = ReadFromString(cd2Snapshot[0][Abs(cd2Snapshot)-2]);', "Truncated data set snapshot"), "Failed error checking for reading a truncated data set snapshot");
+
+  // sequences with ambiguities, gaps and missing data are returned as read, by data sets and filters
+  DataSet withAmbigs = ReadFromString (">a\nACGTRYACGTNNACGT-ACGTACGAAC\n>b\nACGTACACGTTGACGTAACGTACGTAC\n>c\nRCGTAYACGTTKACGAAAC-TACGTAC\n>d\nACCTACACGTTGACGT??CGTACGTAC\n");
+  DataSetFilter ambigsFilter = CreateFilter (withAmbigs, 1, "3-20");
+  GetDataInfo (ambigsFirst, withAmbigs, 0);
+  GetDataInfo (ambigsLast, ambigsFilter, ambigsFilter.species - 1);
+  assert (ambigsFirst == "ACGTRYACGTNNACGT-ACGTACGAAC" && ambigsLast == "TACACGTTGACGT??CGT", "Incorrect sequences with ambiguities");
+
+  // data files with CRLF line ends or without a newline after the last line are read like LF files;
+  // the sequences after the first are written to the sites of the first in runs, including '.' matches
+  // and sequences which are shorter or longer than the first
+  fastaLF = ">one\nACGTACGTAC\nGTAA\n>two\nACG..CGTAC\nGTAC\n>three\nTTGTACGTAC\nGTACGG\n>four\nACGTAC\n";
+  DataSet fastaFromString = ReadFromString (fastaLF);
+  GetDataInfo (patternsFromString, fastaFromString);
+  lineEndingFiles    = {{"line_endings_crlf.fas", "line_endings_crlf_no_newline.fas", "line_endings_no_newline.phy", "line_endings_crlf_no_newline.nex"}};
+  lineEndingNames    = {{"ONE", "TWO", "THREE", "FOUR"}};
+  fastaSequences     = {{"ACGTACGTACGTAA??", "ACGTACGTACGTAC??", "TTGTACGTACGTACGG", "ACGTAC??????????"}};
+  alignedSequences   = {{"ACGTACGTACGTAAAC", "ACGAACGTACGTACAC", "TTGTACGTACGTACGG", "ACGTACGTAAGTTCGA"}};
+  for (f = 0; f < Columns (lineEndingFiles); f += 1) {
+    DataSet lineEndings = ReadDataFile (PATH_TO_CURRENT_BF + '/../../data/' + lineEndingFiles[f]);
+    assert (lineEndings.species == 4 && lineEndings.sites == 16 && lineEndings.unique_sites == 12, "Incorrect dimensions of the data set read from " + lineEndingFiles[f]);
+    for (k = 0; k < lineEndings.species; k += 1) {
+      GetString (lineEndingsName, lineEndings, k);
+      GetDataInfo (lineEndingsSequence, lineEndings, k);
+      if (f < 2) {
+        expectedSequence = fastaSequences[k];
+      } else {
+        expectedSequence = alignedSequences[k];
+      }
+      assert ((lineEndingsName && 1) == lineEndingNames[k] && lineEndingsSequence == expectedSequence, "Incorrect sequence " + k + " read from " + lineEndingFiles[f] + ". Had " + lineEndingsName + ":" + lineEndingsSequence);
+    }
+    if (f < 2) {
+      GetDataInfo (patternsFromFile, lineEndings);
+      assert (patternsFromFile == patternsFromString, "Reading " + lineEndingFiles[f] + " changed the site to pattern map of the LF text");
+    }
+  }
+
 
   //---------------------------------------------------------------------------------------------------------
   // ERROR HANDLING
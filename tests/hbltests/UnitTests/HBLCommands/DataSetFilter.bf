@@ -34,7 +34,34 @@ function runTest () {
   assert(Abs((freqsUnChanged[0] - freqsRemovedAAA[0]) - 0.0392668) < 0.0001 , "Failed to remove AAA codons with DataSetFilter");
   assert(Abs((freqsUnChanged[0] - freqsOnlyFiveThroughTen[0]) + 0.0145053) < 0.001, "Failed to filter based on site index with DataSetFilter");
   assert(Abs((freqsUnChanged[0] - freqsOnlyLiveStock[0]) - 0.00130718) < 0.001 , "Failed to filter based on sequence index with DataSetFilter");
-  
+
+  // Filters of the same data set share leaf state resolutions (including ambiguities)
+  DataSet withAmbigs = ReadFromString (">a\nACGTRYACGTNNACGT-ACGTACGAAC\n>b\nACGTACACGTTGACGTAACGTACGTAC\n>c\nRCGTAYACGTTKACGAAAC-TACGTAC\n>d\nACCTACACGTTGACGT??CGTACGTAC\n");
+  DataSetFilter ambigsAll = CreateFilter (withAmbigs,1);
+  DataSetFilter ambigsFirst = CreateFilter (withAmbigs,1,"0-12");
+  DataSetFilter ambigsSecond = CreateFilter (withAmbigs,1,"13-26");
+  HarvestFrequencies (ambigsFreqs, ambigsAll, 1, 1, 1);
+  global filterTestKappa = 2;
+  global filterTestT = 0.1;
+  filterTestQ = {{*,filterTestT,filterTestKappa*filterTestT,filterTestT}
+                 {filterTestT,*,filterTestT,filterTestKappa*filterTestT}
+                 {filterTestKappa*filterTestT,filterTestT,*,filterTestT}
+                 {filterTestT,filterTestKappa*filterTestT,filterTestT,*}};
+  Model filterTestModel = (filterTestQ, ambigsFreqs);
+  Tree filterTestT1 = ((a,b),c,d);
+  Tree filterTestT2 = ((a,b),c,d);
+  Tree filterTestT3 = ((a,b),c,d);
+  LikelihoodFunction lfFirst = (ambigsFirst, filterTestT1);
+  LikelihoodFunction lfSecond = (ambigsSecond, filterTestT2);
+  LikelihoodFunction lfBoth = (ambigsFirst, filterTestT1, ambigsSecond, filterTestT3);
+  LikelihoodFunction lfAll = (ambigsAll, filterTestT2);
+  LFCompute (lfFirst, LF_START_COMPUTE); LFCompute (lfFirst, logLFirst); LFCompute (lfFirst, LF_DONE_COMPUTE);
+  LFCompute (lfSecond, LF_START_COMPUTE); LFCompute (lfSecond, logLSecond); LFCompute (lfSecond, LF_DONE_COMPUTE);
+  LFCompute (lfBoth, LF_START_COMPUTE); LFCompute (lfBoth, logLBoth); LFCompute (lfBoth, LF_DONE_COMPUTE);
+  LFCompute (lfAll, LF_START_COMPUTE); LFCompute (lfAll, logLAll); LFCompute (lfAll, LF_DONE_COMPUTE);
+  assert (Abs (logLFirst + logLSecond - logLBoth) < 1e-10, "Partitioned and separate likelihoods over filters of the same data set differ");
+  assert (Abs (logLAll + 59.97995037174025) < 1e-8, "Incorrect likelihood for a filter with ambiguous characters");
+
   //---------------------------------------------------------------------------------------------------------
   // ERROR HANDLING
   //---------------------------------------------------------------------------------------------------------
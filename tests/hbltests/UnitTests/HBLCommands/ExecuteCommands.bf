@@ -7,9 +7,23 @@ function getTestName () {
 }		
 
 
+function ec_cache_increment (z&) {
+  ExecuteCommands ("z = z + 1;");
+  return 0;
+}
+
+
+namespace ec_cache_ns {
+  function ec_cache_call () {
+    ExecuteCommands ("ec_cache_r = ec_cache_f (2);");
+    return ec_cache_r;
+  }
+}
+
+
 function runTest () {
 	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
-	testResult = TRUE;
+	testResult = FALSE;
   
 
   //---------------------------------------------------------------------------------------------------------
@@ -25,6 +39,51 @@ function runTest () {
   ExecuteCommands("tempStringOne = 'testString'; tempStringTwo = 'Two'; b = tempStringOne+tempStringTwo;");
   assert(a==b, "failed to execute three commands in series inside ExecuteCommands");
 
+  //---------------------------------------------------------------------------------------------------------
+  // REPEATED EXECUTION
+  //---------------------------------------------------------------------------------------------------------
+  // a command executing the same text again reuses the parsed code, unless
+  // functions or variable slots have changed in between
+
+  // the value and the type of a variable change between executions
+  ec_cache_results = {};
+  for (k = 0; k < 3; k += 1) {
+    if (k == 0) { ec_cache_x = 3; }
+    if (k == 1) { ec_cache_x = {{1,2}}; }
+    if (k == 2) { ec_cache_z = 4; ec_cache_x := ec_cache_z + 1; }
+    ExecuteCommands ("ec_cache_y = ec_cache_x * 2;");
+    ec_cache_results [k] = ec_cache_y;
+  }
+  assert (ec_cache_results[0] == 6 && ec_cache_results[1] == {{2,4}} && ec_cache_results[2] == 10, "Failed to re-execute commands after a variable was redefined. Had " + ec_cache_results);
+  ClearConstraints (ec_cache_x);
+
+  // a reference argument names a different variable on every call
+  ec_cache_a = 1;
+  ec_cache_b = 10;
+  ec_cache_increment ("ec_cache_a");
+  ec_cache_increment ("ec_cache_b");
+  ec_cache_increment ("ec_cache_a");
+  assert (ec_cache_a == 3 && ec_cache_b == 11, "Failed to re-execute commands on a reference argument bound to a different variable. Had " + ec_cache_a + " and " + ec_cache_b);
+
+  // a function is redefined between executions
+  ec_cache_results = {};
+  for (k = 0; k < 2; k += 1) {
+    ExecuteCommands ("function ec_cache_f (x) { return x + " + (1 + 99 * k) + "; }");
+    ExecuteCommands ("ec_cache_r = ec_cache_f (2);");
+    ec_cache_results [k] = ec_cache_r;
+  }
+  assert (ec_cache_results[0] == 3 && ec_cache_results[1] == 102, "Failed to re-execute commands after a function was redefined. Had " + ec_cache_results);
+
+  // a function defined between executions takes precedence over a global function with the same name
+  ec_cache_results = {};
+  for (k = 0; k < 2; k += 1) {
+    if (k == 1) {
+      ExecuteCommands ("namespace ec_cache_ns { function ec_cache_f (x) { return -x; } }");
+    }
+    ec_cache_results [k] = ec_cache_ns.ec_cache_call ();
+  }
+  assert (ec_cache_results[0] == 102 && ec_cache_results[1] == -2, "Failed to re-execute commands after a function was defined in their namespace. Had " + ec_cache_results);
+
   //---------------------------------------------------------------------------------------------------------
   // ERROR HANDLING
   //---------------------------------------------------------------------------------------------------------
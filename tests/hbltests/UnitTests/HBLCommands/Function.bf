@@ -26,6 +26,18 @@ function addTwoByRef (y&) {
 }
 
 
+// called before the function it calls is (re)defined
+function lazy_test.outer (x) {
+  ExecuteCommands ("function lazy_test.inner (x) {return x + 100;}");
+  return lazy_test.inner (x);
+}
+
+// fails if called: replaced by lazy_test.outer before its first call
+function lazy_test.inner (x) {
+  return x x;
+}
+
+
 function runTest () {
 	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
 	testResult = TRUE;
@@ -48,6 +60,27 @@ function runTest () {
   testNum2Plus2 = addTwoByRef('testNum2');
   assert(testNum2Plus2 == testNum2, "Failed to successfully define and execute a function using parameter by refernce");
 
+  // function bodies are parsed when the function is first called;
+  // a function redefined before or after its first call must run its latest body
+  ExecuteCommands ("function lazy_test.f (x) {return x + 1;}");
+  ExecuteCommands ("function lazy_test.f (x) {return x * 10;}");
+  assert (lazy_test.f (2) == 20, "A function redefined before its first call ran its first body");
+  ExecuteCommands ("function lazy_test.f (x) {return x - 10;}");
+  assert (lazy_test.f (2) == -8, "A function redefined after its first call ran its previous body");
+
+  // a body which would fail is not reported if it is replaced before it is called,
+  // including by a function with different arguments
+  ExecuteCommands ("function lazy_test.g (x) {return x x;}");
+  ExecuteCommands ("function lazy_test.g (x, y) {return x * y;}");
+  assert (lazy_test.g (3, 4) == 12, "Failed to call a function redefined with different arguments before its first call");
+  assert (lazy_test.outer (1) == 101, "Failed to call a function redefined by its caller before its first call");
+
+  // a caller which has already been parsed calls the latest body of the function it calls
+  ExecuteCommands ("lfunction lazy_test.caller (x) {return lazy_test.f (x) + 1;}");
+  assert (lazy_test.caller (2) == -7, "Failed to call a function from an lfunction");
+  ExecuteCommands ("function lazy_test.f (x) {return x ^ 2;}");
+  assert (lazy_test.caller (3) == 10, "An lfunction called the previous body of a redefined function");
+
   //TODO: Overloading a function causes an 'Unconsumed values on the stack' error:
   //testOverload = sum(1,2,3);
 
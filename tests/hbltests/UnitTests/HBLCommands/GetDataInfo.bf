@@ -1,3 +1,5 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+
 function getTestName () {
 	return "GetDataInfo";
 }		
@@ -29,6 +31,45 @@ function runTest () {
 		
 	GetDataInfo 		(seqInfo, dinucF, -2);
 	assert (seqInfo["UNIQUE_SEQUENCES"] == 5, "Expected 5 unique sequences with strict+gap filtering (dinuc)");
+	
+	/* all pairwise distances must agree with those computed from pairwise site counts */
+	
+	DataSet 			cd2 	= ReadDataFile ("../../data/CD2.nex");
+	DataSetFilter		cd2F	= CreateFilter (cd2,1);
+	
+	for (filterID = 0; filterID < 2; filterID += 1) {
+		filterName = {{"nucF", "cd2F"}}[filterID];
+		for (ambigID = 0; ambigID < 4; ambigID += 1) {
+			ambigs = {{"RESOLVE_AMBIGUITIES", "SKIP_AMBIGUITIES", "AVERAGE_AMBIGUITIES", "RESOLVE_AMBIGUITIES_BY_FREQUENCY"}}[ambigID];
+			GetDataInfo (pDistances, *filterName, "PAIRWISE_DISTANCES", {"model" : "P_DISTANCE", "ambigs" : ambigs});
+			GetDataInfo (tn93Distances, *filterName, "PAIRWISE_DISTANCES", {"model" : "TN93", "ambigs" : ambigs, "frequencies" : {{0.3,0.2,0.2,0.3}}});
+			
+			sequenceCount = Rows (pDistances);
+			for (s1 = 0; s1 < sequenceCount; s1 += 1) {
+				for (s2 = s1 + 1; s2 < sequenceCount; s2 += 1) {
+					ExecuteCommands ("GetDataInfo (counts, " + filterName + ", s1, s2, " + ambigs + ")");
+					total = +counts;
+					assert (Abs (pDistances[s1][s2] - (total - (+counts[counts["_MATRIX_ELEMENT_COLUMN_==_MATRIX_ELEMENT_ROW_"]]))/total) < 1e-12, "P-distance mismatch for " + filterName + " " + ambigs + " pair " + s1 + "," + s2);
+					
+					counts = counts * (1/total);
+					AG = counts[0][2] + counts[2][0];
+					CT = counts[1][3] + counts[3][1];
+					transversions = 1 - AG - CT - counts[0][0] - counts[1][1] - counts[2][2] - counts[3][3];
+					d1 = 1-AG/0.24-transversions;
+					d2 = 1-CT/0.24-transversions;
+					d3 = 1-2*transversions;
+					d  = 1000;
+					if (d1 > 0 && d2 > 0 && d3 > 0) {
+						d = -0.24*Log(d1)-0.24*Log(d2)-0.26*Log(d3);
+					}
+					assert (Abs (tn93Distances[s1][s2] - d) < 1e-12 && tn93Distances[s2][s1] == tn93Distances[s1][s2], "TN93 distance mismatch for " + filterName + " " + ambigs + " pair " + s1 + "," + s2);
+				}
+			}
+		}
+	}
+	
+	assert (runCommandWithSoftErrors ('GetDataInfo (pDistances, nucF, "PAIRWISE_DISTANCES", {"model" : "P_DISTANCE", "ambigs" : "RESOLVE_AMBIGUITY"});', "is not a supported ambiguity option"), "Failed error checking for an unsupported ambiguity option in PAIRWISE_DISTANCES");
+	assert (runCommandWithSoftErrors ('GetDataInfo (pDistances, nucF, "PAIRWISE_DISTANCES", {"model" : "JC69"});', "is not a supported distance"), "Failed error checking for an unsupported distance in PAIRWISE_DISTANCES");
 		
 	testResult = 1;	
 	return testResult;
@@ -0,0 +1,143 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "LikelihoodFunction";
+}
+
+
+// the log likelihood of a freshly built likelihood function with the current parameter values of lf_tree
+function referenceLogL () {
+  Tree lf_reference_tree = ((a,b),c,d);
+  lf_branches = BranchName (lf_tree, -1);
+  for (lf_k = 0; lf_k < Columns (lf_branches) - 1; lf_k += 1) {
+    ExecuteCommands ("lf_reference_tree." + lf_branches[lf_k] + ".t = lf_tree." + lf_branches[lf_k] + ".t;");
+  }
+  LikelihoodFunction lf_reference = (lf_filter, lf_reference_tree);
+  LFCompute (lf_reference, LF_START_COMPUTE); LFCompute (lf_reference, lf_reference_logL); LFCompute (lf_reference, LF_DONE_COMPUTE);
+  return lf_reference_logL;
+}
+
+
+// the log likelihood of lf; constraints may only change outside of LF_START_COMPUTE / LF_DONE_COMPUTE
+function computeLogL () {
+  LFCompute (lf, LF_START_COMPUTE); LFCompute (lf, lf_logL); LFCompute (lf, LF_DONE_COMPUTE);
+  return lf_logL;
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  DataSet lf_data = ReadFromString (">a\nACGTAGACGTTGACGTAACGTACGAAC\n>b\nACGTACACGTTGACGTAACGTACGTAC\n>c\nACGTATACGTTCACGAAACGTACGTAC\n>d\nACCTACACGTTGACGTAGCGTACGTAC\n");
+  DataSetFilter lf_filter = CreateFilter (lf_data,1);
+  HarvestFrequencies (lf_freqs, lf_filter, 1, 1, 1);
+
+  global lf_kappa = 2;
+  lf_Q = {{*,t,lf_kappa*t,t}
+          {t,*,t,lf_kappa*t}
+          {lf_kappa*t,t,*,t}
+          {t,lf_kappa*t,t,*}};
+  Model lf_model = (lf_Q, lf_freqs);
+  Tree lf_tree = ((a,b),c,d);
+  ReplicateConstraint ("this1.?.t = 0.1", lf_tree);
+  LikelihoodFunction lf = (lf_filter, lf_tree);
+
+  //---------------------------------------------------------------------------------------------------------
+  // RE-EVALUATION AFTER PARAMETER CHANGES
+  //---------------------------------------------------------------------------------------------------------
+  // a likelihood function is only partially recomputed when its parameters change; every change
+  // (including changes to constraints and to variables that constrained parameters depend on)
+  // must be picked up
+
+  LFCompute (lf, LF_START_COMPUTE);
+  LFCompute (lf, logL);
+  LFCompute (lf, logLAgain);
+  // a value change while the likelihood function is being computed repeatedly (as the optimizer does)
+  lf_tree.d.t = 0.3;
+  LFCompute (lf, logLChanged);
+  lf_tree.d.t = 0.1;
+  LFCompute (lf, logLRestored);
+  LFCompute (lf, LF_DONE_COMPUTE);
+  assert (logL == logLAgain && logL == logLRestored && Abs (logL - referenceLogL ()) < 1e-10, "Incorrect log likelihood before any changes");
+  lf_tree.d.t = 0.3;
+  assert (logLChanged != logL && Abs (logLChanged - referenceLogL ()) < 1e-10, "A branch length change was not picked up by the likelihood function");
+  logL = logLChanged;
+
+  // constrain a branch length to another one
+  lf_tree.a.t := 3 * lf_tree.b.t;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A new constraint on a branch length was not picked up by the likelihood function");
+
+  // change the independent parameter of that constraint
+  lf_tree.b.t = 0.2;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A change to the parameter a branch length is constrained to was not picked up by the likelihood function");
+
+  // replace the constraint with a different one
+  lf_tree.a.t := lf_tree.b.t / 4;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A changed constraint on a branch length was not picked up by the likelihood function");
+
+  // a chain of constraints: the branch length depends on a variable which depends on another one
+  global lf_w = 0.15;
+  global lf_z := 2 * lf_w;
+  lf_tree.c.t := lf_z;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A constraint on a branch length through another variable was not picked up by the likelihood function");
+
+  lf_w = 0.3;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A change two constraints away from a branch length was not picked up by the likelihood function");
+
+  // replace a constraint which several branches go through: every branch must pick it up,
+  // and an evaluation without further changes must give the same value
+  lf_tree.d.t := lf_z;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A second branch constrained to the same variable was not picked up by the likelihood function");
+
+  lf_z := lf_w / 3;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A replaced constraint shared by two branches was not picked up by the likelihood function");
+  assert (computeLogL () == logL, "Evaluating the likelihood function again after a replaced constraint gave a different value");
+
+  // dependent variables which are not used by a likelihood function
+  global lf_x := lf_w;
+  global lf_2x := 2 * lf_x;
+  global lf_3x := 3 * lf_x;
+  assert (lf_2x == 0.6 && lf_3x == 0.9, "Incorrect values of variables constrained to a constrained variable");
+  lf_x := lf_w + 1;
+  assert (lf_2x == 2.6 && lf_3x == 3.9, "A replaced constraint was not picked up by every variable constrained to it");
+  assert (lf_2x == 2.6 && lf_3x == 3.9, "Variables constrained to a replaced constraint changed when computed again");
+
+  // a constraint on a global model parameter
+  global lf_kappa_half = 1;
+  lf_kappa := 2 * lf_kappa_half;
+  logL = computeLogL ();
+  assert (Abs (logL - referenceLogL ()) < 1e-10, "A constraint on a model parameter gave an incorrect log likelihood");
+
+  lf_kappa_half = 3;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "A change to the variable a model parameter is constrained to was not picked up by the likelihood function");
+
+  // remove a constraint, then change the value
+  ClearConstraints (lf_tree.a.t);
+  lf_tree.a.t = 0.7;
+  lastLogL = logL;
+  logL = computeLogL ();
+  assert (logL != lastLogL && Abs (logL - referenceLogL ()) < 1e-10, "Removing a constraint on a branch length was not picked up by the likelihood function");
+
+  testResult = 1;
+
+  return testResult;
+}
@@ -0,0 +1,106 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "LocalWorkers";
+}
+
+
+// builds without MPI serve MPISend / MPIReceive with local worker processes when started with WORKERS=N
+// (run_unit_tests.sh runs this test both with and without workers)
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  nodeCount = MPI_NODE_COUNT;
+
+  if (nodeCount < 2) {
+    //---------------------------------------------------------------------------------------------------------
+    // ERROR HANDLING (no workers)
+    //---------------------------------------------------------------------------------------------------------
+    assert (runCommandWithSoftErrors ("MPISend (1, \"return 1;\")", "HBL scripts need to check for MPI before calling MPI features"), "Failed error checking for MPISend without MPI or local workers");
+    assert (runCommandWithSoftErrors ("MPIReceive (-1, lw_from, lw_result)", "HBL scripts need to check for MPI before calling MPI features"), "Failed error checking for MPIReceive without MPI or local workers");
+    testResult = 1;
+    return testResult;
+  }
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // the master computes a likelihood function (and so has used its OpenMP threads) before the first message is sent
+  lw_logL_code = "DataSet lw_data = ReadFromString (\">a\\nACGTAGACGTTGACGTAACGTACGAAC\\n>b\\nACGTACACGTTGACGTAACGTACGTAC\\n>c\\nACGTATACGTTCACGAAACGTACGTAC\\n>d\\nACCTACACGTTGACGTAGCGTACGTAC\\n\");
+                  DataSetFilter lw_filter = CreateFilter (lw_data,1);
+                  HarvestFrequencies (lw_freqs, lw_filter, 1, 1, 1);
+                  lw_Q = {{*,t,2*t,t}{t,*,t,2*t}{2*t,t,*,t}{t,2*t,t,*}};
+                  Model lw_model = (lw_Q, lw_freqs);
+                  Tree lw_tree = ((a,b),c,d);
+                  ReplicateConstraint (\"this1.?.t = 0.1\", lw_tree);
+                  LikelihoodFunction lw_lf = (lw_filter, lw_tree);
+                  LFCompute (lw_lf, LF_START_COMPUTE); LFCompute (lw_lf, lw_logL); LFCompute (lw_lf, LF_DONE_COMPUTE);";
+  ExecuteCommands (lw_logL_code);
+  masterLogL = lw_logL;
+
+  for (node = 1; node < nodeCount; node += 1) {
+    MPISend (node, lw_logL_code + "return {\"node\" : MPI_NODE_ID, \"logL\" : lw_logL, \"seed\" : RANDOM_SEED};");
+  }
+
+  workerResults = {};
+  for (node = 1; node < nodeCount; node += 1) {
+    MPIReceive (-1, fromNode, result);
+    workerResults [fromNode] = Eval (result);
+  }
+
+  assert (Abs (workerResults) == nodeCount - 1, "Not every local worker answered. Had " + workerResults);
+  seeds = {};
+  for (node = 1; node < nodeCount; node += 1) {
+    assert ((workerResults[node])["node"] == node, "Local worker " + node + " reported a wrong MPI_NODE_ID. Had " + workerResults[node]);
+    assert (Abs ((workerResults[node])["logL"] - masterLogL) < 1e-10, "Local worker " + node + " computed a different log likelihood. Had " + workerResults[node]);
+    seeds [(workerResults[node])["seed"]] = 1;
+  }
+  assert (Abs (seeds) == nodeCount - 1, "Local workers share random seeds. Had " + workerResults);
+
+  // receiving from a specific node, and long messages
+  longMessage = "";
+  longMessage * 100000;
+  for (k = 0; k < 20000; k += 1) {
+    longMessage * "x=1;";
+  }
+  longMessage * 0;
+  MPISend (nodeCount - 1, longMessage + "return Abs (\"" + longMessage + "\");");
+  MPIReceive (nodeCount - 1, fromNode, result);
+  assert (fromNode == nodeCount - 1 && Eval (result) == Abs (longMessage), "Failed to send a long message to a local worker. Had " + result);
+
+  //---------------------------------------------------------------------------------------------------------
+  // WORKER STATE
+  //---------------------------------------------------------------------------------------------------------
+  // like MPI nodes, workers are reset after each request unless PRESERVE_SLAVE_NODE_STATE is set
+  MPISend (1, "lw_state = 5; return lw_state;");
+  MPIReceive (1, fromNode, result);
+  MPISend (1, "return lw_state;");
+  MPIReceive (1, fromNode, result);
+  assert (Eval (result) == 0, "A local worker kept its state without PRESERVE_SLAVE_NODE_STATE. Had " + result);
+
+  MPISend (1, "PRESERVE_SLAVE_NODE_STATE = TRUE; lw_state = 7; return lw_state;");
+  MPIReceive (1, fromNode, result);
+  MPISend (1, "PRESERVE_SLAVE_NODE_STATE = FALSE; return lw_state;");
+  MPIReceive (1, fromNode, result);
+  assert (Eval (result) == 7, "A local worker did not keep its state with PRESERVE_SLAVE_NODE_STATE. Had " + result);
+
+  // workers do not see the variables of the master
+  lw_master_only = 11;
+  MPISend (1, "return lw_master_only;");
+  MPIReceive (1, fromNode, result);
+  assert (Eval (result) == 0, "A local worker inherited the state of the master. Had " + result);
+
+  //---------------------------------------------------------------------------------------------------------
+  // ERROR HANDLING
+  //---------------------------------------------------------------------------------------------------------
+  assert (runCommandWithSoftErrors ("MPIReceive (-1, lw_from, lw_result)", "no local worker node has a request to answer"), "Failed error checking for MPIReceive with no pending requests");
+  assert (runCommandWithSoftErrors ("MPIReceive (1, lw_from, lw_result)", "which has no request to answer"), "Failed error checking for MPIReceive from a node with no pending requests");
+
+  testResult = 1;
+
+  return testResult;
+}
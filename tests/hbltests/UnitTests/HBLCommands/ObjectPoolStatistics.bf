@@ -0,0 +1,45 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "ObjectPoolStatistics";
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // GetString (res, OBJECT_POOL_STATISTICS, 0) reports one record per pooled object type
+  GetString (poolStats, OBJECT_POOL_STATISTICS, 0);
+  assert (Type (poolStats) == "AssociativeList" && Abs (poolStats) == 3, "Object pool statistics must be a dictionary with one record per pool. Had " + poolStats);
+
+  pools = {{"Number", "String", "StringBuffer"}};
+  for (i = 0; i < 3; i += 1) {
+    record = poolStats[pools[i]];
+    assert (Type (record) == "AssociativeList" && Abs (record) == 6, "Each pool record must have six fields. Had " + record);
+    assert (record["requests"] >= record["live"], "Object pool request count must be no less than the number of live objects. Had " + record);
+    assert (record["peak"] >= record["live"], "Object pool peak usage must be no less than the number of live objects. Had " + record);
+    assert (record["overflow"] <= record["requests"] && record["recycled"] <= record["requests"], "Object pool overflow count must not exceed the request count. Had " + record);
+  }
+
+  // allocating numbers and strings must be reflected in the request counters
+  values = {};
+  for (i = 0; i < 1000; i += 1) {
+    values + ("" + i);
+    values + (i / 3);
+  }
+
+  GetString (poolStatsAfter, OBJECT_POOL_STATISTICS, 0);
+  assert ((poolStatsAfter["Number"])["requests"] >= (poolStats["Number"])["requests"] + 1000, "Number pool requests must grow after allocating numbers. Had " + poolStatsAfter["Number"]);
+  assert ((poolStatsAfter["String"])["requests"] >= (poolStats["String"])["requests"] + 1000, "String pool requests must grow after allocating strings. Had " + poolStatsAfter["String"]);
+  assert ((poolStatsAfter["Number"])["peak"] >= (poolStatsAfter["Number"])["live"], "Object pool peak usage must be no less than the number of live objects after allocations. Had " + poolStatsAfter["Number"]);
+
+  testResult = 1;
+
+  return testResult;
+}
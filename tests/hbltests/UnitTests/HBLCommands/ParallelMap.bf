@@ -0,0 +1,72 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+LoadFunctionLibrary ("libv3/tasks/mpi.bf");
+runATest ();
+
+
+function getTestName () {
+  return "ParallelMap";
+}
+
+// mpi.ParallelMap runs on MPI nodes or local workers (WORKERS=N), and serially without either;
+// run_unit_tests.sh runs this test both with and without workers
+
+lfunction parallel_map_test.square (key, value) {
+  // hold up the first worker so that blocks come back out of order
+  if (utility.GetEnvVariable ("MPI_NODE_ID") == 1) {
+    for (k = 0; k < 100000; k += 1) {
+    }
+  }
+  signs = {1, 2};
+  signs[0] = value;
+  signs[1] = -value;
+  return {"key" : key, "label" : "value " + value, "square" : value * value, "signs" : signs, "node" : utility.GetEnvVariable ("MPI_NODE_ID")};
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  nodeCount = utility.GetEnvVariable ("MPI_NODE_COUNT");
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // keys in neither sorted nor numeric order
+  taskCount = 25;
+  tasks = {};
+  for (i = 0; i < taskCount; i += 1) {
+    tasks ["task" + ((i * 7) % taskCount)] = i;
+  }
+
+  results = mpi.ParallelMap (tasks, "parallel_map_test.square");
+
+  assert (Abs (results) == taskCount, "mpi.ParallelMap did not return a result for every element. Had " + results);
+  assert (Join (",", utility.Keys (results)) == Join (",", utility.Keys (tasks)), "mpi.ParallelMap did not return the results in the order of the elements. Had " + Join (",", utility.Keys (results)));
+
+  taskKeys = utility.Keys (tasks);
+  nodesUsed = {};
+  for (i = 0; i < taskCount; i += 1) {
+    result = results [taskKeys[i]];
+    value  = tasks [taskKeys[i]];
+    assert (result["key"] == taskKeys[i] && result["label"] == "value " + value && result["square"] == value * value && (result["signs"])[0] == value && (result["signs"])[1] == -value, "mpi.ParallelMap gave an incorrect result for " + taskKeys[i] + ". Had " + result);
+    nodesUsed [result["node"]] = 1;
+  }
+
+  if (nodeCount > 1) {
+    assert (Abs (nodesUsed) == nodeCount, "mpi.ParallelMap did not use every node. Had " + nodesUsed);
+  } else {
+    assert (Abs (nodesUsed) == 1 && nodesUsed[0] == 1, "mpi.ParallelMap did not run serially without MPI or local workers. Had " + nodesUsed);
+  }
+
+  // fewer elements than nodes, and no elements
+  results = mpi.ParallelMap ({"only" : 3}, "parallel_map_test.square");
+  assert (Abs (results) == 1 && (results["only"])["square"] == 9, "mpi.ParallelMap failed on a single element. Had " + results);
+
+  results = mpi.ParallelMap ({}, "parallel_map_test.square");
+  assert (Type (results) == "AssociativeList" && Abs (results) == 0, "mpi.ParallelMap failed on an empty dictionary. Had " + results);
+
+  testResult = 1;
+
+  return testResult;
+}
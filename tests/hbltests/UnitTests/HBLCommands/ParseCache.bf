@@ -0,0 +1,100 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "ParseCache";
+}
+
+
+// replace every occurrence of 'from' in 'text' (which may contain NUL characters, unlike the subjects of ^ and ==);
+// the number of replacements is left in parse_cache_test.count
+function parse_cache_test.replace_all (text, from, to) {
+  parse_cache_test.replaced = "";
+  parse_cache_test.copied   = 0;
+  parse_cache_test.count    = 0;
+  parse_cache_test.width    = Abs (from);
+  for (parse_cache_test.i = 0; parse_cache_test.i + parse_cache_test.width <= Abs (text); parse_cache_test.i += 1) {
+    if (text[parse_cache_test.i][parse_cache_test.i + parse_cache_test.width - 1] == from) {
+      if (parse_cache_test.i > parse_cache_test.copied) {
+        parse_cache_test.replaced += text[parse_cache_test.copied][parse_cache_test.i - 1];
+      }
+      parse_cache_test.replaced += to;
+      parse_cache_test.count    += 1;
+      parse_cache_test.copied    = parse_cache_test.i + parse_cache_test.width;
+    }
+  }
+  if (parse_cache_test.copied < Abs (text)) {
+    parse_cache_test.replaced += text[parse_cache_test.copied][Abs (text) - 1];
+  }
+  return parse_cache_test.replaced;
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  cacheDirectory = PATH_TO_CURRENT_BF + "../../data/";
+  sourceName     = "tempFileTesting-ParseCache" + Random(0,1) + ".bf";
+  sourcePath     = cacheDirectory + sourceName;
+  // the cache file is named after the source file and the directory it is in
+  cachePath      = cacheDirectory + sourceName + "." + (cacheDirectory[0][Abs (cacheDirectory) - 2] ^ {{"/","_"}}) + ".hbc";
+
+  sourceText     = "namespace parse_cache_test { value = VALUE; }
+                    function parse_cache_f (x) { if (x > 0) { return x * 2; } return -x; }
+                    parse_cache_result = parse_cache_f (3) + parse_cache_test.value;";
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  PARSE_CACHE_DIRECTORY = cacheDirectory;
+
+  fprintf (sourcePath, CLEAR_FILE, sourceText ^ {{"VALUE", "1"}});
+  ExecuteAFile (sourcePath);
+  assert (parse_cache_result == 7, "Failed to execute a file while writing its parse cache. Had " + parse_cache_result);
+  assert (!cachePath, "Failed to write a parse cache file to " + cachePath);
+
+  // the cache file holds the signature of the source file and the statements of every text it was split into
+  fscanf (cachePath, "Raw", cacheContents);
+  assert (cacheContents[0][7] == "HBLPARSE" && Abs (cacheContents) > Abs (sourceText), "The parse cache file does not contain the statements of the source file");
+
+  parse_cache_result = 0;
+  ExecuteAFile (sourcePath);
+  assert (parse_cache_result == 7, "Failed to execute a file using its parse cache. Had " + parse_cache_result);
+
+  // entries are found by the hash and length of a text, but used only if the recorded text is the same:
+  // give every entry a different text and different statements (of the same length), under the same keys
+  tamperedContents = parse_cache_test.replace_all (parse_cache_test.replace_all (cacheContents, "x * 2", "x * 3"), "x*2", "x*3");
+  assert (parse_cache_test.count > 0 && Abs (tamperedContents) == Abs (cacheContents), "Failed to modify the statements in the parse cache file");
+  fprintf (cachePath, CLEAR_FILE, tamperedContents);
+  parse_cache_result = 0;
+  ExecuteAFile (sourcePath);
+  assert (parse_cache_result == 7, "Used cached statements recorded for a different text with the same hash and length. Had " + parse_cache_result);
+
+  fscanf (cachePath, REWIND, "Raw", rewrittenContents);
+  parse_cache_test.replace_all (rewrittenContents, "x*3", "x*3");
+  assert (parse_cache_test.count == 0 && Abs (rewrittenContents) == Abs (cacheContents), "Failed to rewrite a parse cache file with entries for different texts");
+
+  //---------------------------------------------------------------------------------------------------------
+  // INVALIDATION
+  //---------------------------------------------------------------------------------------------------------
+  // the same length (and possibly the same modification time), different contents
+  fprintf (sourcePath, CLEAR_FILE, sourceText ^ {{"VALUE", "5"}});
+  ExecuteAFile (sourcePath);
+  assert (parse_cache_result == 11, "A stale parse cache was used for a changed file. Had " + parse_cache_result);
+
+  fprintf (cachePath, CLEAR_FILE, "HBLPARSE not a cache file");
+  parse_cache_result = 0;
+  ExecuteAFile (sourcePath);
+  assert (parse_cache_result == 11, "Failed to execute a file with a damaged parse cache file. Had " + parse_cache_result);
+
+  fscanf (cachePath, "Raw", cacheContents);
+  assert (cacheContents[0][7] == "HBLPARSE" && Abs (cacheContents) > Abs (sourceText), "Failed to replace a damaged parse cache file");
+
+  PARSE_CACHE_DIRECTORY = "";
+
+  testResult = 1;
+
+  return testResult;
+}
@@ -0,0 +1,60 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+LoadFunctionLibrary ("libv3/IOFunctions.bf");
+runATest ();
+
+
+function getTestName () {
+  return "ParseJSON";
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = FALSE;
+
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  parsed = ParseJSON ('{"name" : "CD2", "logL" : -3532.5, "flags" : [true, false], "nothing" : null,
+                        "rates" : [0.5, 1, 2e-3], "grid" : [[1, 2, 3], [4, 5, 6]], "labels" : ["a\\tb", "\\u00e9"],
+                        "mixed" : [1, "two", {"three" : 3}], "ragged" : [[1], [2, 3]], "empty" : {}}');
+
+  assert (Type (parsed) == "AssociativeList" && Abs (parsed) == 10, "Failed to parse a JSON object into a dictionary");
+  assert (parsed["name"] == "CD2" && parsed["logL"] == -3532.5, "Failed to parse JSON strings and numbers");
+  assert (parsed["flags"] == {{1, 0}}, "Failed to convert JSON booleans to 1/0");
+  assert (Type (parsed["nothing"]) == "Unknown", "Failed to convert JSON null to None");
+  assert (Type (parsed["rates"]) == "Matrix" && parsed["rates"] == {{0.5, 1, 0.002}}, "Failed to convert a numeric array to a row matrix");
+  assert (Rows (parsed["grid"]) == 2 && Columns (parsed["grid"]) == 3 && (parsed["grid"])[1][2] == 6, "Failed to convert an array of numeric arrays to a matrix");
+  assert ((parsed["labels"])[0] == "a\tb" && Abs ((parsed["labels"])[1]) == 2, "Failed to convert an array of strings (with escapes) to a string matrix");
+  assert (Type (parsed["mixed"]) == "AssociativeList" && (parsed["mixed"])["1"] == "two" && ((parsed["mixed"])["2"])["three"] == 3, "Failed to convert a mixed array to a dictionary keyed by index");
+  assert ((parsed["ragged"])["1"] == {{2, 3}}, "Failed to convert an array of unequal length arrays");
+  assert (Type (parsed["empty"]) == "AssociativeList" && Abs (parsed["empty"]) == 0, "Failed to parse an empty object");
+  assert (ParseJSON ("[[1,2],[3,4]]") == {{1,2}{3,4}} && ParseJSON (" 42 ") == 42, "Failed to parse JSON documents which are not objects");
+
+  // numbers written by io.SpoolJSON read back exactly
+  tempFilePath = './../../data/tempFileTesting-ParseJSON' + Random(0,1);
+  written = {"sum" : 1/10 + 2/10, "values" : {{1/3, 2/7, 1e-300}}, "nested" : {"x" : {{1/7}{-5/3}}}};
+  io.SpoolJSON (written, tempFilePath);
+  read_back = io.ParseJSON (tempFilePath);
+  assert (read_back["sum"] == 1/10 + 2/10 && read_back["values"] == written["values"] && (read_back["nested"])["x"] == (written["nested"])["x"], "Failed to read back JSON written by io.SpoolJSON");
+
+  // dictionaries written by fprintf (cache files) are read back like Eval would
+  fprintf (tempFilePath, CLEAR_FILE, written);
+  fscanf (tempFilePath, "Raw", cache_text);
+  from_cache = ParseJSON (cache_text);
+  evaluated  = Eval (cache_text);
+  assert (from_cache["values"] == evaluated["values"] && (from_cache["nested"])["x"] == (evaluated["nested"])["x"] && from_cache["sum"] == evaluated["sum"], "Failed to read a dictionary written by fprintf");
+  assert (Abs (io.LoadCacheFromFile (tempFilePath)) == 3, "Failed to load a cache file");
+
+
+  //---------------------------------------------------------------------------------------------------------
+  // ERROR HANDLING
+  //---------------------------------------------------------------------------------------------------------
+  assert (runCommandWithSoftErrors ("ParseJSON ('[1, 2')", "Expected ',' or ']' at line 1"), "Failed error checking for an unterminated array");
+  assert (runCommandWithSoftErrors ("ParseJSON ('{\"a\" 1}')", "Expected ':'"), "Failed error checking for a missing colon");
+  assert (runCommandWithSoftErrors ("ParseJSON ('{\"a\" : 1} x')", "Expected the end of input"), "Failed error checking for trailing characters");
+
+  testResult = TRUE;
+  return testResult;
+}
@@ -0,0 +1,62 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "RegExpCache";
+}
+
+
+// regular expressions used by $, ^, GetInformation and CreateFilter are compiled once
+// and kept in a cache of recently used patterns (64 entries); results must not depend
+// on whether a pattern was cached, evicted or compiled again
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // more patterns than cache entries, so that every round evicts the patterns of the previous one
+  patternCount = 80;
+  regExpCacheA1 = 1;
+  regExpCacheA2 = 2;
+  regExpCacheB1 = 3;
+  DataSet regExpCacheData = ReadFromString (">alpha1\nACGTACGT\n>beta1\nACGTACGA\n>alpha2\nACGTACGC\n");
+
+  for (round = 0; round < 3; round += 1) {
+    for (k = 0; k < patternCount; k += 1) {
+      subject = "item" + k;
+      match = subject $ ("^item" + k + "$");
+      assert (match[0] == 0 && match[1] == Abs (subject) - 1, "Failed to match pattern " + k + " in round " + round);
+      match = subject $ ("^item" + (k + 1) + "$");
+      assert (match[0] == -1 && match[1] == -1, "Matched the wrong pattern " + (k + 1) + " in round " + round);
+      replacement = {{"", "n"}};
+      replacement[0] = "item" + k + "$";
+      assert ((subject ^ replacement) == "n" && (("item" + (k + 1)) ^ replacement) == "item" + (k + 1), "Failed to replace with pattern " + k + " in round " + round);
+      match = ("x" + subject + "y" + subject) $ ("(item" + k + ")y");
+      assert (match[0] == 1 && match[1] == Abs (subject) + 1 && match[2] == 1 && match[3] == Abs (subject), "Failed to match a subexpression of pattern " + k + " in round " + round);
+    }
+
+    GetInformation (regExpCacheVars, "^regExpCacheA");
+    assert (Rows (regExpCacheVars) * Columns (regExpCacheVars) == 2, "GetInformation with a regular expression found the wrong variables in round " + round + ". Had " + regExpCacheVars);
+
+    DataSetFilter regExpCacheFilter = CreateFilter (regExpCacheData, 1, "/T/", "/[TC]$/");
+    GetString (regExpCacheLast, regExpCacheFilter, 1);
+    assert (regExpCacheFilter.species == 2 && regExpCacheLast == "alpha2", "CreateFilter with a regular expression selected the wrong sequences in round " + round);
+    assert (regExpCacheFilter.sites == 2, "CreateFilter with a regular expression selected the wrong sites in round " + round);
+  }
+
+  //---------------------------------------------------------------------------------------------------------
+  // ERROR HANDLING
+  //---------------------------------------------------------------------------------------------------------
+  // patterns which do not compile are not cached, so every use reports the error
+  assert (runCommandWithSoftErrors ('"abc" $ "(a"', "Regular Expression error"), "Failed error checking for an invalid regular expression");
+  assert (runCommandWithSoftErrors ('"abc" $ "(a"', "Regular Expression error"), "Failed error checking for an invalid regular expression used again");
+  assert ("abc" $ "(a)" == {{0}{0}{0}{0}}, "Failed to match a valid regular expression after an invalid one");
+
+  testResult = 1;
+
+  return testResult;
+}
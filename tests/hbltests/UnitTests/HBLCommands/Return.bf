@@ -34,9 +34,37 @@ function testEmptyReturn (x) {
 }
 
 
+// returned containers: literals, globals, dictionary elements and locals;
+// callers change what they get back, and nothing else may change with it
+function returnGlobalMatrix () {
+  return returnedMatrix;
+}
+
+function returnStoredMatrix () {
+  return returnedStore["matrix"];
+}
+
+lfunction returnMatrixLiteral () {
+  return {{1,2}{3,4}};
+}
+
+lfunction returnDictLiteral () {
+  return {"a" : 1, "b" : {{5,6}}};
+}
+
+lfunction returnLocalDict (x) {
+  local = {"x" : x};
+  return local;
+}
+
+function returnGlobalString () {
+  return returnedString;
+}
+
+
 function runTest () {
 	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
-	testResult = TRUE;
+	testResult = 0;
 
   assert(testSecondReturn(4) == "second return shouldn't execute", "Failed to only execute the first return statment in a function with multiple returns");
 
@@ -48,6 +76,49 @@ function runTest () {
 
   assert(testEmptyReturn(2) == null, "failed to return null as an empty return");
 
+  // a caller changing a returned container must not change its source, or the next call's result
+  returnedMatrix = {{1,2}{3,4}};
+  y = returnGlobalMatrix ();
+  y[0][0] = 100;
+  assert (returnedMatrix == {{1,2}{3,4}} && y == {{100,2}{3,4}}, "Changing a returned global matrix changed the global");
+  z = y;
+  y[1][1] = -1;
+  assert (z == {{100,2}{3,4}}, "Changing a returned matrix changed a copy of it");
+
+  returnedStore = {"matrix" : {{7,8}}};
+  y = returnStoredMatrix ();
+  y[0][1] = 0;
+  assert (returnedStore["matrix"] == {{7,8}} && y == {{7,0}}, "Changing a returned dictionary element changed the dictionary");
+
+  for (k = 0; k < 3; k += 1) {
+    y = returnMatrixLiteral ();
+    assert (y == {{1,2}{3,4}}, "A function returning a matrix literal returned a changed matrix on call " + k);
+    y[0][0] = k + 10;
+
+    d = returnDictLiteral ();
+    assert (Abs (d) == 2 && d["a"] == 1 && d["b"] == {{5,6}}, "A function returning a dictionary literal returned a changed dictionary on call " + k);
+    d["a"] = k + 10;
+    d["c"] = "added";
+    d - "b";
+  }
+
+  first = returnLocalDict (1);
+  second = returnLocalDict (2);
+  first["x"] = "changed";
+  first["y"] = 0;
+  assert (second["x"] == 2 && Abs (second) == 1, "Changing a returned local dictionary changed the result of another call");
+
+  // appending in place to a returned string
+  returnedString = "shared";
+  s = returnGlobalString ();
+  s * " and appended";
+  assert (returnedString == "shared" && s == "shared and appended", "Appending to a returned string changed the global it came from");
+  keyed = {};
+  keyed[returnGlobalString ()] = 1;
+  t = returnGlobalString ();
+  t * "!";
+  assert (keyed / "shared" && Abs (keyed) == 1 && returnedString == "shared", "Appending to a returned string changed a dictionary key made from the same string");
+
   testResult = 1;
 
   return testResult;
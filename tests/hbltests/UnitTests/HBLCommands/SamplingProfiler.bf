@@ -0,0 +1,74 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "SamplingProfiler";
+}
+
+
+// run_unit_tests.sh runs this test with PROFILE=path, then again with --profile path
+// to check the collapsed stacks written by the first run; without --profile only the
+// workload is run
+
+// an optimizer objective which is itself HBL code
+function profile_test.objective (x) {
+  profile_test_sum = 0;
+  for (profile_test_k = 0; profile_test_k < 200; profile_test_k += 1) {
+    profile_test_sum += (x - 1) ^ 2;
+  }
+  return -profile_test_sum;
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  KeywordArgument ("profile", "The collapsed stacks written by a PROFILE= run of this test", "none");
+  fscanf (stdin, "String", profilePath);
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // a likelihood function: [optimizer];[likelihood] and below
+  DataSet profile_data = ReadDataFile (PATH_TO_CURRENT_BF + "../../data/CD2.nex");
+  DataSetFilter profile_filter = CreateFilter (profile_data, 1);
+  HarvestFrequencies (profile_freqs, profile_filter, 1, 1, 1);
+  global profile_kappa = 2;
+  profile_Q = {{*,t,profile_kappa*t,t}
+               {t,*,t,profile_kappa*t}
+               {profile_kappa*t,t,*,t}
+               {t,profile_kappa*t,t,*}};
+  Model profile_model = (profile_Q, profile_freqs);
+  for (profile_run = 0; profile_run < 3; profile_run += 1) {
+    profile_kappa = 2;
+    Tree profile_tree = ((((PIG,COW),HORSE,CAT),((RHMONKEY,BABOON),(HUMAN,CHIMP))),RAT,MOUSE);
+    LikelihoodFunction profile_lf = (profile_filter, profile_tree);
+    Optimize (profile_lf_result, profile_lf);
+    assert (Abs (profile_lf_result[1][0] + 3543.79385) < 1e-3, "Failed to fit the profiled likelihood function. Had " + profile_lf_result[1][0]);
+  }
+
+  // an HBL objective called back from the optimizer: [optimizer];profile_test.objective
+  global profile_x = 3;
+  profile_x :< 10;
+  profile_x :> -10;
+  for (profile_run = 0; profile_run < 30; profile_run += 1) {
+    profile_x = 3 + profile_run / 10;
+    Optimize (profile_objective_result, profile_test.objective (profile_x));
+  }
+  assert (Abs (profile_x - 1) < 1e-3, "Failed to optimize the profiled HBL objective. Had " + profile_x);
+
+  if (profilePath != "none") {
+    fscanf (profilePath, "Raw", profile);
+    // one line per distinct stack, ending in its sample count
+    assert ((profile $ "^SamplingProfiler.bf:[0-9]+;")[0] == 0, "The profile does not start with a stack of this file. Had\n" + profile);
+    assert ((profile $ ";runATest \\(TestTools.ibf\\):[0-9]+;runTest \\(SamplingProfiler.bf\\):[0-9]+;\\[optimizer\\];\\[likelihood\\][^ ]* [0-9]+\n")[0] >= 0, "The profile has no likelihood evaluations inside the optimizer. Had\n" + profile);
+    assert ((profile $ ";runATest \\(TestTools.ibf\\):[0-9]+;runTest \\(SamplingProfiler.bf\\):[0-9]+;\\[optimizer\\];profile_test.objective \\(SamplingProfiler.bf\\):[0-9]+ [0-9]+\n")[0] >= 0, "The profile does not place the HBL objective inside the optimizer. Had\n" + profile);
+    assert ((profile $ ";profile_test.objective \\(SamplingProfiler.bf\\):[0-9]+;\\[optimizer\\]")[0] < 0, "The profile places the optimizer inside the HBL objective. Had\n" + profile);
+  }
+
+  testResult = 1;
+
+  return testResult;
+}
@@ -0,0 +1,67 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "ScalarArithmetic";
+}
+
+
+// arithmetic and comparisons on two numbers take a fast path which writes the result into
+// a temporary operand; operations with a matrix operand must still take the general path,
+// and values held by variables or matrices must never be overwritten
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  m = {{1,2}{3,4}};
+  a = 2;
+
+  // a temporary number (the result of the fast path) as the operand of a matrix operation
+  assert (m * (a + 3) == {{5,10}{15,20}}, "Failed to multiply a matrix by the sum of two numbers");
+  assert (m * (a * 2) * (a + 1) == {{12,24}{36,48}}, "Failed to multiply a matrix by two products of numbers in a row");
+  assert (m + (a * 1) == {{3,4}{5,6}}, "Failed to add the product of two numbers to a matrix");
+  assert (-m == {{-1,-2}{-3,-4}}, "Failed to negate a matrix");
+  assert ((m == m) + a * 0 == 1 && (m == a) + 0 == 0, "Failed to compare a matrix in an arithmetic expression");
+
+  // neither the operands nor the matrix are changed
+  assert (a == 2 && m == {{1,2}{3,4}}, "An operand was changed by arithmetic on a matrix and numbers");
+
+  // matrix elements and numbers stored in variables are not reused as temporaries
+  x = m[0][1] * a + m[1][0];
+  assert (x == 7 && m[0][1] == 2 && m[1][0] == 3, "Arithmetic on matrix elements changed the matrix");
+  k = a * 3;
+  n = m * k;
+  l = k + 1;
+  negative_k = -k;
+  assert (k == 6 && l == 7 && negative_k == -6 && n == {{6,12}{18,24}}, "A number stored in a variable was changed by arithmetic on it");
+  copy_of_k = k;
+  k = k * 2;
+  assert (copy_of_k == 6 && k == 12, "Updating a variable in place changed a copy of its value");
+
+  // mixed operands in a loop, so that the same temporaries are seen many times
+  sum = {{0,0}{0,0}};
+  for (i = 0; i < 10; i += 1) {
+    sum = sum + m * (i * 2 - i);
+  }
+  assert (sum == m * 45 && i == 10, "Failed to accumulate matrices scaled by numbers in a loop");
+
+  //---------------------------------------------------------------------------------------------------------
+  // ERROR HANDLING
+  //---------------------------------------------------------------------------------------------------------
+  // a number on the left of a matrix is not handled by the fast path, and is reported as before
+  assert (runCommandWithSoftErrors ("(a + 3) * m", "where 'X' is not a number"), "Failed error checking for multiplying a number by a matrix");
+  assert (runCommandWithSoftErrors ("(a * 1) + m", "where 'X' is not a number"), "Failed error checking for adding a matrix to a number");
+  assert (runCommandWithSoftErrors ("a * 3 < m", "where 'X' is not a number"), "Failed error checking for comparing a number to a matrix");
+  assert (runCommandWithSoftErrors ("m - a", "Incompatible operands"), "Failed error checking for subtracting a number from a matrix");
+  assert (runCommandWithSoftErrors ("m / (a + a)", "Incompatible operands"), "Failed error checking for dividing a matrix by a number");
+  assert (a == 2 && m == {{1,2}{3,4}}, "An operand was changed by a failed operation");
+
+  testResult = 1;
+
+  return testResult;
+}
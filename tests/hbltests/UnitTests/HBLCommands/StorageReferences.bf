@@ -0,0 +1,50 @@
+ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
+runATest ();
+
+
+function getTestName () {
+  return "StorageReferences";
+}
+
+
+function runTest () {
+	ASSERTION_BEHAVIOR = 1; /* print warning to console and go to the end of the execution list */
+	testResult = 0;
+
+  //---------------------------------------------------------------------------------------------------------
+  // SIMPLE FUNCTIONALITY
+  //---------------------------------------------------------------------------------------------------------
+  // ^name and *name storage arguments resolve to a different variable every time the
+  // statement is executed with a different value of 'name'
+  names = {{"versionA", "versionB", "versionC"}};
+  for (i = 0; i < 3; i += 1) {
+    nm = names[i];
+    GetString (^nm, HYPHY_VERSION, 0);
+  }
+  GetString (expectedVersion, HYPHY_VERSION, 0);
+  assert (versionA == expectedVersion && versionB == expectedVersion && versionC == expectedVersion, "GetString with a dereferenced storage variable in a loop did not set every variable");
+
+  for (i = 0; i < 3; i += 1) {
+    nm = "scanned" + i;
+    sscanf ("" + (i + 1) * 10, "Number", ^nm);
+  }
+  assert (scanned0 == 10 && scanned1 == 20 && scanned2 == 30, "sscanf with a dereferenced storage variable in a loop did not set every variable");
+
+  tempFilePath = './../../data/tempFileTesting-StorageReferences' + Random(0,1);
+  fprintf (tempFilePath, CLEAR_FILE, "42");
+  for (i = 0; i < 3; i += 1) {
+    nm = "fromFile" + i;
+    fscanf (tempFilePath, "Number", ^nm);
+  }
+  assert (fromFile0 == 42 && fromFile1 == 42 && fromFile2 == 42, "fscanf with a dereferenced storage variable in a loop did not set every variable");
+
+  for (i = 0; i < 3; i += 1) {
+    nm = "exported" + i;
+    GetString (*nm, HYPHY_VERSION, 0);
+  }
+  assert (exported0 == expectedVersion && exported1 == expectedVersion && exported2 == expectedVersion, "GetString with a *name storage variable in a loop did not set every variable");
+
+  testResult = 1;
+
+  return testResult;
+}
@@ -37,6 +37,26 @@ function runTest () {
   fscanf(tempFilePathMatrix, Matrix, testMatrix);
   assert(testMatrix == matrix1, "fscanf and fprintf Matrix from and to files did not work as expected");
 
+  // Dictionaries (with nested dictionaries and matrices) are written to files directly;
+  // the result should match their string conversion
+  dict1 = {"number" : 1/10 + 2/10, "integer" : 12, "digits" : 62535307746812/10000000000, "string" : "quote \" and tab \t", "none" : None,
+           "nested" : {"matrix" : {{1/3, 2/7}{1e-7, 1e20}}, "strings" : {{"a", "b"}}}};
+  tempFilePathDict = './../../data/tempFileTesting-fprintf_fscanf_dict' + Random(0,1);
+  fprintf(tempFilePathDict, dict1);
+  fscanf(tempFilePathDict, "Raw", testDict);
+  assert(testDict == "" + dict1, "fprintf of a dictionary to a file did not match its string conversion");
+
+  // JSON output uses the shortest representation that reads back exactly
+  tempFilePathDict = './../../data/tempFileTesting-fprintf_fscanf_json' + Random(0,1);
+  USE_JSON_FOR_MATRIX = 1;
+  fprintf(tempFilePathDict, dict1);
+  USE_JSON_FOR_MATRIX = 0;
+  fscanf(tempFilePathDict, "Raw", testDict);
+  assert((testDict $ "\"number\":0.30000000000000004")[0] >= 0, "JSON numbers did not round-trip");
+  assert((testDict $ "[0.3333333333333333, 0.2857142857142857]")[0] >= 0, "JSON matrix numbers were not written in the shortest form");
+  assert((testDict $ "\"digits\":6253.5307746812[^0-9]")[0] >= 0, "JSON numbers were not written in the shortest form");
+  assert((testDict $ "\"none\":null")[0] >= 0, "JSON output did not include null values");
+
   // Same for Tree.
   /* TODO: results in seg fault.
   Tree TT1 = ((1,2),(3,4),5);
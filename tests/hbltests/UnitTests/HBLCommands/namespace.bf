@@ -27,6 +27,22 @@ namespace foo {
     x = "foo";
     
 }
+
+// names are looked up through a cache keyed on the name; a local, a namespaced variable and
+// a global with the same short name, and names differing only in their last character,
+// must always resolve to their own variables
+
+lfunction shadow.local (v) {
+    x = v;
+    shadow_count = v + 1;
+    return x;
+}
+
+function shadow.by_ref (x&) {
+    x = "set by reference";
+    return 0;
+}
+
 ExecuteAFile (PATH_TO_CURRENT_BF + "TestTools.ibf");
 runATest ();
 
@@ -51,6 +67,30 @@ function runTest () {
 	    assert (sum (2,3) == 5, "Local namespace resolution fail");
 	}
 	
+    // an lfunction local shadowing globals called repeatedly, so that its variables are freed and created again
+    shadow_count = "global";
+    for (k = 0; k < 5; k += 1) {
+        assert (shadow.local (k) == k, "An lfunction local shadowing a global returned the wrong value on call " + k);
+        assert (x == "tu-ti-tu" && foo.x == "foo" && shadow_count == "global", "Assigning an lfunction local changed a variable with the same short name on call " + k);
+    }
+
+    // a reference argument rebinding the short name of a global
+    shadow.by_ref ("shadow_target");
+    assert (shadow_target == "set by reference" && x == "tu-ti-tu", "A reference argument named like a global changed the wrong variable");
+
+    // names of the same length which differ only in their last character
+    shadow_namA = 1;
+    shadow_namB = 2;
+    foo.shadow_namA = 3;
+    for (k = 0; k < 3; k += 1) {
+        shadow_namB += 1;
+        assert (shadow_namA == 1 && shadow_namB == 3 + k && foo.shadow_namA == 3, "Names differing in their last character resolved to the wrong variable in round " + k);
+    }
+
+    // identifiers which start with reserved words are ordinary names
+    returned = 1; for_each = 2; function_ = 3; namespaced = 4;
+    assert (returned + for_each + function_ + namespaced == 10, "Failed to use identifiers which start with reserved words");
+
     assert (runCommandWithSoftErrors ("namespace bad-id {}", "Not a valid function/namespace identifier"), "Failed error checking for an invalid namespace ID");
 
     testResult = 1;
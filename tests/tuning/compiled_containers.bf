@@ -0,0 +1,49 @@
+function r_sq (x) { return x*x; }
+cfunction c_sq (x) { return x*x; }
+
+function r_grid (m, d, N) {
+    acc = 0;
+    for (i = 0; i < N; i += 1) {
+        v = m[i % 16];
+        m[i % 16] = v + 1;
+        w = m[i%4][i%4];
+        m[(i+1)%4][i%4] = w * 0.5;
+        d["acc"] = d["acc"] + v;
+        d[i%3] = d[i%3] + 1;
+        acc = acc + r_sq (v) + d["scale"] * w;
+    }
+    return acc;
+}
+
+cfunction c_grid (m, d, N) {
+    acc = 0;
+    for (i = 0; i < N; i += 1) {
+        v = m[i % 16];
+        m[i % 16] = v + 1;
+        w = m[i%4][i%4];
+        m[(i+1)%4][i%4] = w * 0.5;
+        d["acc"] = d["acc"] + v;
+        d[i%3] = d[i%3] + 1;
+        acc = acc + c_sq (v) + d["scale"] * w;
+    }
+    return acc;
+}
+
+N = 200000;
+m1 = {4,4}["_MATRIX_ELEMENT_ROW_+_MATRIX_ELEMENT_COLUMN_"];
+m2 = {4,4}["_MATRIX_ELEMENT_ROW_+_MATRIX_ELEMENT_COLUMN_"];
+d1 = {"scale" : 2, "acc" : 0};
+d2 = {"scale" : 2, "acc" : 0};
+
+t0 = Time(1);
+a1 = r_grid (m1, d1, N);
+t1 = Time(1);
+a2 = c_grid (m2, d2, N);
+t2 = Time(1);
+
+fprintf (stdout, "Regular  = ", a1, " (", t1-t0, " s)\n");
+fprintf (stdout, "Compiled = ", a2, " (", t2-t1, " s)\n");
+
+assert (a1 == a2, "Compiled function returned a different result");
+assert (m1 == m2, "Compiled function left the matrix in a different state");
+assert (d1["acc"] == d2["acc"] && d1[0] == d2[0] && d1[2] == d2[2], "Compiled function left the dictionary in a different state");